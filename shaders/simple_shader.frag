@@ -4,6 +4,8 @@ layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec3 fragPosWorld;
 layout(location = 2) in vec3 fragNormalWorld;
 layout(location = 3) in vec2 fragUV;
+// identical for the whole draw, the table can be indexed without nonuniformEXT
+layout(location = 4) flat in uint fragTextureIndex;
 
 layout(location = 0) out vec4 outColor;
 
@@ -22,25 +24,10 @@ layout(set = 0, binding = 0) uniform GlobalUbo {
     int numLights;
 }
 ubo;
-layout(set = 1, binding = 0) uniform sampler2D image;
-
-layout(push_constant) uniform Push {
-    mat4 modelMatrix;
-    mat4 normalMatrix;
-}
-push;
-
-layout(set = 2, binding = 0) uniform sampler2D displacement;
-layout(set = 2, binding = 1) uniform sampler2D derivatives;
-layout(set = 2, binding = 2) uniform sampler2D turbulence;
-
-layout(set = 2, binding = 3) uniform sampler2D displacement2;
-layout(set = 2, binding = 4) uniform sampler2D derivatives2;
-layout(set = 2, binding = 5) uniform sampler2D turbulence2;
-
-layout(set = 2, binding = 6) uniform sampler2D displacement3;
-layout(set = 2, binding = 7) uniform sampler2D derivatives3;
-layout(set = 2, binding = 8) uniform sampler2D turbulence3;
+// LveBindlessTable : every texture of the engine, indexed per object
+#define MAX_BINDLESS_TEXTURES 1024
+#define NO_TEXTURE 0xFFFFFFFFu
+layout(set = 1, binding = 0) uniform sampler2D textures[MAX_BINDLESS_TEXTURES];
 
 void main() {
     vec3 diffuseLight = ubo.ambientLightColor.xyz * ubo.ambientLightColor.w;
@@ -80,7 +67,10 @@ void main() {
         specularLight += intensity * blinnTerm;
     }
 
-    vec3 imageColor = texture(image, fragUV).rgb;
+    vec3 imageColor = vec3(1.0);
+    if (fragTextureIndex != NO_TEXTURE) {
+        imageColor = texture(textures[fragTextureIndex], fragUV).rgb;
+    }
 
     outColor = vec4((diffuseLight * imageColor + specularLight * imageColor), 1.0);
 }
@@ -1,14 +1,13 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
 const float LOD_SCALE = 7.13;
-layout(location = 0) in vec3 position;
-layout(location = 1) in vec3 color;
-layout(location = 2) in vec3 normal;
-layout(location = 3) in vec2 uv;
+#include "vertex_input.glsl"
 
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec3 fragPosWorld;
 layout(location = 2) out vec3 fragNormalWorld;
 layout(location = 3) out vec2 fragUV;
+layout(location = 4) flat out uint fragTextureIndex;
 
 struct PointLight {
     vec4 position;  // ignore w
@@ -26,28 +25,37 @@ layout(set = 0, binding = 0) uniform GlobalUbo {
 }
 ubo;
 
-layout(set = 2, binding = 0) uniform sampler2D displacement1;
-layout(set = 2, binding = 1) uniform sampler2D derivatives;
-layout(set = 2, binding = 2) uniform sampler2D turbulence;
+// WaveCascades : one layer per cascade, the floating objects follow the ocean
+#define MAX_WAVE_CASCADES 8
+layout(set = 2, binding = 0) uniform sampler2DArray displacements;
+layout(set = 2, binding = 1) uniform sampler2DArray derivatives;
 
-layout(set = 2, binding = 3) uniform sampler2D displacement2;
-layout(set = 2, binding = 4) uniform sampler2D derivatives2;
-layout(set = 2, binding = 5) uniform sampler2D turbulence2;
-
-layout(set = 2, binding = 6) uniform sampler2D displacement3;
-layout(set = 2, binding = 7) uniform sampler2D derivatives3;
-layout(set = 2, binding = 8) uniform sampler2D turbulence3;
+layout(set = 2, binding = 3) uniform WaveCascadeUbo {
+    vec4 lengthScales[MAX_WAVE_CASCADES];  // x only
+    uint cascadeCount;
+}
+cascades;
 
-layout(push_constant) uniform Push {
+struct ObjectData {
     mat4 modelMatrix;
     mat4 normalMatrix;
+    vec4 positionOffset;  // xyz, decodes the packed vertex positions
+    vec4 positionScale;
+    uint textureIndex;  // slot in the bindless table
+};
+
+// one entry per drawable game object, indexed by the first instance of the draw
+layout(std430, set = 0, binding = 1) readonly buffer ObjectBuffer {
+    ObjectData objects[];
 }
-push;
+objectBuffer;
 
 void main() {
-    vec4 positionWorld = push.modelMatrix * vec4(position, 1.0);
+    ObjectData object = objectBuffer.objects[gl_InstanceIndex];
+    vec3 position = vertexPosition(object.positionOffset, object.positionScale);
+    vec4 positionWorld = object.modelMatrix * vec4(position, 1.0);
 
-    vec3 objectPos = vec3(push.modelMatrix[3][0], push.modelMatrix[3][1], push.modelMatrix[3][2]);
+    vec3 objectPos = vec3(object.modelMatrix[3][0], object.modelMatrix[3][1], object.modelMatrix[3][2]);
 
     // Calculate world-space UV coordinates
     vec2 worldUV = vec2(objectPos.xy);
@@ -58,26 +66,22 @@ void main() {
     // Calculate view distance
     float viewDist = length(viewVector);
 
-    // Calculate LOD scales
-    float lod_c1 = min(LOD_SCALE * 250 / viewDist, 1);
-    float lod_c2 = min(LOD_SCALE * 17 / viewDist, 1);
-    float lod_c3 = min(LOD_SCALE * 5 / viewDist, 1);
-
-    // Initialize displacement and largeWavesBias
+    // Initialize displacement
     float displacement = 0.0f;
     vec3 rotation = vec3(0.0f, 0.f, 0.f);
-    float largeWavesBias = 0.0;
 
     // Sample displacement textures and accumulate displacement
-    displacement += texture(displacement1, worldUV / 250 / 2).z * lod_c1;
-    largeWavesBias = displacement;
-    displacement += texture(displacement2, worldUV / 17 / 2).z * lod_c2;
-    displacement += texture(displacement3, worldUV / 5 / 2).z * lod_c3;
+    for (uint c = 0; c < cascades.cascadeCount; c++) {
+        float lengthScale = cascades.lengthScales[c].x;
+        float lod_c = min(LOD_SCALE * lengthScale / viewDist, 1);
+        displacement += texture(displacements, vec3(worldUV / lengthScale / 2, c)).z * lod_c;
+    }
 
+    // only the largest cascade tilts the objects
+    float lengthScale0 = cascades.lengthScales[0].x;
+    float lod_c0 = min(LOD_SCALE * lengthScale0 / viewDist, 1);
     for (float i = 0; i < 1; i = i += 0.01f) {
-        rotation += texture(derivatives, (worldUV + (-0.5f + i)) / 250 / 2).xyz * lod_c1;
-        // rotation += texture(derivatives2, (worldUV+(-0.5f+i))/17).xyz * lod_c2;
-        // rotation += texture(derivatives3, (worldUV+(-0.5f+i))/5).xyz * lod_c3;
+        rotation += texture(derivatives, vec3((worldUV + (-0.5f + i)) / lengthScale0 / 2, 0)).xyz * lod_c0;
     }
     rotation = rotation / 100.f;
 
@@ -114,8 +118,9 @@ void main() {
     vec4 Finalposition = positionWorld + vec4(0, displacement, 0, 0);
 
     gl_Position = ubo.projection * ubo.view * Finalposition;
-    fragNormalWorld = normalize(mat3(push.normalMatrix) * normal);
+    fragNormalWorld = normalize(mat3(object.normalMatrix) * vertexNormal());
     fragPosWorld = positionWorld.xyz;
-    fragColor = color;
-    fragUV = uv;
+    fragColor = vertexColor();
+    fragUV = vertexUV();
+    fragTextureIndex = object.textureIndex;
 }
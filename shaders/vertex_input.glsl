@@ -0,0 +1,55 @@
+// Vertex input of LveModel (lve_vertex_format.hpp). Every variant reads the same locations, the accessors below return
+// model space values whatever the format.
+//   default             : LveVertex, fp32
+//   PACKED_VERTEX       : LvePackedVertex without color (white)
+//   PACKED_VERTEX_COLOR : LvePackedVertex with its rgba8 color (defined with PACKED_VERTEX)
+
+#ifdef PACKED_VERTEX
+layout(location = 0) in vec4 inPosition;  // unorm16 inside the model bounds
+#ifdef PACKED_VERTEX_COLOR
+layout(location = 1) in vec4 inColor;     // rgba8
+#endif
+layout(location = 2) in vec2 inNormal;    // octahedral snorm16
+layout(location = 3) in vec2 inUV;        // half floats
+#else
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inUV;
+#endif
+
+// inverse of octahedralEncode in lve_vertex_format.cpp
+vec3 octahedralDecode(vec2 encoded) {
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-normal.z, 0.0);
+    normal.x += normal.x >= 0.0 ? -fold : fold;
+    normal.y += normal.y >= 0.0 ? -fold : fold;
+    return normalize(normal);
+}
+
+// offset and scale are ObjectData::positionOffset / positionScale of the drawn object
+vec3 vertexPosition(vec4 offset, vec4 scale) {
+#ifdef PACKED_VERTEX
+    return offset.xyz + scale.xyz * inPosition.xyz;
+#else
+    return inPosition;
+#endif
+}
+
+vec3 vertexColor() {
+#if defined(PACKED_VERTEX) && !defined(PACKED_VERTEX_COLOR)
+    return vec3(1.0);
+#else
+    return inColor.rgb;
+#endif
+}
+
+vec3 vertexNormal() {
+#ifdef PACKED_VERTEX
+    return octahedralDecode(inNormal);
+#else
+    return inNormal;
+#endif
+}
+
+vec2 vertexUV() { return inUV; }
@@ -2,12 +2,14 @@
 
 const vec3 LIGHT_WATER_COLOR = vec3(0.f, 0.324f, .7f);
 const vec3 DARK_WATER_COLOR = vec3(0.f, 0.137f, 0.49f);
+const float LOD_SCALE = 7.13;
 
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec3 fragPosWorld;
 layout(location = 2) in vec3 fragNormalWorld;
 layout(location = 3) in vec2 fragUV;
-layout(location = 4) in vec4 lodScales;
+layout(location = 4) in float viewDistance;
+layout(location = 5) flat in uint fragObjectIndex;
 
 layout(location = 0) out vec4 outColor;
 
@@ -27,44 +29,57 @@ layout(set = 0, binding = 0) uniform GlobalUbo {
 }
 ubo;
 
-layout(set = 1, binding = 0) uniform sampler2D displacement;
-layout(set = 1, binding = 1) uniform sampler2D derivatives;
-layout(set = 1, binding = 2) uniform sampler2D turbulence;
+// WaveCascades : one layer per cascade
+#define MAX_WAVE_CASCADES 8
+layout(set = 1, binding = 0) uniform sampler2DArray displacements;
+layout(set = 1, binding = 1) uniform sampler2DArray derivatives;
+layout(set = 1, binding = 2) uniform sampler2DArray turbulences;
 
-layout(set = 1, binding = 3) uniform sampler2D displacement2;
-layout(set = 1, binding = 4) uniform sampler2D derivatives2;
-layout(set = 1, binding = 5) uniform sampler2D turbulence2;
-
-layout(set = 1, binding = 6) uniform sampler2D displacement3;
-layout(set = 1, binding = 7) uniform sampler2D derivatives3;
-layout(set = 1, binding = 8) uniform sampler2D turbulence3;
+layout(set = 1, binding = 3) uniform WaveCascadeUbo {
+    vec4 lengthScales[MAX_WAVE_CASCADES];  // x only
+    uint cascadeCount;
+}
+cascades;
 
-layout(push_constant) uniform Push {
+struct ObjectData {
     mat4 modelMatrix;
     mat4 normalMatrix;
+    vec4 positionOffset;  // xyz, decodes the packed vertex positions
+    vec4 positionScale;
+    uint textureIndex;  // slot in the bindless table
+};
+
+// one entry per drawable game object, indexed by the first instance of the draw
+layout(std430, set = 0, binding = 1) readonly buffer ObjectBuffer {
+    ObjectData objects[];
 }
-push;
+objectBuffer;
 
 float map(float value, float minInput, float maxInput, float minOutput, float maxOutput) {
     return (value - minInput) / (maxInput - minInput) * (maxOutput - minOutput) + minOutput;
 }
 
 void main() {
-    float lengthScale1 = 250;
-    float lengthScale2 = 17;
-    float lengthScale3 = 5;
-    float modelheight = push.modelMatrix[3][1];
+    ObjectData object = objectBuffer.objects[fragObjectIndex];
+    float modelheight = object.modelMatrix[3][1];
     float height = map(fragPosWorld.y, 0.15f, 0.35f, 0.0, 1.0);
     vec3 diffuseLight = ubo.ambientLightColor.xyz * ubo.ambientLightColor.w;
     vec3 specularLight = vec3(0.0);
 
-    vec4 sumderivatives = texture(derivatives, fragUV / lengthScale1);
-    sumderivatives += texture(derivatives2, fragUV / lengthScale2) * lodScales.y;
-    sumderivatives += texture(derivatives3, fragUV / lengthScale3) * lodScales.z;
+    // the largest cascade is never faded, the smaller ones vanish with the distance
+    vec4 sumderivatives = vec4(0.0);
+    float foam = 0.0;
+    for (uint i = 0; i < cascades.cascadeCount; i++) {
+        float lengthScale = cascades.lengthScales[i].x;
+        float lod_c = i == 0 ? 1.0 : min(LOD_SCALE * lengthScale / viewDistance, 1);
+        vec3 cascadeUV = vec3(fragUV / lengthScale, i);
+        sumderivatives += texture(derivatives, cascadeUV) * lod_c;
+        foam += texture(turbulences, cascadeUV).x;
+    }
 
     vec2 slope = vec2(sumderivatives.x / (1 + sumderivatives.z), sumderivatives.y / (1 + sumderivatives.w));
     vec3 worldNormal = normalize(vec3(-slope.x, 1, -slope.y));
-    vec3 surfaceNormal = normalize(mat3(push.normalMatrix) * vec3(worldNormal.x, -worldNormal.y, worldNormal.z));
+    vec3 surfaceNormal = normalize(mat3(object.normalMatrix) * vec3(worldNormal.x, -worldNormal.y, worldNormal.z));
     // vec3 surfaceNormal = normalize(normalderivatives1 + normalderivatives2 + normalderivatives3);
 
     vec3 cameraPosWorld = ubo.invView[3].xyz;
@@ -99,12 +114,10 @@ void main() {
         blinnTerm = pow(blinnTerm, 64.0);  // higher values -> sharper highlight
         specularLight += intensity * blinnTerm;
     }
-    float foam = texture(turbulence, fragUV / lengthScale1).x + texture(turbulence2, fragUV / lengthScale2).x +
-                 texture(turbulence3, fragUV / lengthScale3).x;
-
     vec3 imageColor = mix(LIGHT_WATER_COLOR, DARK_WATER_COLOR, min(height + 0.6f, 1.f));
 
-    foam = min(1.0, max(0.0, (-foam + 2.72) * 2));  // Adjust the parameters as needed
+    // calm water sums to about one per cascade
+    foam = min(1.0, max(0.0, (-foam + float(cascades.cascadeCount) - 0.28) * 2));  // Adjust the parameters as needed
 
     // Add foam to the color
     vec3 foamColor = vec3(1.0, 1.0, 1.0);
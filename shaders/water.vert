@@ -1,16 +1,15 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
 const float LOD_SCALE = 7.13;
 
-layout(location = 0) in vec3 position;
-layout(location = 1) in vec3 color;
-layout(location = 2) in vec3 normal;
-layout(location = 3) in vec2 uv;
+#include "vertex_input.glsl"
 
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec3 fragPosWorld;
 layout(location = 2) out vec3 fragNormalWorld;
 layout(location = 3) out vec2 fragUV;
-layout(location = 4) out vec4 lodScales;
+layout(location = 4) out float viewDistance;
+layout(location = 5) flat out uint fragObjectIndex;
 
 struct PointLight {
     vec4 position;  // ignore w
@@ -25,33 +24,46 @@ layout(set = 0, binding = 0) uniform GlobalUbo {
     vec4 ambientLightColor;  // w is intensity
     PointLight pointLights[10];
     int numLights;
+    float pixelAngle;  // covered by one pixel, picks the displacement mip from the view distance
 }
 ubo;
 
-layout(set = 1, binding = 0) uniform sampler2D displacement1;
-layout(set = 1, binding = 1) uniform sampler2D derivatives1;
-layout(set = 1, binding = 2) uniform sampler2D turbulence1;
+// WaveCascades : one layer per cascade
+#define MAX_WAVE_CASCADES 8
+layout(set = 1, binding = 0) uniform sampler2DArray displacements;
+layout(set = 1, binding = 1) uniform sampler2DArray derivatives;
+layout(set = 1, binding = 2) uniform sampler2DArray turbulences;
 
-layout(set = 1, binding = 3) uniform sampler2D displacement2;
-layout(set = 1, binding = 4) uniform sampler2D derivatives2;
-layout(set = 1, binding = 5) uniform sampler2D turbulence2;
-
-layout(set = 1, binding = 6) uniform sampler2D displacement3;
-layout(set = 1, binding = 7) uniform sampler2D derivatives3;
-layout(set = 1, binding = 8) uniform sampler2D turbulence3;
+layout(set = 1, binding = 3) uniform WaveCascadeUbo {
+    vec4 lengthScales[MAX_WAVE_CASCADES];  // x only
+    uint cascadeCount;
+}
+cascades;
 
-layout(push_constant) uniform Push {
+struct ObjectData {
     mat4 modelMatrix;
     mat4 normalMatrix;
+    vec4 positionOffset;  // xyz, decodes the packed vertex positions
+    vec4 positionScale;
+    uint textureIndex;  // slot in the bindless table
+};
+
+// one entry per drawable game object, indexed by the first instance of the draw
+layout(std430, set = 0, binding = 1) readonly buffer ObjectBuffer {
+    ObjectData objects[];
 }
-push;
+objectBuffer;
 
-void main() {
-    float lengthScale1 = 250;
-    float lengthScale2 = 17;
-    float lengthScale3 = 5;
+// vertex shaders have no derivatives : the level is the number of texels one pixel covers at that distance
+float displacementLod(float viewDist, float lengthScale) {
+    float texelsPerPixel = viewDist * ubo.pixelAngle * textureSize(displacements, 0).x / lengthScale;
+    return max(log2(texelsPerPixel), 0.0);
+}
 
-    vec4 positionWorld = push.modelMatrix * vec4(position, 1.0);
+void main() {
+    ObjectData object = objectBuffer.objects[gl_InstanceIndex];
+    vec3 position = vertexPosition(object.positionOffset, object.positionScale);
+    vec4 positionWorld = object.modelMatrix * vec4(position, 1.0);
 
     // Calculate world-space UV coordinates
     vec2 worldUV = vec2(positionWorld.x, positionWorld.z);
@@ -62,32 +74,26 @@ void main() {
     // Calculate view distance
     float viewDist = length(viewVector);
 
-    // Calculate LOD scales
-    float lod_c1 = min(LOD_SCALE * lengthScale1 / viewDist, 1);
-    float lod_c2 = min(LOD_SCALE * lengthScale2 / viewDist, 1);
-    float lod_c3 = min(LOD_SCALE * lengthScale3 / viewDist, 1);
-
-    // Initialize displacement and largeWavesBias
-    vec3 displacement = vec3(0.0);
-    float largeWavesBias = 0.0;
-
     // Sample displacement textures and accumulate displacement
-    displacement.xyz += vec3(texture(displacement1, worldUV / lengthScale1).xy * lod_c1,
-                             texture(displacement1, worldUV / lengthScale1).z * lod_c1 * 2);
-    largeWavesBias = displacement.z;
-    displacement.xyz += vec3(texture(displacement2, worldUV / lengthScale2).xy * lod_c2,
-                             texture(displacement2, worldUV / lengthScale2).z * lod_c2 * 2);
-    displacement.xyz += vec3(texture(displacement3, worldUV / lengthScale3).xy * lod_c3,
-                             texture(displacement3, worldUV / lengthScale3).z * lod_c3 * 2);
+    vec3 displacement = vec3(0.0);
+    for (uint i = 0; i < cascades.cascadeCount; i++) {
+        float lengthScale = cascades.lengthScales[i].x;
+        float lod_c = min(LOD_SCALE * lengthScale / viewDist, 1);
+        float mip = displacementLod(viewDist, lengthScale);
+        vec3 cascadeSample = textureLod(displacements, vec3(worldUV / lengthScale, i), mip).xyz;
+        displacement.xyz += vec3(cascadeSample.xy * lod_c, cascadeSample.z * lod_c * 2);
+    }
 
     // Update vertex position
-    vec4 Finalposition = positionWorld + vec4(mat3(push.modelMatrix) * displacement.xzy, 1);
+    vec4 Finalposition = positionWorld + vec4(mat3(object.modelMatrix) * displacement.xzy, 1);
 
     // Output values
     gl_Position = ubo.projection * ubo.view * Finalposition;
-    fragNormalWorld = normalize(mat3(push.normalMatrix) * normal);
+    fragNormalWorld = normalize(mat3(object.normalMatrix) * vertexNormal());
     fragPosWorld = Finalposition.xyz / 2.f;
-    fragColor = color;
+    fragColor = vertexColor();
     fragUV = worldUV;
-    lodScales = vec4(lod_c1, lod_c2, lod_c3, max(displacement.y - largeWavesBias * 0.8 + 0.1, 0) / 4.8);
-}
\ No newline at end of file
+    fragObjectIndex = uint(gl_InstanceIndex);
+    // the fragment shader weights the cascades with it
+    viewDistance = viewDist;
+}
@@ -4,6 +4,7 @@
 
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/fwd.hpp>
 #include <glm/geometric.hpp>
@@ -12,14 +13,19 @@
 #include <vector>
 
 #include "keyboard_mouvement_controller.hpp"
+#include "lve_asset_cache.hpp"
+#include "lve_bindless_table.hpp"
 #include "lve_buffer.hpp"
 #include "lve_camera.hpp"
 #include "lve_descriptor.hpp"
 #include "lve_device.hpp"
 #include "lve_game_object.hpp"
+#include "lve_object_buffer.hpp"
 #include "lve_swap_chain.hpp"
+#include "lve_upload_batcher.hpp"
 #include "systems/computesSystems/shaderToySystem.hpp"
-#include "systems/computesSystems/waveGenerationSystem.hpp"
+#include "systems/computesSystems/waveCascades.hpp"
+#include "systems/computesSystems/wavePrecisionValidator.hpp"
 #include "systems/graphicsSystems/point_light_system.hpp"
 #include "systems/graphicsSystems/simple_render_system.hpp"
 #include "systems/graphicsSystems/sun_system.hpp"
@@ -27,6 +33,7 @@
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <filesystem>
@@ -39,29 +46,30 @@
 
 namespace lve {
 
-FirstApp::FirstApp() {
+FirstApp::FirstApp(const FirstAppOptions &appOptions) : options{appOptions} {
     globalPool = LveDescriptorPool::Builder(lveDevice)
-                     .setMaxSets(LveSwapChain::MAX_FRAMES_IN_FLIGHT)
-                     .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, LveSwapChain::MAX_FRAMES_IN_FLIGHT)
+                     .setMaxSets(1)
+                     .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1)
+                     .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1)
                      .build();
 
-    // Set default descriptor layout
-    std::shared_ptr<LveDescriptorSetLayout::Builder> setLayoutBuilder =
-        std::make_shared<LveDescriptorSetLayout::Builder>(lveDevice);
-    setLayoutBuilder->addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
-    LveDescriptorSetLayout::defaultTextureSetLayout = setLayoutBuilder->build();
-
     float boundary1 = 2 * M_PI / 17.f * 6.f;
     float boundary2 = 2 * M_PI / 5.f * 6.f;
-    waveGen1 = std::make_shared<WaveGen>(lveDevice, 250, 0.0001f, boundary1);
-    waveGen2 = std::make_shared<WaveGen>(lveDevice, 17, boundary1, boundary2);
-    waveGen3 = std::make_shared<WaveGen>(lveDevice, 5, boundary2, 9999.f);
-
-    display = waveGen2->getDisplacement();
-    derivatives = waveGen2->getDerivatives();
-    turbu = waveGen2->getTurbulence();
+    // une couche par cascade dans les textures de WaveCascades, les shaders de l'eau bouclent sur les cascades.
+    // Les textures restent en fp32, --validate-waves mesure l'erreur du fp16 pour choisir la précision des
+    // intermédiaires de chaque cascade et celle des sorties, communes à toutes les cascades
+    std::vector<WaveCascadeSettings> cascadeSettings{{250, 0.0001f, boundary1, WavePrecision::Full},
+                                                     {17, boundary1, boundary2, WavePrecision::Full},
+                                                     {5, boundary2, 9999.f, WavePrecision::Full}};
+    if (options.validateWavePrecision) {
+        WavePrecisionValidator{lveDevice}.validate(cascadeSettings, std::cout);
+    }
+    waveCascades = std::make_shared<WaveCascades>(lveDevice, cascadeSettings, WavePrecision::Full);
 
     loadGameObjects();
+
+    // start the GPU on the scene uploads while the systems build their pipelines
+    lveDevice.getUploadBatcher().submit();
 }
 
 FirstApp::~FirstApp() {}
@@ -69,26 +77,24 @@ FirstApp::~FirstApp() {}
 void FirstApp::run() {
     std::cout << "FirstApp::run()" << std::endl;
 
-    // Création des uniform buffer pour chaques frames
-    std::vector<std::unique_ptr<LveBuffer>> uboBuffers(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
-    for (int i = 0; i < uboBuffers.size(); i++) {
-        uboBuffers[i] = std::make_unique<LveBuffer>(lveDevice, sizeof(GlobalUbo), 1, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
-        uboBuffers[i]->map();
-    }
-
-    // Création du layout pour les uniform buffer
+    // L'uniform buffer global vit dans le frame ring, un seul descriptor set avec un offset dynamique par frame
+    LveFrameRing &frameRing = lveRenderer.getFrameRing();
     auto globalSetLayout = LveDescriptorSetLayout::Builder(lveDevice)
-                               .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                               .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
                                            VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT)
+                               .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, VK_SHADER_STAGE_ALL_GRAPHICS)
                                .build();
 
-    // Création des descriptor sets pour les uniform buffer
-    std::vector<VkDescriptorSet> globalDescriptorSets(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
-    for (int i = 0; i < globalDescriptorSets.size(); i++) {
-        auto bufferInfo = uboBuffers[i]->descriptorInfo();
-        LveDescriptorWriter(*globalSetLayout, *globalPool).writeBuffer(0, &bufferInfo).build(globalDescriptorSets[i]);
-    }
+    // les matrices de chaque objet, une instance du buffer par frame, indexées par gl_InstanceIndex
+    LveObjectBuffer objectBuffer{lveDevice, LveSwapChain::MAX_FRAMES_IN_FLIGHT};
+
+    VkDescriptorSet globalDescriptorSet;
+    VkDescriptorBufferInfo uboInfo{frameRing.getBuffer(), 0, sizeof(GlobalUbo)};
+    VkDescriptorBufferInfo objectInfo = objectBuffer.descriptorInfo();
+    LveDescriptorWriter(*globalSetLayout, *globalPool)
+        .writeBuffer(0, &uboInfo)
+        .writeBuffer(1, &objectInfo)
+        .build(globalDescriptorSet);
 
     // initialisation du system de rendu des luimères
     PointLightSystem pointLightSystem{lveDevice, lveRenderer.getSwapChainRenderPass(),
@@ -97,21 +103,16 @@ void FirstApp::run() {
     WaterSystem WaterRenderSystem{lveDevice,
                                   lveRenderer.getSwapChainRenderPass(),
                                   globalSetLayout->getDescriptorSetLayout(),
-                                  waveGen1->getAllDisplacement(),
-                                  waveGen1->getAllDerivatives(),
-                                  waveGen1->getAllTurbulence(),
-                                  waveGen2->getAllDisplacement(),
-                                  waveGen2->getAllDerivatives(),
-                                  waveGen2->getAllTurbulence(),
-                                  waveGen3->getAllDisplacement(),
-                                  waveGen3->getAllDerivatives(),
-                                  waveGen3->getAllTurbulence()};
+                                  waveCascades->getAllDisplacement(),
+                                  waveCascades->getAllDerivatives(),
+                                  waveCascades->getAllTurbulence(),
+                                  waveCascades->getLengthScales()};
 
     // initialisation du system de rendu simple
     SimpleRenderSystem simpleRenderSystem{lveDevice,
                                           lveRenderer.getSwapChainRenderPass(),
                                           globalSetLayout->getDescriptorSetLayout(),
-                                          LveDescriptorSetLayout::defaultTextureSetLayout->getDescriptorSetLayout(),
+                                          lveDevice.getBindlessTable().getDescriptorSetLayout(),
                                           WaterRenderSystem.getWaterTextureSetLayout(),
                                           WaterRenderSystem.getDescriptorSets()};
 
@@ -124,9 +125,7 @@ void FirstApp::run() {
         LveDescriptorSetLayout::depthTextureSetLayout->getDescriptorSetLayout());
 
     lveRenderer.addPostProcessingEffect(testToyShader);
-    lveRenderer.addPreProcessingEffect(waveGen1);
-    lveRenderer.addPreProcessingEffect(waveGen2);
-    lveRenderer.addPreProcessingEffect(waveGen3);
+    lveRenderer.addPreProcessingEffect(waveCascades);
     LveCamera camera{};
     // camera.setViewDirection(glm::vec3(0.f), glm::vec3(0.5, 0.f, 1.f));
     camera.setViewTarget(glm::vec3(-1.f, -2.f, 2.f), glm::vec3(0.f, 0.f, 2.5f));
@@ -135,18 +134,41 @@ void FirstApp::run() {
     viewerObject.transform.translation.z = -2.5f;
     KeyboardMouvementController cameraController{};
 
+    // tous les pipelines sont créés : temps de compilation à froid (sans cache) ou à chaud
+    std::cout << lveDevice.getPipelineCreationCount() << " pipelines created in "
+              << lveDevice.getPipelineCreationSeconds() * 1000.0 << " ms ("
+              << (lveDevice.isPipelineCacheWarm() ? "warm" : "cold") << " pipeline cache)" << std::endl;
+    lveDevice.savePipelineCache();
+
+    lveDevice.getAllocator().printStatistics(std::cout);
+    lveDevice.printMemoryReport(std::cout);
+    lveDevice.getAssetCache().printReport(std::cout);
+    std::cout << lveDevice.getSamplerCount() << " distinct sampler(s)" << std::endl;
+
     auto currentTime = std::chrono::high_resolution_clock::now();
+    auto startTime = currentTime;
+    float memoryReportTimer = 0.f;
 
-    int i = 0;
-    while (!lveWindow.shouldClose()) {
-        glfwPollEvents();
+    // sans fenêtre il faut un nombre de frames, sinon la boucle ne s'arrête jamais
+    uint32_t frameCount = options.frameCount;
+    if (options.headless && frameCount == 0) frameCount = 1;
+
+    uint32_t i = 0;
+    while (!lveWindow.shouldClose() && (frameCount == 0 || i < frameCount)) {
+        if (!options.headless) glfwPollEvents();
 
         auto newTime = std::chrono::high_resolution_clock::now();
         float frameTime = std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
         currentTime = newTime;
         // display frame time and fps
 
-        cameraController.moveInPlaneXZ(lveWindow.getGLFWwindow(), frameTime, viewerObject);
+        memoryReportTimer += frameTime;
+        if (MEMORY_REPORT_PERIOD > 0.f && memoryReportTimer >= MEMORY_REPORT_PERIOD) {
+            memoryReportTimer = 0.f;
+            lveDevice.printMemoryReport(std::cout);
+        }
+
+        if (!options.headless) cameraController.moveInPlaneXZ(lveWindow.getGLFWwindow(), frameTime, viewerObject);
 
         camera.setViewYXZ(viewerObject.transform.translation, viewerObject.transform.rotation);
         // change horizontal position of the water
@@ -164,15 +186,22 @@ void FirstApp::run() {
         float aspect = lveRenderer.getAspectRatio();
         camera.setOrthographicProjection(-aspect, aspect, -1, 1, -1, 1);
         camera.setPerspectiveProjection(glm::radians(80.f), aspect, 0.1f, 100.f);
-        if (lveRenderer.startRendering(syncObjects)) {
-            VkCommandBuffer commandBuffer = lveRenderer.beginFrame(syncObjects);
+        if (lveRenderer.startRendering()) {
+            VkCommandBuffer commandBuffer = lveRenderer.beginFrame();
             int frameIndex = lveRenderer.getFrameIndex();
             int swapChainImageIndex = lveRenderer.getSwapchainFrameIndex();
             i = i + 1;
-
-            std::cout << "Frame time: " << frameTime << " seconds" << std::endl;
-            std::cout << "frame per second :" << 1.f / frameTime << std::endl;
-            std::cout << "\033[2A";
+            if (i == frameCount && !options.capturePath.empty()) {
+                lveRenderer.captureFrame(options.capturePath);
+            }
+
+            if (!options.headless) {
+                std::cout << "Frame time: " << frameTime << " seconds" << std::endl;
+                std::cout << "frame per second :" << 1.f / frameTime << std::endl;
+                std::cout << "\033[2A";
+            }
+            LveBufferRange uboRange = frameRing.allocateUniform(sizeof(GlobalUbo));
+            objectBuffer.update(frameIndex, gameObjects);
             FrameInfo frameInfo{frameIndex,
                                 swapChainImageIndex,
                                 frameTime,
@@ -180,20 +209,25 @@ void FirstApp::run() {
                                 lveRenderer.getPreProcessingCommandBuffer(),
                                 lveRenderer.getPostProcessingCommandBuffer(),
                                 camera,
-                                globalDescriptorSets[frameIndex],
-                                gameObjects};
+                                globalDescriptorSet,
+                                {static_cast<uint32_t>(uboRange.offset), objectBuffer.getDynamicOffset(frameIndex)},
+                                gameObjects,
+                                frameRing,
+                                lveRenderer.getSwapChainExtent()};
 
-            lveRenderer.executePreProssessingEffects(frameInfo, syncObjects);
+            lveRenderer.executePreProssessingEffects(frameInfo);
             // update
             GlobalUbo ubo{};
 
             ubo.projection = camera.getProjection();
             ubo.view = camera.getView();
             ubo.inverseView = camera.getInverseView();
+            // un pixel à distance 1 de la caméra : choix du mip de déplacement de l'eau
+            ubo.pixelAngle =
+                1.f / camera.getPixelsPerUnit(1.f, static_cast<float>(std::max(frameInfo.viewportExtent.height, 1u)));
             ubo.sunDirection = glm::vec4(-1.0f, -1.0f, -1.0f, 1.0f);
             pointLightSystem.update(frameInfo, ubo);
-            uboBuffers[frameIndex]->writeToBuffer(&ubo);
-            uboBuffers[frameIndex]->flush();
+            memcpy(uboRange.mapped, &ubo, sizeof(GlobalUbo));
 
             // render
             lveRenderer.beginSwapChainRenderPass(commandBuffer);
@@ -204,17 +238,26 @@ void FirstApp::run() {
             pointLightSystem.render(frameInfo);
             sunSystem.render(frameInfo);
             lveRenderer.endSwapChainRenderPass(commandBuffer);
-            lveRenderer.endFrame(syncObjects);
-            lveRenderer.renderPostProssessingEffects(frameInfo, syncObjects);
-            lveRenderer.presentFrame(syncObjects);
+            lveRenderer.endFrame();
+            lveRenderer.renderPostProssessingEffects(frameInfo);
+            lveRenderer.presentFrame();
         }
     }
 
     vkDeviceWaitIdle(lveDevice.device());
+
+    if (i > 0) {
+        double totalSeconds =
+            std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() -
+                                                                        startTime)
+                .count();
+        std::cout << i << " frames in " << totalSeconds << " s, average frame time " << totalSeconds / i * 1000.0
+                  << " ms" << std::endl;
+    }
 }
 
 void FirstApp::loadGameObjects() {
-    // std::shared_ptr<LveModel> lveModel = LveModel::createModelFromFile(lveDevice, "models/smooth_vase.obj");
+    // std::shared_ptr<LveModel> lveModel = assetCache.getModel("models/smooth_vase.obj");
     // auto flatVase = LveGameObject::createGameObject();
     // flatVase.model = lveModel;
     // flatVase.transform.translation = {-.7f, -0.1f, 0.f};
@@ -222,10 +265,12 @@ void FirstApp::loadGameObjects() {
     // flatVase.transform.rotation = {0.f, glm::radians(90.f), 0.f};
     // gameObjects.emplace(flatVase.getId(), std::move(flatVase));
 
-    std::shared_ptr<LveModel> lveModel = LveModel::createModelFromFile(lveDevice, "models/Rubber Duck jaune.obj");
-    std::shared_ptr<LveTexture> lveTexture = std::make_unique<LveTexture>(lveDevice, "textures/Rubber_Duck.png", false);
+    // les modèles et textures sont partagés : un même fichier n'est chargé qu'une fois
+    // sommets compressés (16 octets au lieu de 44) : aucun de ces modèles n'a de couleur par sommet
+    LveAssetCache &assetCache = lveDevice.getAssetCache();
+    std::shared_ptr<LveModel> lveModel = assetCache.getModel("models/Rubber Duck jaune.obj", LveVertexFormat::Packed);
+    std::shared_ptr<LveTexture> lveTexture = assetCache.getTexture("textures/Rubber_Duck.png");
     auto coin = LveGameObject::createGameObject();
-    (*lveModel).createDescriptorSet(lveDevice, lveTexture.get(), nullptr);
     coin.texture = lveTexture;
     coin.model = lveModel;
     coin.transform.translation = {.5f, 0.35f, 0.0f};
@@ -233,34 +278,8 @@ void FirstApp::loadGameObjects() {
     coin.transform.rotation = {0.f, glm::radians(180.f), glm::radians(180.f)};
     gameObjects.emplace(coin.getId(), std::move(coin));
 
-    // std::shared_ptr<LveModel> lveModel = LveModel::createModelFromFile(lveDevice, "models/quad.obj");
-    // auto floor = LveGameObject::createGameObject();
-    // (*lveModel).createDescriptorSet(lveDevice, display.get(), nullptr);
-    // floor.model = lveModel;
-    // floor.texture = display;
-    // floor.transform.translation = {0.f, .5f, -8.f};
-    // floor.transform.scale = {3.f, 1.f, 3.f};
-    // gameObjects.emplace(floor.getId(), std::move(floor));
-
-    // lveModel = LveModel::createModelFromFile(lveDevice, "models/quad.obj");
-    // floor = LveGameObject::createGameObject();
-    // (*lveModel).createDescriptorSet(lveDevice, derivatives.get(), nullptr);
-    // floor.model = lveModel;
-    // floor.texture = derivatives;
-    // floor.transform.translation = {8.f, .5f, 0.f};
-    // floor.transform.scale = {3.f, 1.f, 3.f};
-    // gameObjects.emplace(floor.getId(), std::move(floor));
-
-    // lveModel = LveModel::createModelFromFile(lveDevice, "models/quad.obj");
-    // floor = LveGameObject::createGameObject();
-    // (*lveModel).createDescriptorSet(lveDevice, turbu.get(), nullptr);
-    // floor.model = lveModel;
-    // floor.texture = turbu;
-    // floor.transform.translation = {0.f, .5f, 8.f};
-    // floor.transform.scale = {3.f, 1.f, 3.f};
-    // gameObjects.emplace(floor.getId(), std::move(floor));
-
-    lveModel = LveModel::createModelFromFile(lveDevice, "models/ocean.obj");
+    // WaterSystem dessine toujours la grille complète : pas de LOD à générer ni à charger
+    lveModel = assetCache.getModel("models/ocean.obj", LveVertexFormat::Packed, false);
     auto floor = LveGameObject::createGameObject();
     floor.model = lveModel;
     floor.water = std::make_unique<Water>();
@@ -272,9 +291,8 @@ void FirstApp::loadGameObjects() {
 
     sun = std::make_shared<LveGameObject>(LveGameObject::createGameObject());
 
-    // lveModel = LveModel::createModelFromFile(lveDevice, "models/quad.obj");
+    // lveModel = assetCache.getModel("models/quad.obj");
     // auto test = LveGameObject::createGameObject();
-    // (*lveModel).createDescriptorSet(lveDevice, texturedst.get(), nullptr);
     // test.model = lveModel;
     // test.texture = texturedst;
     // test.transform.translation = {0.f, -1.5f, 0.f};
@@ -2,7 +2,9 @@
 
 #include <vulkan/vulkan_core.h>
 
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "lve_descriptor.hpp"
@@ -12,14 +14,27 @@
 #include "lve_texture.hpp"
 #include "lve_utils.hpp"
 #include "lve_window.hpp"
-#include "systems/computesSystems/waveGenerationSystem.hpp"
+#include "systems/computesSystems/waveCascades.hpp"
 namespace lve {
+struct FirstAppOptions {
+    // no window nor surface, frames are rendered into offscreen images
+    bool headless = false;
+    // number of frames to render before returning, 0 runs until the window is closed
+    uint32_t frameCount = 0;
+    // when not empty the last frame is written to this file (PPM)
+    std::string capturePath;
+    // compares fp16 and fp32 storage of every wave cascade before the first frame and prints the errors
+    bool validateWavePrecision = false;
+};
+
 class FirstApp {
    public:
     static constexpr int WIDTH = 1280;
     static constexpr int HEIGHT = 720;
+    // seconds between two memory reports, 0 disables the periodic dump
+    static constexpr float MEMORY_REPORT_PERIOD = 0.f;
 
-    FirstApp();
+    FirstApp(const FirstAppOptions &appOptions = FirstAppOptions{});
     ~FirstApp();
 
     FirstApp(const LveWindow &) = delete;
@@ -29,19 +44,14 @@ class FirstApp {
    private:
     void loadGameObjects();
 
-    LveWindow lveWindow{WIDTH, HEIGHT, "TutournesEgine v0.1"};
+    FirstAppOptions options;
+    LveWindow lveWindow{WIDTH, HEIGHT, "TutournesEgine v0.1", options.headless};
     LveDevice lveDevice{lveWindow};
     LveRenderer lveRenderer{lveWindow, lveDevice};
-    SynchronisationObjects syncObjects;
 
     // l'ordre de déclaration compte
     std::unique_ptr<LveDescriptorPool> globalPool{};
-    std::shared_ptr<LveTexture> display;
-    std::shared_ptr<LveTexture> derivatives;
-    std::shared_ptr<LveTexture> turbu;
-    std::shared_ptr<WaveGen> waveGen1;
-    std::shared_ptr<WaveGen> waveGen2;
-    std::shared_ptr<WaveGen> waveGen3;
+    std::shared_ptr<WaveCascades> waveCascades;
     unsigned int waterId;
     std::shared_ptr<LveGameObject> sun;
     LveGameObject::Map gameObjects;
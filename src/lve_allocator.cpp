@@ -0,0 +1,655 @@
+#include "lve_allocator.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+
+namespace lve {
+
+namespace {
+
+uint32_t log2Floor(uint64_t value) { return 63 - static_cast<uint32_t>(__builtin_clzll(value)); }
+
+uint32_t lowestBit(uint64_t value) { return static_cast<uint32_t>(__builtin_ctzll(value)); }
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+uint64_t alignDown(uint64_t value, uint64_t alignment) { return value & ~(alignment - 1); }
+
+}  // namespace
+
+// ---------------------------------------------------------------------------------------------------------------
+// LveTlsf
+
+LveTlsf::LveTlsf(uint64_t capacity) : capacity_{alignDown(capacity, GRANULARITY)} {
+    firstRange = new Range{0, capacity_, true, nullptr, nullptr, nullptr, nullptr};
+    insertFree(firstRange);
+}
+
+LveTlsf::~LveTlsf() {
+    Range *range = firstRange;
+    while (range != nullptr) {
+        Range *next = range->nextPhysical;
+        delete range;
+        range = next;
+    }
+}
+
+void LveTlsf::mapping(uint64_t size, uint32_t &fl, uint32_t &sl) {
+    if (size < SL_COUNT) {
+        fl = 0;
+        sl = static_cast<uint32_t>(size);
+        return;
+    }
+    uint32_t log2 = log2Floor(size);
+    fl = log2 - SL_BITS + 1;
+    sl = static_cast<uint32_t>(size >> (log2 - SL_BITS)) - SL_COUNT;
+}
+
+uint64_t LveTlsf::roundUpToBucket(uint64_t size) {
+    if (size < SL_COUNT) return size;
+    return size + (1ull << (log2Floor(size) - SL_BITS)) - 1;
+}
+
+void LveTlsf::insertFree(Range *range) {
+    uint32_t fl, sl;
+    mapping(range->size, fl, sl);
+    range->free = true;
+    range->prevFree = nullptr;
+    range->nextFree = freeLists[fl][sl];
+    if (range->nextFree) range->nextFree->prevFree = range;
+    freeLists[fl][sl] = range;
+    flBitmap |= 1ull << fl;
+    slBitmap[fl] |= 1u << sl;
+    freeRangeCount_++;
+}
+
+void LveTlsf::removeFree(Range *range) {
+    uint32_t fl, sl;
+    mapping(range->size, fl, sl);
+    if (range->prevFree) range->prevFree->nextFree = range->nextFree;
+    if (range->nextFree) range->nextFree->prevFree = range->prevFree;
+    if (freeLists[fl][sl] == range) {
+        freeLists[fl][sl] = range->nextFree;
+        if (freeLists[fl][sl] == nullptr) {
+            slBitmap[fl] &= ~(1u << sl);
+            if (slBitmap[fl] == 0) flBitmap &= ~(1ull << fl);
+        }
+    }
+    range->prevFree = range->nextFree = nullptr;
+    freeRangeCount_--;
+}
+
+LveTlsf::Range *LveTlsf::findFree(uint64_t size) {
+    uint32_t fl, sl;
+    mapping(roundUpToBucket(size), fl, sl);
+    if (fl < FL_COUNT) {
+        uint32_t slMap = sl < SL_COUNT ? slBitmap[fl] & (~0u << sl) : 0;
+        if (slMap == 0) {
+            uint64_t flMap = fl + 1 < 64 ? flBitmap & (~0ull << (fl + 1)) : 0;
+            if (flMap != 0) {
+                fl = lowestBit(flMap);
+                slMap = slBitmap[fl];
+            }
+        }
+        if (slMap != 0) return freeLists[fl][lowestBit(slMap)];
+    }
+
+    // good fit failed, the bucket holding size itself may still contain a range large enough
+    mapping(size, fl, sl);
+    for (Range *range = freeLists[fl][sl]; range != nullptr; range = range->nextFree) {
+        if (range->size >= size) return range;
+    }
+    return nullptr;
+}
+
+void LveTlsf::merge(Range *left, Range *right) {
+    left->size += right->size;
+    left->nextPhysical = right->nextPhysical;
+    if (right->nextPhysical) right->nextPhysical->prevPhysical = left;
+    delete right;
+}
+
+LveTlsf::Range *LveTlsf::allocate(uint64_t size, uint64_t alignment) {
+    size = alignUp(std::max<uint64_t>(size, 1), GRANULARITY);
+    alignment = std::max(alignment, GRANULARITY);
+    assert((alignment & (alignment - 1)) == 0 && "alignment must be a power of two");
+
+    // every range starts on GRANULARITY so the worst case padding is alignment - GRANULARITY
+    uint64_t needed = size + alignment - GRANULARITY;
+    if (needed > capacity_) return nullptr;
+
+    Range *range = findFree(needed);
+    if (range == nullptr) return nullptr;
+    removeFree(range);
+
+    uint64_t padding = alignUp(range->offset, alignment) - range->offset;
+    if (padding > 0) {
+        Range *front = new Range{range->offset, padding, true, range->prevPhysical, range, nullptr, nullptr};
+        if (range->prevPhysical) {
+            range->prevPhysical->nextPhysical = front;
+        } else {
+            firstRange = front;
+        }
+        range->prevPhysical = front;
+        range->offset += padding;
+        range->size -= padding;
+        insertFree(front);
+    }
+
+    if (range->size - size >= GRANULARITY) {
+        Range *back =
+            new Range{range->offset + size, range->size - size, true, range, range->nextPhysical, nullptr, nullptr};
+        if (range->nextPhysical) range->nextPhysical->prevPhysical = back;
+        range->nextPhysical = back;
+        range->size = size;
+        insertFree(back);
+    }
+
+    range->free = false;
+    usedBytes_ += range->size;
+    allocationCount_++;
+    return range;
+}
+
+void LveTlsf::free(Range *range) {
+    assert(range && !range->free && "double free in LveTlsf");
+    usedBytes_ -= range->size;
+    allocationCount_--;
+
+    if (range->prevPhysical && range->prevPhysical->free) {
+        Range *prev = range->prevPhysical;
+        removeFree(prev);
+        merge(prev, range);
+        range = prev;
+    }
+    if (range->nextPhysical && range->nextPhysical->free) {
+        removeFree(range->nextPhysical);
+        merge(range, range->nextPhysical);
+    }
+    insertFree(range);
+}
+
+uint64_t LveTlsf::largestFreeRange() const {
+    if (flBitmap == 0) return 0;
+    uint32_t fl = log2Floor(flBitmap);
+    uint32_t sl = 31 - static_cast<uint32_t>(__builtin_clz(slBitmap[fl]));
+    uint64_t largest = 0;
+    for (Range *range = freeLists[fl][sl]; range != nullptr; range = range->nextFree) {
+        largest = std::max(largest, range->size);
+    }
+    return largest;
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+// Memory categories
+
+namespace {
+
+thread_local bool scopeOpen = false;
+thread_local LveMemoryCategory scopeCategory = LveMemoryCategory::General;
+
+}  // namespace
+
+const char *memoryCategoryName(LveMemoryCategory category) {
+    switch (category) {
+        case LveMemoryCategory::General:
+            return "general";
+        case LveMemoryCategory::Mesh:
+            return "mesh";
+        case LveMemoryCategory::Texture:
+            return "texture";
+        case LveMemoryCategory::WaveCascade:
+            return "wave cascade";
+        case LveMemoryCategory::PostProcess:
+            return "post process";
+        case LveMemoryCategory::Swapchain:
+            return "swapchain";
+        case LveMemoryCategory::Staging:
+            return "staging";
+        case LveMemoryCategory::FrameRing:
+            return "frame ring";
+        default:
+            return "unknown";
+    }
+}
+
+LveMemoryScope::LveMemoryScope(LveMemoryCategory category) : previous{scopeCategory}, hadPrevious{scopeOpen} {
+    scopeOpen = true;
+    scopeCategory = category;
+}
+
+LveMemoryScope::~LveMemoryScope() {
+    scopeOpen = hadPrevious;
+    scopeCategory = previous;
+}
+
+LveMemoryCategory LveMemoryScope::resolve(LveMemoryCategory fallback) { return scopeOpen ? scopeCategory : fallback; }
+
+VkDeviceSize LveMemorySnapshot::totalCategoryBytes() const {
+    VkDeviceSize total = 0;
+    for (const auto &usage : categories) total += usage.bytes;
+    return total;
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+// LveAllocator
+
+struct LveMemoryBlock {
+    LveMemoryBlock(VkDeviceMemory memory, uint32_t memoryTypeIndex, bool optimalTiling, VkDeviceSize size)
+        : memory{memory}, memoryTypeIndex{memoryTypeIndex}, optimalTiling{optimalTiling}, tlsf{size} {}
+
+    VkDeviceMemory memory;
+    uint32_t memoryTypeIndex;
+    bool optimalTiling;
+    LveTlsf tlsf;
+    void *mapped = nullptr;
+};
+
+LveAllocator::LveAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize nonCoherentAtomSize,
+                           VkDeviceSize preferredBlockSize)
+    : physicalDevice{physicalDevice},
+      device{device},
+      nonCoherentAtomSize{std::max<VkDeviceSize>(nonCoherentAtomSize, 1)},
+      preferredBlockSize{preferredBlockSize} {
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+}
+
+LveAllocator::~LveAllocator() {
+    uint32_t leaked = 0;
+    for (auto &pool : pools) {
+        for (auto &block : pool.blocks) {
+            leaked += block->tlsf.allocationCount();
+            if (block->mapped) vkUnmapMemory(device, block->memory);
+            vkFreeMemory(device, block->memory, nullptr);
+        }
+        pool.blocks.clear();
+    }
+    for (uint32_t count : dedicatedCount) leaked += count;
+    if (leaked > 0) {
+        std::cerr << "LveAllocator: " << leaked << " allocation(s) still alive at destruction" << std::endl;
+    }
+}
+
+uint32_t LveAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+        if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+VkDeviceSize LveAllocator::blockSizeForType(uint32_t memoryTypeIndex) const {
+    uint32_t heapIndex = memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+    VkDeviceSize heapSize = memoryProperties.memoryHeaps[heapIndex].size;
+    // small heaps (e.g. the 256MB BAR heap) get smaller blocks so one block never eats the whole heap
+    return std::min(preferredBlockSize, alignDown(heapSize / 8, LveTlsf::GRANULARITY));
+}
+
+LveMemoryBlock *LveAllocator::createBlock(uint32_t memoryTypeIndex, VkDeviceSize size, bool optimalTiling) {
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        return nullptr;
+    }
+
+    Pool &pool = getPool(memoryTypeIndex, optimalTiling);
+    pool.blocks.push_back(std::make_unique<LveMemoryBlock>(memory, memoryTypeIndex, optimalTiling, size));
+    return pool.blocks.back().get();
+}
+
+void LveAllocator::destroyBlock(LveMemoryBlock *block) {
+    Pool &pool = getPool(block->memoryTypeIndex, block->optimalTiling);
+    if (block->mapped) vkUnmapMemory(device, block->memory);
+    vkFreeMemory(device, block->memory, nullptr);
+    pool.blocks.erase(std::remove_if(pool.blocks.begin(), pool.blocks.end(),
+                                     [block](const std::unique_ptr<LveMemoryBlock> &b) { return b.get() == block; }),
+                      pool.blocks.end());
+}
+
+LveAllocation LveAllocator::allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties,
+                                     bool optimalTiling, LveMemoryCategory category) {
+    std::lock_guard<std::mutex> lock{mutex};
+
+    LveAllocation allocation = allocateLocked(requirements, properties, optimalTiling);
+    allocation.category = LveMemoryScope::resolve(category);
+    LveCategoryUsage &usage = categoryUsage[static_cast<size_t>(allocation.category)];
+    usage.allocationCount++;
+    usage.bytes += allocation.size;
+    return allocation;
+}
+
+LveAllocation LveAllocator::allocateLocked(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties,
+                                           bool optimalTiling) {
+    LveAllocation allocation{};
+    allocation.memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, properties);
+    VkMemoryPropertyFlags typeFlags = memoryProperties.memoryTypes[allocation.memoryTypeIndex].propertyFlags;
+
+    VkDeviceSize alignment = requirements.alignment;
+    if ((typeFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(typeFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
+        // keeps flush ranges of neighbouring allocations from overlapping
+        alignment = std::max(alignment, nonCoherentAtomSize);
+    }
+
+    VkDeviceSize blockSize = blockSizeForType(allocation.memoryTypeIndex);
+    if (requirements.size <= blockSize / 2) {
+        Pool &pool = getPool(allocation.memoryTypeIndex, optimalTiling);
+        for (auto &block : pool.blocks) {
+            if (block->tlsf.capacity() - block->tlsf.usedBytes() < requirements.size) continue;
+            if (LveTlsf::Range *range = block->tlsf.allocate(requirements.size, alignment)) {
+                allocation.memory = block->memory;
+                allocation.offset = range->offset;
+                allocation.size = range->size;
+                allocation.block = block.get();
+                allocation.range = range;
+                return allocation;
+            }
+        }
+
+        if (LveMemoryBlock *block = createBlock(allocation.memoryTypeIndex, blockSize, optimalTiling)) {
+            LveTlsf::Range *range = block->tlsf.allocate(requirements.size, alignment);
+            assert(range && "fresh block can't hold an allocation smaller than half its size");
+            allocation.memory = block->memory;
+            allocation.offset = range->offset;
+            allocation.size = range->size;
+            allocation.block = block;
+            allocation.range = range;
+            return allocation;
+        }
+        // a whole block didn't fit in the heap anymore, last chance with an exactly sized allocation
+    }
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = requirements.size;
+    allocInfo.memoryTypeIndex = allocation.memoryTypeIndex;
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &allocation.memory) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate device memory!");
+    }
+    allocation.offset = 0;
+    allocation.size = requirements.size;
+    dedicatedCount[allocation.memoryTypeIndex]++;
+    dedicatedBytes[allocation.memoryTypeIndex] += requirements.size;
+    return allocation;
+}
+
+void LveAllocator::free(LveAllocation &allocation) {
+    if (!allocation.isValid()) return;
+    std::lock_guard<std::mutex> lock{mutex};
+
+    LveCategoryUsage &usage = categoryUsage[static_cast<size_t>(allocation.category)];
+    usage.allocationCount--;
+    usage.bytes -= allocation.size;
+
+    if (allocation.isDedicated()) {
+        auto mapping = std::find_if(dedicatedMappings.begin(), dedicatedMappings.end(),
+                                    [&](const DedicatedMapping &m) { return m.memory == allocation.memory; });
+        if (mapping != dedicatedMappings.end()) {
+            vkUnmapMemory(device, allocation.memory);
+            dedicatedMappings.erase(mapping);
+        }
+        vkFreeMemory(device, allocation.memory, nullptr);
+        dedicatedCount[allocation.memoryTypeIndex]--;
+        dedicatedBytes[allocation.memoryTypeIndex] -= allocation.size;
+    } else {
+        LveMemoryBlock *block = allocation.block;
+        block->tlsf.free(allocation.range);
+        // one empty block per pool is kept around so a load / unload loop doesn't hit vkAllocateMemory every time
+        if (block->tlsf.empty()) {
+            Pool &pool = getPool(block->memoryTypeIndex, block->optimalTiling);
+            bool otherEmptyBlock = std::any_of(pool.blocks.begin(), pool.blocks.end(), [block](const auto &b) {
+                return b.get() != block && b->tlsf.empty();
+            });
+            if (otherEmptyBlock) destroyBlock(block);
+        }
+    }
+    allocation = LveAllocation{};
+}
+
+VkResult LveAllocator::map(const LveAllocation &allocation, void **data) {
+    assert(allocation.isValid() && "Called map on an invalid allocation");
+    std::lock_guard<std::mutex> lock{mutex};
+
+    if (allocation.isDedicated()) {
+        for (auto &mapping : dedicatedMappings) {
+            if (mapping.memory == allocation.memory) {
+                mapping.mapCount++;
+                *data = mapping.data;
+                return VK_SUCCESS;
+            }
+        }
+        VkResult result = vkMapMemory(device, allocation.memory, 0, VK_WHOLE_SIZE, 0, data);
+        if (result == VK_SUCCESS) dedicatedMappings.push_back({allocation.memory, *data, 1});
+        return result;
+    }
+
+    LveMemoryBlock *block = allocation.block;
+    if (block->mapped == nullptr) {
+        VkResult result = vkMapMemory(device, block->memory, 0, VK_WHOLE_SIZE, 0, &block->mapped);
+        if (result != VK_SUCCESS) return result;
+    }
+    *data = static_cast<char *>(block->mapped) + allocation.offset;
+    return VK_SUCCESS;
+}
+
+void LveAllocator::unmap(const LveAllocation &allocation) {
+    if (!allocation.isDedicated()) return;  // blocks stay persistently mapped
+    std::lock_guard<std::mutex> lock{mutex};
+
+    for (auto mapping = dedicatedMappings.begin(); mapping != dedicatedMappings.end(); mapping++) {
+        if (mapping->memory == allocation.memory) {
+            if (--mapping->mapCount == 0) {
+                vkUnmapMemory(device, allocation.memory);
+                dedicatedMappings.erase(mapping);
+            }
+            return;
+        }
+    }
+}
+
+bool LveAllocator::buildMappedRange(const LveAllocation &allocation, VkDeviceSize size, VkDeviceSize offset,
+                                    VkMappedMemoryRange &range) const {
+    VkMemoryPropertyFlags typeFlags = memoryProperties.memoryTypes[allocation.memoryTypeIndex].propertyFlags;
+    if (typeFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) return false;
+
+    VkDeviceSize memorySize = allocation.isDedicated() ? allocation.size : allocation.block->tlsf.capacity();
+    VkDeviceSize begin = allocation.offset + offset;
+    VkDeviceSize end = size == VK_WHOLE_SIZE ? allocation.offset + allocation.size : begin + size;
+    begin = alignDown(begin, nonCoherentAtomSize);
+    end = alignUp(end, nonCoherentAtomSize);
+
+    range = {};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = allocation.memory;
+    range.offset = begin;
+    range.size = end >= memorySize ? VK_WHOLE_SIZE : end - begin;
+    return true;
+}
+
+VkResult LveAllocator::flush(const LveAllocation &allocation, VkDeviceSize size, VkDeviceSize offset) {
+    VkMappedMemoryRange range;
+    if (!buildMappedRange(allocation, size, offset, range)) return VK_SUCCESS;
+    return vkFlushMappedMemoryRanges(device, 1, &range);
+}
+
+VkResult LveAllocator::flush(const LveAllocation &allocation, const std::vector<LveByteRange> &ranges) {
+    std::vector<VkMappedMemoryRange> mappedRanges;
+    mappedRanges.reserve(ranges.size());
+    for (const LveByteRange &byteRange : ranges) {
+        VkMappedMemoryRange range;
+        if (!buildMappedRange(allocation, byteRange.size, byteRange.offset, range)) return VK_SUCCESS;
+        mappedRanges.push_back(range);
+    }
+    if (mappedRanges.empty()) return VK_SUCCESS;
+
+    // the atom alignment makes neighbouring writes overlap, one range per contiguous dirty area is enough
+    std::sort(mappedRanges.begin(), mappedRanges.end(),
+              [](const VkMappedMemoryRange &a, const VkMappedMemoryRange &b) { return a.offset < b.offset; });
+    size_t count = 0;
+    for (size_t i = 1; i < mappedRanges.size(); i++) {
+        VkMappedMemoryRange &merged = mappedRanges[count];
+        const VkMappedMemoryRange &next = mappedRanges[i];
+        if (merged.size == VK_WHOLE_SIZE) break;
+        if (next.offset <= merged.offset + merged.size) {
+            merged.size = next.size == VK_WHOLE_SIZE
+                              ? VK_WHOLE_SIZE
+                              : std::max(merged.offset + merged.size, next.offset + next.size) - merged.offset;
+        } else {
+            mappedRanges[++count] = next;
+        }
+    }
+    return vkFlushMappedMemoryRanges(device, static_cast<uint32_t>(count + 1), mappedRanges.data());
+}
+
+VkResult LveAllocator::invalidate(const LveAllocation &allocation, VkDeviceSize size, VkDeviceSize offset) {
+    VkMappedMemoryRange range;
+    if (!buildMappedRange(allocation, size, offset, range)) return VK_SUCCESS;
+    return vkInvalidateMappedMemoryRanges(device, 1, &range);
+}
+
+std::vector<LveHeapStatistics> LveAllocator::getHeapStatistics() const {
+    std::lock_guard<std::mutex> lock{mutex};
+
+    std::vector<LveHeapStatistics> heaps(memoryProperties.memoryHeapCount);
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+        heaps[i].heapIndex = i;
+        heaps[i].heapSize = memoryProperties.memoryHeaps[i].size;
+        heaps[i].heapFlags = memoryProperties.memoryHeaps[i].flags;
+    }
+
+    for (uint32_t type = 0; type < memoryProperties.memoryTypeCount; type++) {
+        LveHeapStatistics &heap = heaps[memoryProperties.memoryTypes[type].heapIndex];
+        heap.dedicatedAllocationCount += dedicatedCount[type];
+        heap.dedicatedAllocationBytes += dedicatedBytes[type];
+
+        for (bool optimalTiling : {false, true}) {
+            for (const auto &block : pools[type * 2 + optimalTiling].blocks) {
+                heap.blockCount++;
+                heap.blockBytes += block->tlsf.capacity();
+                heap.allocationCount += block->tlsf.allocationCount();
+                heap.allocationBytes += block->tlsf.usedBytes();
+                heap.freeRangeCount += block->tlsf.freeRangeCount();
+                heap.largestFreeRange = std::max(heap.largestFreeRange, block->tlsf.largestFreeRange());
+            }
+        }
+    }
+    return heaps;
+}
+
+void LveAllocator::printStatistics(std::ostream &out) const {
+    constexpr double MB = 1024.0 * 1024.0;
+    for (const auto &heap : getHeapStatistics()) {
+        if (heap.blockCount == 0 && heap.dedicatedAllocationCount == 0) continue;
+        VkDeviceSize freeBytes = heap.blockBytes - heap.allocationBytes;
+        double fragmentation = freeBytes > 0 ? 1.0 - double(heap.largestFreeRange) / double(freeBytes) : 0.0;
+        out << "heap " << heap.heapIndex
+            << ((heap.heapFlags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? " (device local)" : " (host)") << " : "
+            << heap.blockCount << " block(s) " << heap.blockBytes / MB << " MB, " << heap.allocationCount
+            << " sub-allocation(s) " << heap.allocationBytes / MB << " MB, " << heap.dedicatedAllocationCount
+            << " dedicated " << heap.dedicatedAllocationBytes / MB << " MB, " << heap.freeRangeCount
+            << " free range(s), fragmentation " << fragmentation * 100.0 << "%" << std::endl;
+    }
+}
+
+void LveAllocator::enableMemoryBudget(PFN_vkGetPhysicalDeviceMemoryProperties2KHR getMemoryProperties2) {
+    std::lock_guard<std::mutex> lock{mutex};
+    this->getMemoryProperties2 = getMemoryProperties2;
+}
+
+LveMemorySnapshot LveAllocator::getMemorySnapshot() const {
+    std::vector<LveHeapStatistics> statistics = getHeapStatistics();
+
+    LveMemorySnapshot snapshot{};
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        snapshot.categories = categoryUsage;
+    }
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+    budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    if (getMemoryProperties2 != nullptr) {
+        VkPhysicalDeviceMemoryProperties2KHR memoryProperties2{};
+        memoryProperties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+        memoryProperties2.pNext = &budgetProperties;
+        getMemoryProperties2(physicalDevice, &memoryProperties2);
+        snapshot.budgetFromDriver = true;
+    }
+
+    for (const auto &heap : statistics) {
+        LveHeapBudget budget{};
+        budget.heapIndex = heap.heapIndex;
+        budget.heapSize = heap.heapSize;
+        budget.heapFlags = heap.heapFlags;
+        budget.allocatorBytes = heap.blockBytes + heap.dedicatedAllocationBytes;
+        if (snapshot.budgetFromDriver) {
+            budget.budget = budgetProperties.heapBudget[heap.heapIndex];
+            budget.usage = budgetProperties.heapUsage[heap.heapIndex];
+        } else {
+            // without the extension other processes are invisible, keep the same margin drivers usually report
+            budget.budget = heap.heapSize * 8 / 10;
+            budget.usage = budget.allocatorBytes;
+        }
+        snapshot.heaps.push_back(budget);
+    }
+    return snapshot;
+}
+
+void LveAllocator::printMemoryReport(std::ostream &out) const {
+    constexpr double MB = 1024.0 * 1024.0;
+    LveMemorySnapshot snapshot = getMemorySnapshot();
+
+    out << "memory report (" << (snapshot.budgetFromDriver ? "VK_EXT_memory_budget" : "estimated budget") << ")"
+        << std::endl;
+    for (const auto &heap : snapshot.heaps) {
+        if (heap.allocatorBytes == 0 && heap.usage == 0) continue;
+        out << "  heap " << heap.heapIndex
+            << ((heap.heapFlags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? " (device local)" : " (host)") << " : "
+            << heap.usage / MB << " / " << heap.budget / MB << " MB used, " << heap.allocatorBytes / MB
+            << " MB held by the engine" << std::endl;
+    }
+    for (size_t i = 0; i < snapshot.categories.size(); i++) {
+        const LveCategoryUsage &usage = snapshot.categories[i];
+        if (usage.allocationCount == 0) continue;
+        out << "  " << memoryCategoryName(static_cast<LveMemoryCategory>(i)) << " : " << usage.allocationCount
+            << " allocation(s) " << usage.bytes / MB << " MB" << std::endl;
+    }
+}
+
+std::vector<LveDefragmentationCandidate> LveAllocator::getDefragmentationCandidates(float maxBlockUsage) const {
+    std::lock_guard<std::mutex> lock{mutex};
+
+    std::vector<LveDefragmentationCandidate> candidates;
+    for (const auto &pool : pools) {
+        if (pool.blocks.size() < 2) continue;  // nowhere to move to
+        for (const auto &block : pool.blocks) {
+            float usage = float(block->tlsf.usedBytes()) / float(block->tlsf.capacity());
+            if (block->tlsf.empty() || usage > maxBlockUsage) continue;
+            block->tlsf.forEachAllocatedRange([&](const LveTlsf::Range &range) {
+                candidates.push_back({block->memoryTypeIndex, block->memory, range.offset, range.size, usage});
+            });
+        }
+    }
+    return candidates;
+}
+
+uint32_t LveAllocator::releaseEmptyBlocks() {
+    std::lock_guard<std::mutex> lock{mutex};
+
+    std::vector<LveMemoryBlock *> emptyBlocks;
+    for (const auto &pool : pools) {
+        for (const auto &block : pool.blocks) {
+            if (block->tlsf.empty()) emptyBlocks.push_back(block.get());
+        }
+    }
+    for (LveMemoryBlock *block : emptyBlocks) destroyBlock(block);
+    return static_cast<uint32_t>(emptyBlocks.size());
+}
+
+}  // namespace lve
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+// std
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace lve {
+
+/*
+ * Two-level segregated fit (TLSF) bookkeeping over a linear range [0, capacity).
+ * It only deals with offsets, it never touches memory, so it can manage a VkDeviceMemory block
+ * or any other address space. Allocation and free are O(1) : the first level splits sizes by
+ * power of two, the second level splits each power of two in SL_COUNT linear buckets.
+ */
+class LveTlsf {
+   public:
+    struct Range {
+        uint64_t offset;
+        uint64_t size;
+        bool free;
+        Range *prevPhysical;
+        Range *nextPhysical;
+        Range *prevFree;
+        Range *nextFree;
+    };
+
+    static constexpr uint64_t GRANULARITY = 16;
+
+    explicit LveTlsf(uint64_t capacity);
+    ~LveTlsf();
+
+    LveTlsf(const LveTlsf &) = delete;
+    LveTlsf &operator=(const LveTlsf &) = delete;
+
+    // Returns nullptr when no free range can hold size bytes at the requested alignment
+    Range *allocate(uint64_t size, uint64_t alignment);
+    void free(Range *range);
+
+    template <typename Fn>
+    void forEachAllocatedRange(Fn &&fn) const {
+        for (const Range *range = firstRange; range != nullptr; range = range->nextPhysical) {
+            if (!range->free) fn(*range);
+        }
+    }
+
+    uint64_t capacity() const { return capacity_; }
+    uint64_t usedBytes() const { return usedBytes_; }
+    uint32_t allocationCount() const { return allocationCount_; }
+    uint32_t freeRangeCount() const { return freeRangeCount_; }
+    uint64_t largestFreeRange() const;
+    bool empty() const { return allocationCount_ == 0; }
+
+   private:
+    static constexpr uint32_t SL_BITS = 4;
+    static constexpr uint32_t SL_COUNT = 1u << SL_BITS;
+    static constexpr uint32_t FL_COUNT = 64 - SL_BITS + 1;
+
+    static void mapping(uint64_t size, uint32_t &fl, uint32_t &sl);
+    static uint64_t roundUpToBucket(uint64_t size);
+
+    void insertFree(Range *range);
+    void removeFree(Range *range);
+    Range *findFree(uint64_t size);
+    void merge(Range *left, Range *right);
+
+    uint64_t capacity_;
+    uint64_t usedBytes_ = 0;
+    uint32_t allocationCount_ = 0;
+    uint32_t freeRangeCount_ = 0;
+    Range *firstRange = nullptr;
+
+    uint64_t flBitmap = 0;
+    std::array<uint32_t, FL_COUNT> slBitmap{};
+    std::array<std::array<Range *, SL_COUNT>, FL_COUNT> freeLists{};
+};
+
+struct LveMemoryBlock;
+
+// Owner of an allocation, only used for reporting
+enum class LveMemoryCategory : uint32_t {
+    General = 0,
+    Mesh,
+    Texture,
+    WaveCascade,
+    PostProcess,
+    Swapchain,
+    Staging,
+    FrameRing,
+    Count
+};
+
+const char *memoryCategoryName(LveMemoryCategory category);
+
+/*
+ * While alive, every allocation made on this thread is charged to category, whatever the category asked by the
+ * helper that allocates (LveTexture, LveBuffer...). Lets a subsystem own everything it creates in its constructor.
+ * Scopes nest, the innermost one wins : the upload batcher opens a Staging one around its staging buffers, so the
+ * transient copies of an upload are never charged to the subsystem.
+ */
+class LveMemoryScope {
+   public:
+    explicit LveMemoryScope(LveMemoryCategory category);
+    ~LveMemoryScope();
+
+    LveMemoryScope(const LveMemoryScope &) = delete;
+    LveMemoryScope &operator=(const LveMemoryScope &) = delete;
+
+    // Category of the innermost scope, fallback when no scope is open
+    static LveMemoryCategory resolve(LveMemoryCategory fallback);
+
+   private:
+    LveMemoryCategory previous;
+    bool hadPrevious;
+};
+
+// Byte range relative to the start of an allocation
+struct LveByteRange {
+    VkDeviceSize offset;
+    VkDeviceSize size;
+};
+
+/*
+ * A sub-range of a VkDeviceMemory owned by LveAllocator. Resources bind at (memory, offset).
+ * A null block means the allocation got its own VkDeviceMemory (dedicated).
+ */
+struct LveAllocation {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    uint32_t memoryTypeIndex = 0;
+    LveMemoryCategory category = LveMemoryCategory::General;
+
+    LveMemoryBlock *block = nullptr;
+    LveTlsf::Range *range = nullptr;
+
+    bool isValid() const { return memory != VK_NULL_HANDLE; }
+    bool isDedicated() const { return block == nullptr; }
+};
+
+struct LveHeapStatistics {
+    uint32_t heapIndex;
+    VkDeviceSize heapSize;
+    VkMemoryHeapFlags heapFlags;
+
+    uint32_t blockCount = 0;
+    VkDeviceSize blockBytes = 0;
+    uint32_t allocationCount = 0;
+    VkDeviceSize allocationBytes = 0;
+    uint32_t dedicatedAllocationCount = 0;
+    VkDeviceSize dedicatedAllocationBytes = 0;
+    uint32_t freeRangeCount = 0;
+    VkDeviceSize largestFreeRange = 0;
+};
+
+struct LveCategoryUsage {
+    uint32_t allocationCount = 0;
+    VkDeviceSize bytes = 0;
+};
+
+// usage and budget come from VK_EXT_memory_budget when available, otherwise from our own bookkeeping
+struct LveHeapBudget {
+    uint32_t heapIndex;
+    VkDeviceSize heapSize;
+    VkMemoryHeapFlags heapFlags;
+    VkDeviceSize budget = 0;
+    VkDeviceSize usage = 0;
+    // memory this allocator holds on the heap (blocks + dedicated)
+    VkDeviceSize allocatorBytes = 0;
+};
+
+struct LveMemorySnapshot {
+    bool budgetFromDriver = false;
+    std::array<LveCategoryUsage, static_cast<size_t>(LveMemoryCategory::Count)> categories{};
+    std::vector<LveHeapBudget> heaps;
+
+    const LveCategoryUsage &operator[](LveMemoryCategory category) const {
+        return categories[static_cast<size_t>(category)];
+    }
+    VkDeviceSize totalCategoryBytes() const;
+};
+
+// A live sub-allocation sitting in a sparsely used block; moving it elsewhere lets the block be released
+struct LveDefragmentationCandidate {
+    uint32_t memoryTypeIndex;
+    VkDeviceMemory memory;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+    float blockUsage;
+};
+
+class LveAllocator {
+   public:
+    static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+    LveAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize nonCoherentAtomSize,
+                 VkDeviceSize preferredBlockSize = DEFAULT_BLOCK_SIZE);
+    ~LveAllocator();
+
+    LveAllocator(const LveAllocator &) = delete;
+    LveAllocator &operator=(const LveAllocator &) = delete;
+
+    // optimalTiling separates optimal images from buffers so bufferImageGranularity never applies inside a block
+    // category is overridden by an open LveMemoryScope
+    LveAllocation allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties,
+                           bool optimalTiling, LveMemoryCategory category = LveMemoryCategory::General);
+    void free(LveAllocation &allocation);
+
+    // Host visible blocks are mapped once and stay mapped, the returned pointer is already offset to the allocation
+    VkResult map(const LveAllocation &allocation, void **data);
+    void unmap(const LveAllocation &allocation);
+    // Offsets are relative to the allocation, ranges are widened to nonCoherentAtomSize and skipped on coherent memory
+    VkResult flush(const LveAllocation &allocation, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+    VkResult invalidate(const LveAllocation &allocation, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+    // Widens every range to nonCoherentAtomSize, merges the ones that touch and flushes them in a single call
+    VkResult flush(const LveAllocation &allocation, const std::vector<LveByteRange> &ranges);
+
+    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+    const VkPhysicalDeviceMemoryProperties &getMemoryProperties() const { return memoryProperties; }
+
+    std::vector<LveHeapStatistics> getHeapStatistics() const;
+    void printStatistics(std::ostream &out) const;
+
+    // Only call once the device was created with VK_EXT_memory_budget
+    void enableMemoryBudget(PFN_vkGetPhysicalDeviceMemoryProperties2KHR getMemoryProperties2);
+    bool hasMemoryBudget() const { return getMemoryProperties2 != nullptr; }
+    LveMemorySnapshot getMemorySnapshot() const;
+    void printMemoryReport(std::ostream &out) const;
+
+    // Defragmentation hooks : owners move the returned allocations, then releaseEmptyBlocks gives the memory back
+    std::vector<LveDefragmentationCandidate> getDefragmentationCandidates(float maxBlockUsage = 0.25f) const;
+    uint32_t releaseEmptyBlocks();
+
+   private:
+    struct Pool {
+        std::vector<std::unique_ptr<LveMemoryBlock>> blocks;
+    };
+
+    LveAllocation allocateLocked(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties,
+                                 bool optimalTiling);
+    LveMemoryBlock *createBlock(uint32_t memoryTypeIndex, VkDeviceSize size, bool optimalTiling);
+    void destroyBlock(LveMemoryBlock *block);
+    Pool &getPool(uint32_t memoryTypeIndex, bool optimalTiling) { return pools[memoryTypeIndex * 2 + optimalTiling]; }
+    VkDeviceSize blockSizeForType(uint32_t memoryTypeIndex) const;
+    // Returns false when the memory is host coherent and no flush / invalidate is needed
+    bool buildMappedRange(const LveAllocation &allocation, VkDeviceSize size, VkDeviceSize offset,
+                          VkMappedMemoryRange &range) const;
+
+    VkPhysicalDevice physicalDevice;
+    VkDevice device;
+    VkDeviceSize nonCoherentAtomSize;
+    VkDeviceSize preferredBlockSize;
+    VkPhysicalDeviceMemoryProperties memoryProperties{};
+
+    std::array<Pool, VK_MAX_MEMORY_TYPES * 2> pools;
+    std::array<uint32_t, VK_MAX_MEMORY_TYPES> dedicatedCount{};
+    std::array<VkDeviceSize, VK_MAX_MEMORY_TYPES> dedicatedBytes{};
+    struct DedicatedMapping {
+        VkDeviceMemory memory;
+        void *data;
+        uint32_t mapCount;
+    };
+    std::vector<DedicatedMapping> dedicatedMappings;
+
+    std::array<LveCategoryUsage, static_cast<size_t>(LveMemoryCategory::Count)> categoryUsage{};
+    PFN_vkGetPhysicalDeviceMemoryProperties2KHR getMemoryProperties2 = nullptr;
+
+    mutable std::mutex mutex;
+};
+
+}  // namespace lve
@@ -0,0 +1,70 @@
+#include "lve_asset_cache.hpp"
+
+// std
+#include <filesystem>
+
+namespace lve {
+
+LveAssetCache::LveAssetCache(LveDevice &device) : lveDevice{device} {}
+
+std::string LveAssetCache::normalizePath(const std::string &filepath) {
+    return std::filesystem::path(filepath).lexically_normal().generic_string();
+}
+
+template <typename T, typename Load>
+std::shared_ptr<T> LveAssetCache::get(std::unordered_map<std::string, Entry<T>> &entries, const std::string &key,
+                                      Load load) {
+    Entry<T> &entry = entries[key];
+    std::shared_ptr<T> asset = entry.asset.lock();
+    if (asset == nullptr) {
+        asset = load();
+        entry.asset = asset;
+        entry.loadCount++;
+    }
+    entry.requestCount++;
+    return asset;
+}
+
+std::shared_ptr<LveTexture> LveAssetCache::getTexture(const std::string &filepath, bool isComputeTexture,
+                                                      uint32_t mipLevels) {
+    std::string key = normalizePath(filepath) + (isComputeTexture ? " compute" : " object") + " mips " +
+                      std::to_string(mipLevels);
+    return get(textures, key, [&]() {
+        return std::make_shared<LveTexture>(lveDevice, filepath, isComputeTexture, mipLevels);
+    });
+}
+
+std::shared_ptr<LveModel> LveAssetCache::getModel(const std::string &filepath, LveVertexFormat format,
+                                                  bool generateLods) {
+    std::string key = normalizePath(filepath) + " " + toString(format) + (generateLods ? " lods" : " no lods");
+    return get(models, key, [&]() {
+        return std::shared_ptr<LveModel>{LveModel::createModelFromFile(lveDevice, filepath, format, generateLods)};
+    });
+}
+
+void LveAssetCache::printReport(std::ostream &out) const {
+    uint32_t duplicateRequests = 0;
+    uint32_t reloads = 0;
+    auto countEntries = [&](const auto &entries) {
+        for (const auto &kv : entries) {
+            duplicateRequests += kv.second.requestCount - kv.second.loadCount;
+            reloads += kv.second.loadCount > 1 ? kv.second.loadCount - 1 : 0;
+        }
+    };
+    countEntries(textures);
+    countEntries(models);
+
+    out << "asset report : " << textures.size() << " texture(s), " << models.size() << " model(s), "
+        << duplicateRequests << " duplicate load(s) avoided, " << reloads << " reload(s) after eviction" << std::endl;
+    auto printEntries = [&](const char *type, const auto &entries) {
+        for (const auto &kv : entries) {
+            if (kv.second.requestCount < 2) continue;
+            out << "  " << type << " " << kv.first << " : " << kv.second.requestCount << " request(s), "
+                << kv.second.loadCount << " load(s)" << (kv.second.asset.expired() ? ", evicted" : "") << std::endl;
+        }
+    };
+    printEntries("texture", textures);
+    printEntries("model", models);
+}
+
+}  // namespace lve
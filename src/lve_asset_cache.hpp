@@ -0,0 +1,58 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_model.hpp"
+#include "lve_texture.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+namespace lve {
+
+/*
+ * Shared textures and models loaded from files, so an asset requested twice is only loaded once.
+ *
+ * Entries are keyed by the normalized path and the import options, and only hold weak references : an asset is
+ * destroyed with its last handle and loaded again by the next request. Every request is counted so the report
+ * shows which assets are requested several times (served from the cache) and which were loaded again after an
+ * eviction, a sign that nothing kept them alive in between.
+ */
+class LveAssetCache {
+   public:
+    explicit LveAssetCache(LveDevice &device);
+
+    LveAssetCache(const LveAssetCache &) = delete;
+    LveAssetCache &operator=(const LveAssetCache &) = delete;
+
+    std::shared_ptr<LveTexture> getTexture(const std::string &filepath, bool isComputeTexture = false,
+                                           uint32_t mipLevels = LveTexture::FULL_MIP_CHAIN);
+    // generateLods : see LveModel::createModelFromFile
+    std::shared_ptr<LveModel> getModel(const std::string &filepath, LveVertexFormat format = LveVertexFormat::Full,
+                                       bool generateLods = true);
+
+    // Assets requested more than once, with their request and load counts
+    void printReport(std::ostream &out) const;
+
+   private:
+    template <typename T>
+    struct Entry {
+        std::weak_ptr<T> asset;
+        uint32_t requestCount = 0;
+        uint32_t loadCount = 0;
+    };
+
+    template <typename T, typename Load>
+    std::shared_ptr<T> get(std::unordered_map<std::string, Entry<T>> &entries, const std::string &key, Load load);
+
+    static std::string normalizePath(const std::string &filepath);
+
+    LveDevice &lveDevice;
+    std::unordered_map<std::string, Entry<LveTexture>> textures;
+    std::unordered_map<std::string, Entry<LveModel>> models;
+};
+
+}  // namespace lve
@@ -0,0 +1,93 @@
+#include "lve_bindless_table.hpp"
+
+// std
+#include <stdexcept>
+
+namespace lve {
+
+LveBindlessTable::LveBindlessTable(LveDevice &device) : lveDevice{device}, freeList{std::make_shared<FreeList>()} {
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount = MAX_TEXTURES;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // slots are written while the set is bound and in use, unused slots may hold nothing or a destroyed view
+    VkDescriptorBindingFlagsEXT bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+                                               VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+                                               VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    bindingFlagsInfo.bindingCount = 1;
+    bindingFlagsInfo.pBindingFlags = &bindingFlags;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &bindingFlagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+    if (vkCreateDescriptorSetLayout(lveDevice.device(), &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create bindless texture set layout!");
+    }
+
+    descriptorPool = LveDescriptorPool::Builder(lveDevice)
+                         .setMaxSets(1)
+                         .setPoolFlags(VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT)
+                         .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_TEXTURES)
+                         .build();
+    if (!descriptorPool->allocateDescriptor(descriptorSetLayout, descriptorSet)) {
+        throw std::runtime_error("failed to allocate bindless texture set!");
+    }
+}
+
+// pipeline layouts only need the set layout while they are created
+LveBindlessTable::~LveBindlessTable() {
+    vkDestroyDescriptorSetLayout(lveDevice.device(), descriptorSetLayout, nullptr);
+}
+
+uint32_t LveBindlessTable::registerTexture(VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout) {
+    // the shared set needs external synchronization, the write stays under the lock that hands out the slot
+    std::lock_guard<std::mutex> lock{freeList->mutex};
+    uint32_t index;
+    if (!freeList->indices.empty()) {
+        index = freeList->indices.back();
+        freeList->indices.pop_back();
+    } else if (freeList->nextIndex < MAX_TEXTURES) {
+        index = freeList->nextIndex++;
+    } else {
+        throw std::runtime_error("bindless texture table is full, more than MAX_TEXTURES textures!");
+    }
+
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.sampler = sampler;
+    imageInfo.imageView = imageView;
+    imageInfo.imageLayout = imageLayout;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = descriptorSet;
+    write.dstBinding = 0;
+    write.dstArrayElement = index;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &imageInfo;
+    vkUpdateDescriptorSets(lveDevice.device(), 1, &write, 0, nullptr);
+    return index;
+}
+
+void LveBindlessTable::unregisterTexture(uint32_t index) {
+    // frames in flight may still sample the slot, it is rewritten only once they have retired
+    std::shared_ptr<FreeList> list = freeList;
+    lveDevice.getDeletionQueue().push([list, index]() {
+        std::lock_guard<std::mutex> lock{list->mutex};
+        list->indices.push_back(index);
+    });
+}
+
+uint32_t LveBindlessTable::getTextureCount() {
+    std::lock_guard<std::mutex> lock{freeList->mutex};
+    return freeList->nextIndex - static_cast<uint32_t>(freeList->indices.size());
+}
+
+}  // namespace lve
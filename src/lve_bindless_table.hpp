@@ -0,0 +1,62 @@
+#pragma once
+
+#include "lve_descriptor.hpp"
+#include "lve_device.hpp"
+
+// vulkan headers
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lve {
+
+/*
+ * Global table of sampled textures (VK_EXT_descriptor_indexing) : a single descriptor set holding an array of
+ * every texture, bound once per pipeline. LveTexture registers itself and keeps its index for its whole life,
+ * shaders pick their texture with that index (ObjectData::textureIndex) so drawing an object binds nothing.
+ *
+ * The binding is partially bound and updated after bind : a registration only writes its own slot, even while
+ * frames using the table are in flight. The slot of a destroyed texture is reused once those frames have retired.
+ */
+class LveBindlessTable {
+   public:
+    // Size of the array, MAX_BINDLESS_TEXTURES in the shaders
+    static constexpr uint32_t MAX_TEXTURES = 1024;
+    // Index of objects without texture, NO_TEXTURE in the shaders
+    static constexpr uint32_t NO_TEXTURE = 0xFFFFFFFFu;
+
+    explicit LveBindlessTable(LveDevice &device);
+    ~LveBindlessTable();
+
+    LveBindlessTable(const LveBindlessTable &) = delete;
+    LveBindlessTable &operator=(const LveBindlessTable &) = delete;
+
+    // The view must stay valid until unregisterTexture
+    uint32_t registerTexture(VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout);
+    void unregisterTexture(uint32_t index);
+
+    VkDescriptorSetLayout getDescriptorSetLayout() const { return descriptorSetLayout; }
+    VkDescriptorSet getDescriptorSet() const { return descriptorSet; }
+    uint32_t getTextureCount();
+
+   private:
+    // shared with the deletion queue entries, which may run after the table is gone. The mutex also guards the
+    // descriptor set writes
+    struct FreeList {
+        std::mutex mutex;
+        std::vector<uint32_t> indices;
+        uint32_t nextIndex = 0;
+    };
+
+    LveDevice &lveDevice;
+    VkDescriptorSetLayout descriptorSetLayout;
+    std::unique_ptr<LveDescriptorPool> descriptorPool;
+    VkDescriptorSet descriptorSet;
+    std::shared_ptr<FreeList> freeList;
+};
+
+}  // namespace lve
@@ -8,9 +8,16 @@
 #include "lve_buffer.hpp"
 
 // std
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <cstring>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LVE_STREAMING_STORES 1
+#endif
+
 namespace lve {
 
 /**
@@ -31,7 +38,7 @@ VkDeviceSize LveBuffer::getAlignment(VkDeviceSize instanceSize, VkDeviceSize min
 
 LveBuffer::LveBuffer(LveDevice &device, VkDeviceSize instanceSize, uint32_t instanceCount,
                      VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memoryPropertyFlags,
-                     VkDeviceSize minOffsetAlignment)
+                     VkDeviceSize minOffsetAlignment, LveMemoryCategory category)
     : lveDevice{device},
       instanceSize{instanceSize},
       instanceCount{instanceCount},
@@ -39,18 +46,21 @@ LveBuffer::LveBuffer(LveDevice &device, VkDeviceSize instanceSize, uint32_t inst
       memoryPropertyFlags{memoryPropertyFlags} {
     alignmentSize = getAlignment(instanceSize, minOffsetAlignment);
     bufferSize = alignmentSize * instanceCount;
-    device.createBuffer(bufferSize, usageFlags, memoryPropertyFlags, buffer, memory);
+    device.createBuffer(bufferSize, usageFlags, memoryPropertyFlags, buffer, allocation, category);
 }
 
 LveBuffer::~LveBuffer() {
     unmap();
-    vkDestroyBuffer(lveDevice.device(), buffer, nullptr);
-    vkFreeMemory(lveDevice.device(), memory, nullptr);
+    // frames still in flight may read the buffer
+    lveDevice.getDeletionQueue().destroyBuffer(buffer, allocation);
 }
 
 /**
  * Map a memory range of this buffer. If successful, mapped points to the specified buffer range.
  *
+ * @note The buffer lives inside a larger allocator block which stays persistently mapped, so this
+ * only resolves the pointer; size is kept for API compatibility
+ *
  * @param size (Optional) Size of the memory range to map. Pass VK_WHOLE_SIZE to map the complete
  * buffer range.
  * @param offset (Optional) Byte offset from beginning
@@ -58,8 +68,13 @@ LveBuffer::~LveBuffer() {
  * @return VkResult of the buffer mapping call
  */
 VkResult LveBuffer::map(VkDeviceSize size, VkDeviceSize offset) {
-    assert(buffer && memory && "Called map on buffer before create");
-    return vkMapMemory(lveDevice.device(), memory, offset, size, 0, &mapped);
+    assert(buffer && allocation.isValid() && "Called map on buffer before create");
+    void *data = nullptr;
+    VkResult result = lveDevice.getAllocator().map(allocation, &data);
+    if (result == VK_SUCCESS) {
+        mapped = static_cast<char *>(data) + offset;
+    }
+    return result;
 }
 
 /**
@@ -69,7 +84,7 @@ VkResult LveBuffer::map(VkDeviceSize size, VkDeviceSize offset) {
  */
 void LveBuffer::unmap() {
     if (mapped) {
-        vkUnmapMemory(lveDevice.device(), memory);
+        lveDevice.getAllocator().unmap(allocation);
         mapped = nullptr;
     }
 }
@@ -93,26 +108,109 @@ void LveBuffer::writeToBuffer(void *data, VkDeviceSize size, VkDeviceSize offset
         memOffset += offset;
         memcpy(memOffset, data, size);
     }
+    markDirty(size, offset);
+}
+
+/**
+ * Copies the specified data to the mapped buffer with non-temporal stores
+ *
+ * @note Meant for large uploads into write-combined memory (host visible, not cached), the data does
+ * not go through the CPU caches so it neither evicts useful lines nor costs read-for-ownership traffic
+ *
+ * @param data Pointer to the data to copy
+ * @param size Size of the data to copy
+ * @param offset (Optional) Byte offset from beginning of mapped region
+ *
+ */
+void LveBuffer::writeToBufferStreaming(const void *data, VkDeviceSize size, VkDeviceSize offset) {
+    assert(mapped && "Cannot copy to unmapped buffer");
+    assert(offset + size <= bufferSize && "Streaming write out of the buffer");
+
+    streamCopy(static_cast<char *>(mapped) + offset, data, size);
+    markDirty(size, offset);
+}
+
+void LveBuffer::streamCopy(void *dst, const void *src, VkDeviceSize size) {
+#ifdef LVE_STREAMING_STORES
+    char *out = static_cast<char *>(dst);
+    const char *in = static_cast<const char *>(src);
+
+    // plain copy up to the first 16 bytes aligned destination address
+    size_t head = (16 - (reinterpret_cast<uintptr_t>(out) & 15)) & 15;
+    if (size < head + 64) {
+        memcpy(out, in, size);
+        return;
+    }
+    memcpy(out, in, head);
+    out += head;
+    in += head;
+    size -= head;
+
+    // 64 bytes per iteration fill a whole write-combining buffer
+    for (; size >= 64; size -= 64, out += 64, in += 64) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 16));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 32));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i *>(out), a);
+        _mm_stream_si128(reinterpret_cast<__m128i *>(out + 16), b);
+        _mm_stream_si128(reinterpret_cast<__m128i *>(out + 32), c);
+        _mm_stream_si128(reinterpret_cast<__m128i *>(out + 48), d);
+    }
+    memcpy(out, in, size);
+    // streaming stores are weakly ordered, make them visible before the GPU is told to read
+    _mm_sfence();
+#else
+    memcpy(dst, src, size);
+#endif
+}
+
+/**
+ * Records a written range, the next flush without arguments covers it
+ *
+ * @param size (Optional) Size of the written range. Pass VK_WHOLE_SIZE for the whole buffer.
+ * @param offset (Optional) Byte offset from beginning
+ *
+ */
+void LveBuffer::markDirty(VkDeviceSize size, VkDeviceSize offset) {
+    if (size == VK_WHOLE_SIZE) {
+        dirtyRanges.assign(1, LveByteRange{0, bufferSize});
+        return;
+    }
+    dirtyRanges.push_back(LveByteRange{offset, size});
+
+    if (dirtyRanges.size() > MAX_DIRTY_RANGES) {
+        VkDeviceSize begin = bufferSize;
+        VkDeviceSize end = 0;
+        for (const LveByteRange &range : dirtyRanges) {
+            begin = std::min(begin, range.offset);
+            end = std::max(end, range.offset + range.size);
+        }
+        dirtyRanges.assign(1, LveByteRange{begin, end - begin});
+    }
 }
 
 /**
  * Flush a memory range of the buffer to make it visible to the device
  *
- * @note Only required for non-coherent memory
+ * @note Only required for non-coherent memory, the range is widened to nonCoherentAtomSize
  *
- * @param size (Optional) Size of the memory range to flush. Pass VK_WHOLE_SIZE to flush the
- * complete buffer range.
+ * @param size (Optional) Size of the memory range to flush. Without size and offset only the ranges
+ * written since the last flush are flushed, coalesced into as few VkMappedMemoryRanges as possible.
  * @param offset (Optional) Byte offset from beginning
  *
  * @return VkResult of the flush call
  */
 VkResult LveBuffer::flush(VkDeviceSize size, VkDeviceSize offset) {
-    VkMappedMemoryRange mappedRange = {};
-    mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-    mappedRange.memory = memory;
-    mappedRange.offset = offset;
-    mappedRange.size = size;
-    return vkFlushMappedMemoryRanges(lveDevice.device(), 1, &mappedRange);
+    if (size == VK_WHOLE_SIZE && offset == 0) {
+        // nothing recorded : the writes went through getMappedMemory, flush everything
+        if (dirtyRanges.empty()) return lveDevice.getAllocator().flush(allocation, size, offset);
+
+        VkResult result = lveDevice.getAllocator().flush(allocation, dirtyRanges);
+        dirtyRanges.clear();
+        return result;
+    }
+    return lveDevice.getAllocator().flush(allocation, size, offset);
 }
 
 /**
@@ -127,12 +225,7 @@ VkResult LveBuffer::flush(VkDeviceSize size, VkDeviceSize offset) {
  * @return VkResult of the invalidate call
  */
 VkResult LveBuffer::invalidate(VkDeviceSize size, VkDeviceSize offset) {
-    VkMappedMemoryRange mappedRange = {};
-    mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-    mappedRange.memory = memory;
-    mappedRange.offset = offset;
-    mappedRange.size = size;
-    return vkInvalidateMappedMemoryRanges(lveDevice.device(), 1, &mappedRange);
+    return lveDevice.getAllocator().invalidate(allocation, size, offset);
 }
 
 /**
@@ -2,12 +2,21 @@
 
 #include "lve_device.hpp"
 
+// std
+#include <vector>
+
 namespace lve {
 
 class LveBuffer {
    public:
+    // uploads from this size on bypass the cache with streaming stores
+    static constexpr VkDeviceSize STREAMING_THRESHOLD = 64 * 1024;
+    // past this many dirty ranges they are collapsed into the one covering them all
+    static constexpr size_t MAX_DIRTY_RANGES = 32;
+
     LveBuffer(LveDevice& device, VkDeviceSize instanceSize, uint32_t instanceCount, VkBufferUsageFlags usageFlags,
-              VkMemoryPropertyFlags memoryPropertyFlags, VkDeviceSize minOffsetAlignment = 1);
+              VkMemoryPropertyFlags memoryPropertyFlags, VkDeviceSize minOffsetAlignment = 1,
+              LveMemoryCategory category = LveMemoryCategory::General);
     ~LveBuffer();
 
     LveBuffer(const LveBuffer&) = delete;
@@ -17,6 +26,11 @@ class LveBuffer {
     void unmap();
 
     void writeToBuffer(void* data, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+    // Same as writeToBuffer with non-temporal stores, for large uploads to write-combined memory
+    void writeToBufferStreaming(const void* data, VkDeviceSize size, VkDeviceSize offset = 0);
+    // Records a range written through getMappedMemory so the next flush() covers it
+    void markDirty(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+    // Without arguments, flushes only the ranges written since the last flush
     VkResult flush(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
     VkDescriptorBufferInfo descriptorInfo(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
     VkResult invalidate(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
@@ -30,18 +44,21 @@ class LveBuffer {
     void* getMappedMemory() const { return mapped; }
     uint32_t getInstanceCount() const { return instanceCount; }
     VkDeviceSize getInstanceSize() const { return instanceSize; }
-    VkDeviceSize getAlignmentSize() const { return instanceSize; }
+    VkDeviceSize getAlignmentSize() const { return alignmentSize; }
     VkBufferUsageFlags getUsageFlags() const { return usageFlags; }
     VkMemoryPropertyFlags getMemoryPropertyFlags() const { return memoryPropertyFlags; }
     VkDeviceSize getBufferSize() const { return bufferSize; }
 
+    // memcpy with SSE2 streaming stores when available, the destination is not read back into the cache
+    static void streamCopy(void* dst, const void* src, VkDeviceSize size);
+
    private:
     static VkDeviceSize getAlignment(VkDeviceSize instanceSize, VkDeviceSize minOffsetAlignment);
 
     LveDevice& lveDevice;
     void* mapped = nullptr;
     VkBuffer buffer = VK_NULL_HANDLE;
-    VkDeviceMemory memory = VK_NULL_HANDLE;
+    LveAllocation allocation{};
 
     VkDeviceSize bufferSize;
     uint32_t instanceCount;
@@ -49,6 +66,7 @@ class LveBuffer {
     VkDeviceSize alignmentSize;
     VkBufferUsageFlags usageFlags;
     VkMemoryPropertyFlags memoryPropertyFlags;
+    std::vector<LveByteRange> dirtyRanges;
 };
 
 }  // namespace lve
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
@@ -21,8 +22,8 @@ LveCPipeline::LveCPipeline(LveDevice &device, const std::string &computeFilepath
 }
 
 LveCPipeline::~LveCPipeline() {
-    vkDestroyShaderModule(lveDevice.device(), computeShaderModule, nullptr);
-    vkDestroyPipeline(lveDevice.device(), computePipeLine, nullptr);
+    lveDevice.getDeletionQueue().destroyShaderModule(computeShaderModule);
+    lveDevice.getDeletionQueue().destroyPipeline(computePipeLine);
 }
 
 std::vector<char> LveCPipeline::readFile(const std::string &filepath) {
@@ -63,8 +64,11 @@ void LveCPipeline::createComputePipeline(const std::string &computeFilepath,
     pipelineInfo.stage = shaderStages;
     pipelineInfo.layout = configInfo.computePipelineLayout;
 
-    VkResult test =
-        vkCreateComputePipelines(lveDevice.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &computePipeLine);
+    auto start = std::chrono::high_resolution_clock::now();
+    VkResult test = vkCreateComputePipelines(lveDevice.device(), lveDevice.pipelineCache(), 1, &pipelineInfo, nullptr,
+                                             &computePipeLine);
+    lveDevice.recordPipelineCreation(
+        std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count());
     if (test != VK_SUCCESS) {
         throw std::runtime_error("failed to create graphic pipeline");
     } else {
@@ -26,6 +26,13 @@ void LveCamera::setPerspectiveProjection(float fovy, float aspect, float near, f
     projectionMatrix[3][2] = -(far * near) / (far - near);
 }
 
+float LveCamera::getPixelsPerUnit(float distance, float viewportHeight) const {
+    // [1][1] scales view space y to the half height of the viewport, before the divide by depth in perspective
+    float pixels = glm::abs(projectionMatrix[1][1]) * viewportHeight * .5f;
+    bool perspective = projectionMatrix[2][3] != 0.f;
+    return perspective ? pixels / glm::max(distance, std::numeric_limits<float>::epsilon()) : pixels;
+}
+
 void LveCamera::setViewDirection(glm::vec3 position, glm::vec3 direction, glm::vec3 up) {
     const glm::vec3 w{glm::normalize(direction)};
     const glm::vec3 u{glm::normalize(glm::cross(w, up))};
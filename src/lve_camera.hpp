@@ -19,6 +19,9 @@ class LveCamera {
     const glm::mat4& getView() const { return viewMatrix; }
     const glm::mat4 getInverseView() const { return inverseViewMatrix; }
     const glm::vec3 getPosition() const { return glm::vec3{inverseViewMatrix[3]}; }
+    // Pixels covered by one world unit at distance from the camera in a viewport viewportHeight pixels high (the same
+    // at any distance for an orthographic projection)
+    float getPixelsPerUnit(float distance, float viewportHeight) const;
 
    private:
     glm::mat4 projectionMatrix{1.f};
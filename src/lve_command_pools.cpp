@@ -0,0 +1,102 @@
+#include "lve_command_pools.hpp"
+
+// std
+#include <cassert>
+#include <stdexcept>
+
+namespace lve {
+
+LveCommandPools::LveCommandPools(LveDevice &device, uint32_t framesInFlight, uint32_t threadCount)
+    : lveDevice{device}, framesInFlight{framesInFlight}, threadCount{threadCount} {
+    assert(threadCount > 0 && "At least the thread driving the frame needs a pool");
+    QueueFamilyIndices indices = lveDevice.findPhysicalQueueFamilies();
+
+    graphicsPools.resize(framesInFlight * threadCount);
+    for (ThreadPool &threadPool : graphicsPools) {
+        threadPool.pool = createPool(indices.graphicsAndComputeFamily);
+    }
+    if (indices.hasDedicatedCompute()) {
+        computePools.resize(framesInFlight * threadCount);
+        for (ThreadPool &threadPool : computePools) {
+            threadPool.pool = createPool(indices.computeFamily);
+        }
+    }
+}
+
+LveCommandPools::~LveCommandPools() {
+    // destroying a pool frees its command buffers
+    for (ThreadPool &threadPool : graphicsPools) vkDestroyCommandPool(lveDevice.device(), threadPool.pool, nullptr);
+    for (ThreadPool &threadPool : computePools) vkDestroyCommandPool(lveDevice.device(), threadPool.pool, nullptr);
+}
+
+VkCommandPool LveCommandPools::createPool(uint32_t queueFamilyIndex) {
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = queueFamilyIndex;
+    // no RESET_COMMAND_BUFFER_BIT : the whole pool is reset at once, which lets the driver recycle its memory
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    VkCommandPool pool;
+    if (vkCreateCommandPool(lveDevice.device(), &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create frame command pool!");
+    }
+    return pool;
+}
+
+void LveCommandPools::beginFrame(int frameSlot) {
+    assert(frameSlot >= 0 && static_cast<uint32_t>(frameSlot) < framesInFlight && "Frame slot out of range");
+    currentSlot = frameSlot;
+
+    auto resetSlot = [&](std::vector<ThreadPool> &pools) {
+        for (uint32_t thread = 0; thread < threadCount && !pools.empty(); thread++) {
+            ThreadPool &threadPool = pools[currentSlot * threadCount + thread];
+            if (threadPool.usedPrimaries == 0 && threadPool.usedSecondaries == 0) continue;
+            if (vkResetCommandPool(lveDevice.device(), threadPool.pool, 0) != VK_SUCCESS) {
+                throw std::runtime_error("failed to reset frame command pool!");
+            }
+            threadPool.usedPrimaries = 0;
+            threadPool.usedSecondaries = 0;
+        }
+    };
+    resetSlot(graphicsPools);
+    resetSlot(computePools);
+}
+
+LveCommandPools::ThreadPool &LveCommandPools::getPool(uint32_t threadIndex, QueueType queue) {
+    assert(threadIndex < threadCount && "Thread index out of range");
+    std::vector<ThreadPool> &pools =
+        queue == QueueType::Compute && !computePools.empty() ? computePools : graphicsPools;
+    return pools[currentSlot * threadCount + threadIndex];
+}
+
+VkCommandBuffer LveCommandPools::allocate(ThreadPool &threadPool, VkCommandBufferLevel level) {
+    bool primary = level == VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    std::vector<VkCommandBuffer> &buffers = primary ? threadPool.primaries : threadPool.secondaries;
+    uint32_t &used = primary ? threadPool.usedPrimaries : threadPool.usedSecondaries;
+
+    // buffers survive the pool reset, only the first frames allocate
+    if (used == buffers.size()) {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = level;
+        allocInfo.commandPool = threadPool.pool;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer;
+        if (vkAllocateCommandBuffers(lveDevice.device(), &allocInfo, &commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate frame command buffer!");
+        }
+        buffers.push_back(commandBuffer);
+    }
+    return buffers[used++];
+}
+
+VkCommandBuffer LveCommandPools::allocatePrimary(uint32_t threadIndex, QueueType queue) {
+    return allocate(getPool(threadIndex, queue), VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+}
+
+VkCommandBuffer LveCommandPools::allocateSecondary(uint32_t threadIndex) {
+    return allocate(getPool(threadIndex, QueueType::Graphics), VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+}
+
+}  // namespace lve
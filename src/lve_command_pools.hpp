@@ -0,0 +1,63 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+/*
+ * One transient command pool per frame in flight and per recording thread. Command buffers are never
+ * freed or reset one by one : once the frame scheduler has retired the frame that last used a slot,
+ * every pool of the slot is reset with a single vkResetCommandPool and its buffers are handed out again.
+ *
+ * Thread 0 is the thread driving the frame. A worker thread only touches the pool of its own index, so
+ * no locking is needed as long as beginFrame is called before the workers start recording.
+ */
+class LveCommandPools {
+   public:
+    enum class QueueType { Graphics, Compute };
+
+    LveCommandPools(LveDevice &device, uint32_t framesInFlight, uint32_t threadCount);
+    ~LveCommandPools();
+
+    LveCommandPools(const LveCommandPools &) = delete;
+    LveCommandPools &operator=(const LveCommandPools &) = delete;
+
+    // Resets every pool of the slot, the frame that last used it must be complete
+    void beginFrame(int frameSlot);
+
+    uint32_t getThreadCount() const { return threadCount; }
+
+    // Primary command buffer of the current slot, in the initial state
+    VkCommandBuffer allocatePrimary(uint32_t threadIndex = 0, QueueType queue = QueueType::Graphics);
+    // Secondary command buffer of the current slot, in the initial state, for the graphics queue
+    VkCommandBuffer allocateSecondary(uint32_t threadIndex);
+
+   private:
+    struct ThreadPool {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> primaries;
+        std::vector<VkCommandBuffer> secondaries;
+        uint32_t usedPrimaries = 0;
+        uint32_t usedSecondaries = 0;
+    };
+
+    VkCommandPool createPool(uint32_t queueFamilyIndex);
+    VkCommandBuffer allocate(ThreadPool &threadPool, VkCommandBufferLevel level);
+    ThreadPool &getPool(uint32_t threadIndex, QueueType queue);
+
+    LveDevice &lveDevice;
+    uint32_t framesInFlight;
+    uint32_t threadCount;
+    int currentSlot = 0;
+
+    // [slot * threadCount + thread]
+    std::vector<ThreadPool> graphicsPools;
+    // [slot * threadCount + thread], empty when compute work shares the graphics queue
+    std::vector<ThreadPool> computePools;
+};
+
+}  // namespace lve
@@ -0,0 +1,85 @@
+#include "lve_deletion_queue.hpp"
+
+namespace lve {
+
+LveDeletionQueue::LveDeletionQueue(VkDevice device, LveAllocator &allocator) : device{device}, allocator{allocator} {}
+
+LveDeletionQueue::~LveDeletionQueue() { flush(); }
+
+void LveDeletionQueue::beginFrame(uint64_t currentFrame, uint64_t completedFrame) {
+    std::lock_guard<std::mutex> lock{mutex};
+    this->currentFrame = currentFrame;
+    this->completedFrame = completedFrame;
+    collectLocked();
+}
+
+void LveDeletionQueue::push(std::function<void()> deleter) {
+    std::lock_guard<std::mutex> lock{mutex};
+    // entries stay sorted by frame : currentFrame only grows
+    entries.push_back({currentFrame, std::move(deleter)});
+}
+
+void LveDeletionQueue::destroyBuffer(VkBuffer buffer, LveAllocation allocation) {
+    push([this, buffer, allocation]() mutable {
+        vkDestroyBuffer(device, buffer, nullptr);
+        allocator.free(allocation);
+    });
+}
+
+void LveDeletionQueue::destroyImage(VkImage image, LveAllocation allocation) {
+    push([this, image, allocation]() mutable {
+        vkDestroyImage(device, image, nullptr);
+        allocator.free(allocation);
+    });
+}
+
+void LveDeletionQueue::destroyImageView(VkImageView imageView) {
+    push([this, imageView]() { vkDestroyImageView(device, imageView, nullptr); });
+}
+
+void LveDeletionQueue::destroyPipeline(VkPipeline pipeline) {
+    push([this, pipeline]() { vkDestroyPipeline(device, pipeline, nullptr); });
+}
+
+void LveDeletionQueue::destroyShaderModule(VkShaderModule shaderModule) {
+    push([this, shaderModule]() { vkDestroyShaderModule(device, shaderModule, nullptr); });
+}
+
+void LveDeletionQueue::destroyDescriptorPool(VkDescriptorPool descriptorPool) {
+    push([this, descriptorPool]() { vkDestroyDescriptorPool(device, descriptorPool, nullptr); });
+}
+
+void LveDeletionQueue::destroyFramebuffer(VkFramebuffer framebuffer) {
+    push([this, framebuffer]() { vkDestroyFramebuffer(device, framebuffer, nullptr); });
+}
+
+void LveDeletionQueue::destroyRenderPass(VkRenderPass renderPass) {
+    push([this, renderPass]() { vkDestroyRenderPass(device, renderPass, nullptr); });
+}
+
+void LveDeletionQueue::destroySwapchain(VkSwapchainKHR swapChain) {
+    push([this, swapChain]() { vkDestroySwapchainKHR(device, swapChain, nullptr); });
+}
+
+void LveDeletionQueue::flush() {
+    std::deque<Entry> pending;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        pending.swap(entries);
+    }
+    for (Entry &entry : pending) entry.deleter();
+}
+
+size_t LveDeletionQueue::pendingCount() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return entries.size();
+}
+
+void LveDeletionQueue::collectLocked() {
+    while (!entries.empty() && entries.front().frame <= completedFrame) {
+        entries.front().deleter();
+        entries.pop_front();
+    }
+}
+
+}  // namespace lve
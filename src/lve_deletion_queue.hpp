@@ -0,0 +1,69 @@
+#pragma once
+
+#include "lve_allocator.hpp"
+
+// vulkan headers
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace lve {
+
+/*
+ * Defers the destruction of Vulkan objects until the GPU is done with them, instead of idling the device.
+ *
+ * Every object is tagged with the frame being recorded when it is released : any frame up to that one may
+ * still reference it. The renderer reports the last frame the GPU has retired at the start of each frame
+ * and everything tagged with an older or equal frame is destroyed then. Objects released before the first
+ * frame are destroyed at the next collect, and flush destroys everything once the device is idle.
+ */
+class LveDeletionQueue {
+   public:
+    LveDeletionQueue(VkDevice device, LveAllocator &allocator);
+    ~LveDeletionQueue();
+
+    LveDeletionQueue(const LveDeletionQueue &) = delete;
+    LveDeletionQueue &operator=(const LveDeletionQueue &) = delete;
+
+    // Called by the renderer once the new frame has begun : currentFrame is being recorded, completedFrame
+    // is the last frame fully executed
+    void beginFrame(uint64_t currentFrame, uint64_t completedFrame);
+
+    void push(std::function<void()> deleter);
+    void destroyBuffer(VkBuffer buffer, LveAllocation allocation);
+    void destroyImage(VkImage image, LveAllocation allocation);
+    void destroyImageView(VkImageView imageView);
+    void destroyPipeline(VkPipeline pipeline);
+    void destroyShaderModule(VkShaderModule shaderModule);
+    void destroyDescriptorPool(VkDescriptorPool descriptorPool);
+    void destroyFramebuffer(VkFramebuffer framebuffer);
+    void destroyRenderPass(VkRenderPass renderPass);
+    void destroySwapchain(VkSwapchainKHR swapChain);
+
+    // Destroys everything, the device must be idle
+    void flush();
+
+    size_t pendingCount();
+
+   private:
+    struct Entry {
+        uint64_t frame;
+        std::function<void()> deleter;
+    };
+
+    void collectLocked();
+
+    VkDevice device;
+    LveAllocator &allocator;
+
+    std::mutex mutex;
+    std::deque<Entry> entries;
+    uint64_t currentFrame = 0;
+    uint64_t completedFrame = 0;
+};
+
+}  // namespace lve
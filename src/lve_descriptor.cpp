@@ -8,7 +8,6 @@
 
 namespace lve {
 
-std::unique_ptr<LveDescriptorSetLayout> LveDescriptorSetLayout::defaultTextureSetLayout;
 std::unique_ptr<LveDescriptorSetLayout> LveDescriptorSetLayout::defaultPostProcessingTextureSetLayout;
 
 std::unique_ptr<LveDescriptorSetLayout> LveDescriptorSetLayout::depthTextureSetLayout;
@@ -95,7 +94,7 @@ LveDescriptorPool::LveDescriptorPool(LveDevice &lveDevice, uint32_t maxSets, VkD
     }
 }
 
-LveDescriptorPool::~LveDescriptorPool() { vkDestroyDescriptorPool(lveDevice.device(), descriptorPool, nullptr); }
+LveDescriptorPool::~LveDescriptorPool() { lveDevice.getDeletionQueue().destroyDescriptorPool(descriptorPool); }
 
 bool LveDescriptorPool::allocateDescriptor(const VkDescriptorSetLayout descriptorSetLayout,
                                            VkDescriptorSet &descriptor) const {
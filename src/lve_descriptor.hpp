@@ -33,8 +33,6 @@ class LveDescriptorSetLayout {
 
     VkDescriptorSetLayout getDescriptorSetLayout() const { return descriptorSetLayout; }
 
-    static std::unique_ptr<lve::LveDescriptorSetLayout> defaultTextureSetLayout;
-
     static std::unique_ptr<lve::LveDescriptorSetLayout> defaultPostProcessingTextureSetLayout;
     static std::unique_ptr<lve::LveDescriptorSetLayout> depthTextureSetLayout;
 
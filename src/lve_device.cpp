@@ -1,12 +1,24 @@
 #include "lve_device.hpp"
 
+#include "lve_asset_cache.hpp"
+#include "lve_bindless_table.hpp"
+#include "lve_texture_cache.hpp"
+#include "lve_upload_batcher.hpp"
+
 // std headers
 #include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <set>
 #include <unordered_set>
 #include <bitset>
 
+// relative to the working directory, which is the build directory
+#ifndef PIPELINE_CACHE_PATH
+#define PIPELINE_CACHE_PATH "pipeline_cache.bin"
+#endif
+
 namespace lve
 {
 
@@ -56,7 +68,7 @@ namespace lve
   }
 
   // class member functions
-  LveDevice::LveDevice(LveWindow &window) : window{window}
+  LveDevice::LveDevice(LveWindow &window) : window{window}, headless{window.isHeadless()}
   {
     createInstance();
     setupDebugMessenger();
@@ -64,10 +76,44 @@ namespace lve
     pickPhysicalDevice();
     createLogicalDevice();
     createCommandPool();
+    createPipelineCache();
+    allocator = std::make_unique<LveAllocator>(physicalDevice, device_, properties.limits.nonCoherentAtomSize);
+    if (memoryBudgetEnabled)
+    {
+      auto getMemoryProperties2 = (PFN_vkGetPhysicalDeviceMemoryProperties2KHR)vkGetInstanceProcAddr(
+          instance, "vkGetPhysicalDeviceMemoryProperties2KHR");
+      if (getMemoryProperties2 != nullptr)
+      {
+        allocator->enableMemoryBudget(getMemoryProperties2);
+      }
+    }
+    deletionQueue = std::make_unique<LveDeletionQueue>(device_, *allocator);
+    uploadBatcher = std::make_unique<LveUploadBatcher>(*this);
+    bindlessTable = std::make_unique<LveBindlessTable>(*this);
+    textureCache = std::make_unique<LveTextureCache>();
+    assetCache = std::make_unique<LveAssetCache>(*this);
   }
 
   LveDevice::~LveDevice()
   {
+    assetCache.reset();
+    bindlessTable.reset();
+    uploadBatcher.reset();
+    // objects released by the destructors above and during the last frames
+    vkDeviceWaitIdle(device_);
+    deletionQueue.reset();
+    allocator.reset();
+    for (auto &kv : samplers)
+    {
+      vkDestroySampler(device_, kv.second, nullptr);
+    }
+    savePipelineCache();
+    vkDestroyPipelineCache(device_, pipelineCache_, nullptr);
+    if (computeCommandPool != commandPool)
+    {
+      vkDestroyCommandPool(device_, computeCommandPool, nullptr);
+    }
+    vkDestroyCommandPool(device_, singleTimeCommandPool, nullptr);
     vkDestroyCommandPool(device_, commandPool, nullptr);
     vkDestroyDevice(device_, nullptr);
 
@@ -144,12 +190,20 @@ namespace lve
       {
         vkGetPhysicalDeviceProperties(device, &properties);
         std::cout << i++ << " : " << "physical device: " << properties.deviceName << std::endl;
+        // nobody to answer the prompt on a render farm node or in CI : first suitable device
+        if (headless && physicalDevice == VK_NULL_HANDLE)
+        {
+          physicalDevice = device;
+        }
       }
     }
-    //get user input for physical device
-    std::cout << "Enter the number of the physical device you want to use: ";
-    std::cin >> i;
-    physicalDevice = devices[i];
+    if (!headless)
+    {
+      //get user input for physical device
+      std::cout << "Enter the number of the physical device you want to use: ";
+      std::cin >> i;
+      physicalDevice = devices[i];
+    }
     if (physicalDevice == VK_NULL_HANDLE)
     {
       throw std::runtime_error("failed to find a suitable GPU!");
@@ -162,10 +216,12 @@ namespace lve
   void LveDevice::createLogicalDevice()
   {
     QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+    queueFamilies = indices;
 
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     // std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily, indices.presentFamily};
-    std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsAndComputeFamily, indices.presentFamily};
+    std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsAndComputeFamily, indices.presentFamily,
+                                              indices.computeFamily};
 
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -180,16 +236,46 @@ namespace lve
 
     VkPhysicalDeviceFeatures deviceFeatures = {};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    // the bindless table is indexed with per draw values
+    deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+
+    // baked textures are block compressed, LveTexture falls back to the source images without it
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+    textureCompressionBCEnabled = supportedFeatures.textureCompressionBC == VK_TRUE;
+    deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+
+    // the frame scheduler synchronises every stage of a frame with timeline semaphores
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures = {};
+    timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+    timelineFeatures.timelineSemaphore = VK_TRUE;
+
+    // LveBindlessTable : a partially bound array of textures, written while it is in use
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures = {};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+    indexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    timelineFeatures.pNext = &indexingFeatures;
 
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &timelineFeatures;
 
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
+    // optional extensions are only enabled when present
+    std::vector<const char *> enabledExtensions = getDeviceExtensions();
+    memoryBudgetEnabled = isDeviceExtensionSupported(physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (memoryBudgetEnabled)
+    {
+      enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
     // might not really be necessary anymore because device specific validation layers
     // have been deprecated
@@ -211,6 +297,16 @@ namespace lve
     // vkGetDeviceQueue(device_, indices.graphicsFamily, 0, &graphicsQueue_);
     vkGetDeviceQueue(device_, indices.graphicsAndComputeFamily, 0, &graphicsQueue_);
     vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+    vkGetDeviceQueue(device_, indices.computeFamily, 0, &computeQueue_);
+
+    if (indices.hasDedicatedCompute())
+    {
+      std::cout << "async compute queue family: " << indices.computeFamily << std::endl;
+    }
+    else
+    {
+      std::cout << "no dedicated compute queue, compute work shares the graphics queue" << std::endl;
+    }
   }
 
   void LveDevice::createCommandPool()
@@ -228,9 +324,34 @@ namespace lve
     {
       throw std::runtime_error("failed to create command pool!");
     }
+
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    if (vkCreateCommandPool(device_, &poolInfo, nullptr, &singleTimeCommandPool) != VK_SUCCESS)
+    {
+      throw std::runtime_error("failed to create single time command pool!");
+    }
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+    computeCommandPool = commandPool;
+    if (queueFamilyIndices.hasDedicatedCompute())
+    {
+      poolInfo.queueFamilyIndex = queueFamilyIndices.computeFamily;
+      if (vkCreateCommandPool(device_, &poolInfo, nullptr, &computeCommandPool) != VK_SUCCESS)
+      {
+        throw std::runtime_error("failed to create compute command pool!");
+      }
+    }
   }
 
-  void LveDevice::createSurface() { window.createWindowSurface(instance, &surface_); }
+  void LveDevice::createSurface()
+  {
+    if (headless)
+    {
+      surface_ = VK_NULL_HANDLE;
+      return;
+    }
+    window.createWindowSurface(instance, &surface_);
+  }
 
   bool LveDevice::isDeviceSuitable(VkPhysicalDevice device)
   {
@@ -238,8 +359,9 @@ namespace lve
 
     bool extensionsSupported = checkDeviceExtensionSupport(device);
 
-    bool swapChainAdequate = false;
-    if (extensionsSupported)
+    // headless rendering goes to offscreen images, no swap chain to check
+    bool swapChainAdequate = headless;
+    if (extensionsSupported && !headless)
     {
       SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
       swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
@@ -249,7 +371,42 @@ namespace lve
     vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
     return indices.isComplete() && extensionsSupported && swapChainAdequate &&
-           supportedFeatures.samplerAnisotropy;
+           supportedFeatures.samplerAnisotropy && supportedFeatures.shaderSampledImageArrayDynamicIndexing &&
+           supportsBindlessTextures(device);
+  }
+
+  bool LveDevice::supportsBindlessTextures(VkPhysicalDevice device)
+  {
+    auto getFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2KHR)vkGetInstanceProcAddr(
+        instance, "vkGetPhysicalDeviceFeatures2KHR");
+    auto getProperties2 = (PFN_vkGetPhysicalDeviceProperties2KHR)vkGetInstanceProcAddr(
+        instance, "vkGetPhysicalDeviceProperties2KHR");
+    if (getFeatures2 == nullptr || getProperties2 == nullptr)
+    {
+      return false;
+    }
+
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures = {};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    VkPhysicalDeviceFeatures2KHR features2 = {};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features2.pNext = &indexingFeatures;
+    getFeatures2(device, &features2);
+
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties = {};
+    indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+    VkPhysicalDeviceProperties2KHR properties2 = {};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+    properties2.pNext = &indexingProperties;
+    getProperties2(device, &properties2);
+
+    return indexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+           indexingFeatures.descriptorBindingPartiallyBound &&
+           indexingFeatures.descriptorBindingUpdateUnusedWhilePending &&
+           indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers >= LveBindlessTable::MAX_TEXTURES &&
+           indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages >= LveBindlessTable::MAX_TEXTURES &&
+           indexingProperties.maxDescriptorSetUpdateAfterBindSamplers >= LveBindlessTable::MAX_TEXTURES &&
+           indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages >= LveBindlessTable::MAX_TEXTURES;
   }
 
   void LveDevice::populateDebugMessengerCreateInfo(
@@ -310,11 +467,16 @@ namespace lve
 
   std::vector<const char *> LveDevice::getRequiredExtensions()
   {
-    uint32_t glfwExtensionCount = 0;
-    const char **glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-    std::vector<const char *> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    std::vector<const char *> extensions;
+    if (!headless)
+    {
+      uint32_t glfwExtensionCount = 0;
+      const char **glfwExtensions;
+      glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+      extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
+    // required by VK_KHR_timeline_semaphore on a 1.0 instance
+    extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
 
     if (enableValidationLayers)
     {
@@ -363,7 +525,8 @@ namespace lve
         &extensionCount,
         availableExtensions.data());
 
-    std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
+    std::vector<const char *> extensions = getDeviceExtensions();
+    std::set<std::string> requiredExtensions(extensions.begin(), extensions.end());
 
     for (const auto &extension : availableExtensions)
     {
@@ -373,6 +536,131 @@ namespace lve
     return requiredExtensions.empty();
   }
 
+  void LveDevice::createPipelineCache()
+  {
+    std::vector<char> data;
+    std::ifstream file{PIPELINE_CACHE_PATH, std::ios::ate | std::ios::binary};
+    if (file.is_open())
+    {
+      data.resize(static_cast<size_t>(file.tellg()));
+      file.seekg(0);
+      file.read(data.data(), data.size());
+      file.close();
+
+      if (!isPipelineCacheCompatible(data))
+      {
+        std::cout << "pipeline cache : " << PIPELINE_CACHE_PATH << " was built for another device or driver, ignored"
+                  << std::endl;
+        data.clear();
+      }
+    }
+
+    VkPipelineCacheCreateInfo cacheInfo = {};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = data.size();
+    cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    if (vkCreatePipelineCache(device_, &cacheInfo, nullptr, &pipelineCache_) != VK_SUCCESS)
+    {
+      throw std::runtime_error("failed to create pipeline cache!");
+    }
+    pipelineCacheWarm = !data.empty();
+    std::cout << "pipeline cache : " << (pipelineCacheWarm ? "warm, " : "cold, ") << data.size() << " bytes loaded"
+              << std::endl;
+  }
+
+  bool LveDevice::isPipelineCacheCompatible(const std::vector<char> &data)
+  {
+    // VkPipelineCacheHeaderVersionOne : length, version, vendorID, deviceID, pipelineCacheUUID
+    constexpr size_t headerSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+    if (data.size() < headerSize)
+    {
+      return false;
+    }
+
+    uint32_t header[4];
+    memcpy(header, data.data(), sizeof(header));
+    if (header[0] < headerSize || header[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+    {
+      return false;
+    }
+
+    // the pipeline cache UUID changes with the driver version
+    return header[2] == properties.vendorID && header[3] == properties.deviceID &&
+           memcmp(data.data() + sizeof(header), properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+  }
+
+  void LveDevice::savePipelineCache()
+  {
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(device_, pipelineCache_, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+    {
+      return;
+    }
+    std::vector<char> data(dataSize);
+    if (vkGetPipelineCacheData(device_, pipelineCache_, &dataSize, data.data()) != VK_SUCCESS)
+    {
+      return;
+    }
+
+    // written aside then renamed over the old one : a crash mid-write never leaves a truncated cache
+    std::string temporaryPath = std::string{PIPELINE_CACHE_PATH} + ".tmp";
+    std::ofstream file{temporaryPath, std::ios::binary | std::ios::trunc};
+    if (!file.is_open())
+    {
+      std::cerr << "pipeline cache : failed to write " << temporaryPath << std::endl;
+      return;
+    }
+    file.write(data.data(), dataSize);
+    file.close();
+
+    std::error_code error;
+    if (!file)
+    {
+      std::filesystem::remove(temporaryPath, error);
+      std::cerr << "pipeline cache : failed to write " << temporaryPath << std::endl;
+      return;
+    }
+    std::filesystem::rename(temporaryPath, PIPELINE_CACHE_PATH, error);
+    if (error)
+    {
+      std::filesystem::remove(temporaryPath, error);
+      std::cerr << "pipeline cache : failed to replace " << PIPELINE_CACHE_PATH << std::endl;
+    }
+  }
+
+  std::vector<const char *> LveDevice::getDeviceExtensions()
+  {
+    std::vector<const char *> extensions;
+    for (const char *extension : deviceExtensions)
+    {
+      if (headless && strcmp(extension, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0)
+      {
+        continue;
+      }
+      extensions.push_back(extension);
+    }
+    return extensions;
+  }
+
+  bool LveDevice::isDeviceExtensionSupported(VkPhysicalDevice device, const char *extensionName)
+  {
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+    for (const auto &extension : availableExtensions)
+    {
+      if (strcmp(extension.extensionName, extensionName) == 0)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
   QueueFamilyIndices LveDevice::findQueueFamilies(VkPhysicalDevice device)
   {
     QueueFamilyIndices indices;
@@ -386,27 +674,42 @@ namespace lve
     int i = 0;
     for (const auto &queueFamily : queueFamilies)
     {
-      if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT && (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT))
+      if (!indices.graphicsFamilyHasValue && queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT && (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT))
       {
         // indices.graphicsFamily = i;
         indices.graphicsAndComputeFamily = i;
         indices.graphicsFamilyHasValue = true;
       }
-      VkBool32 presentSupport = false;
-      vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
-      if (queueFamily.queueCount > 0 && presentSupport)
+      // a compute family without graphics runs asynchronously from the graphics queue
+      if (!indices.computeFamilyHasValue && queueFamily.queueCount > 0 && (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) &&
+          !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT))
       {
-        indices.presentFamily = i;
-        indices.presentFamilyHasValue = true;
+        indices.computeFamily = i;
+        indices.computeFamilyHasValue = true;
       }
-      if (indices.isComplete())
+      // headless : the fake present runs on the graphics queue
+      VkBool32 presentSupport =
+          headless && indices.graphicsFamilyHasValue && indices.graphicsAndComputeFamily == static_cast<uint32_t>(i);
+      if (!headless)
       {
-        break;
+        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
+      }
+      if (!indices.presentFamilyHasValue && queueFamily.queueCount > 0 && presentSupport)
+      {
+        indices.presentFamily = i;
+        indices.presentFamilyHasValue = true;
       }
 
       i++;
     }
 
+    // single queue fallback (lavapipe, some integrated GPUs)
+    if (!indices.computeFamilyHasValue && indices.graphicsFamilyHasValue)
+    {
+      indices.computeFamily = indices.graphicsAndComputeFamily;
+      indices.computeFamilyHasValue = true;
+    }
+
     return indices;
   }
 
@@ -465,6 +768,80 @@ namespace lve
     throw std::runtime_error("failed to find supported format!");
   }
 
+  bool LveDevice::supportsSampledFormat(VkFormat format)
+  {
+    if (format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK && !textureCompressionBCEnabled)
+    {
+      return false;
+    }
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &props);
+    return (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+  }
+
+  bool LveDevice::SamplerKey::operator==(const SamplerKey &other) const
+  {
+    return memcmp(this, &other, sizeof(SamplerKey)) == 0;
+  }
+
+  size_t LveDevice::SamplerKeyHash::operator()(const SamplerKey &key) const
+  {
+    // FNV-1a over the fields
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&key);
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < sizeof(SamplerKey); i++)
+    {
+      hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return static_cast<size_t>(hash);
+  }
+
+  VkSampler LveDevice::getSampler(const VkSamplerCreateInfo &samplerInfo)
+  {
+    static_assert(sizeof(SamplerKey) == 16 * 4, "SamplerKey must not contain padding");
+    // the key only holds the base structure, a chained one would be dropped or mixed up with another
+    if (samplerInfo.pNext != nullptr)
+    {
+      throw std::runtime_error("sampler create info chains can't be cached!");
+    }
+
+    SamplerKey key{samplerInfo.flags,
+                   samplerInfo.magFilter,
+                   samplerInfo.minFilter,
+                   samplerInfo.mipmapMode,
+                   samplerInfo.addressModeU,
+                   samplerInfo.addressModeV,
+                   samplerInfo.addressModeW,
+                   samplerInfo.mipLodBias,
+                   samplerInfo.anisotropyEnable,
+                   samplerInfo.maxAnisotropy,
+                   samplerInfo.compareEnable,
+                   samplerInfo.compareOp,
+                   samplerInfo.minLod,
+                   samplerInfo.maxLod,
+                   samplerInfo.borderColor,
+                   samplerInfo.unnormalizedCoordinates};
+
+    std::lock_guard<std::mutex> lock{samplerMutex};
+    auto found = samplers.find(key);
+    if (found != samplers.end())
+    {
+      return found->second;
+    }
+
+    if (samplers.size() >= properties.limits.maxSamplerAllocationCount)
+    {
+      throw std::runtime_error("too many distinct samplers, maxSamplerAllocationCount reached!");
+    }
+    VkSampler sampler;
+    if (vkCreateSampler(device_, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+    {
+      throw std::runtime_error("failed to create sampler!");
+    }
+    samplers.emplace(key, sampler);
+    return sampler;
+  }
+
   uint32_t LveDevice::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
   {
     VkPhysicalDeviceMemoryProperties memProperties;
@@ -515,16 +892,55 @@ namespace lve
     vkBindBufferMemory(device_, buffer, bufferMemory, 0);
   }
 
-  VkCommandBuffer LveDevice::beginSingleTimeCommands()
+  void LveDevice::createBuffer(
+      VkDeviceSize size,
+      VkBufferUsageFlags usage,
+      VkMemoryPropertyFlags properties,
+      VkBuffer &buffer,
+      LveAllocation &bufferAllocation,
+      LveMemoryCategory category)
   {
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = commandPool;
-    allocInfo.commandBufferCount = 1;
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device_, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+    {
+      throw std::runtime_error("failed to create vertex buffer!");
+    }
 
-    VkCommandBuffer commandBuffer;
-    vkAllocateCommandBuffers(device_, &allocInfo, &commandBuffer);
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(device_, buffer, &memRequirements);
+
+    bufferAllocation = allocator->allocate(memRequirements, properties, false, category);
+
+    if (vkBindBufferMemory(device_, buffer, bufferAllocation.memory, bufferAllocation.offset) != VK_SUCCESS)
+    {
+      throw std::runtime_error("failed to bind buffer memory!");
+    }
+  }
+
+  VkCommandBuffer LveDevice::beginSingleTimeCommands()
+  {
+    if (nextSingleTimeCommandBuffer == singleTimeCommandBuffers.size())
+    {
+      VkCommandBufferAllocateInfo allocInfo{};
+      allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+      allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+      allocInfo.commandPool = singleTimeCommandPool;
+      allocInfo.commandBufferCount = 1;
+
+      VkCommandBuffer commandBuffer;
+      if (vkAllocateCommandBuffers(device_, &allocInfo, &commandBuffer) != VK_SUCCESS)
+      {
+        throw std::runtime_error("failed to allocate single time command buffer!");
+      }
+      singleTimeCommandBuffers.push_back(commandBuffer);
+    }
+    VkCommandBuffer commandBuffer = singleTimeCommandBuffers[nextSingleTimeCommandBuffer++];
+    singleTimeCommandsInUse++;
 
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -543,10 +959,22 @@ namespace lve
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffer;
 
-    vkQueueSubmit(graphicsQueue_, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphicsQueue_);
+    // wait on this submission only, not on whatever else is queued (frames, upload batches)
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence;
+    vkCreateFence(device_, &fenceInfo, nullptr, &fence);
+
+    vkQueueSubmit(graphicsQueue_, 1, &submitInfo, fence);
+    vkWaitForFences(device_, 1, &fence, VK_TRUE, UINT64_MAX);
+    vkDestroyFence(device_, fence, nullptr);
 
-    vkFreeCommandBuffers(device_, commandPool, 1, &commandBuffer);
+    // the buffers stay allocated, the next one-shot reuses them after a single pool reset
+    if (--singleTimeCommandsInUse == 0)
+    {
+      vkResetCommandPool(device_, singleTimeCommandPool, 0);
+      nextSingleTimeCommandBuffer = 0;
+    }
   }
 
   void LveDevice::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
@@ -648,4 +1076,28 @@ namespace lve
     }
   }
 
+  void LveDevice::createImageWithInfo(
+      const VkImageCreateInfo &imageInfo,
+      VkMemoryPropertyFlags properties,
+      VkImage &image,
+      LveAllocation &imageAllocation,
+      LveMemoryCategory category)
+  {
+    if (vkCreateImage(device_, &imageInfo, nullptr, &image) != VK_SUCCESS)
+    {
+      throw std::runtime_error("failed to create image!");
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(device_, image, &memRequirements);
+
+    imageAllocation =
+        allocator->allocate(memRequirements, properties, imageInfo.tiling == VK_IMAGE_TILING_OPTIMAL, category);
+
+    if (vkBindImageMemory(device_, image, imageAllocation.memory, imageAllocation.offset) != VK_SUCCESS)
+    {
+      throw std::runtime_error("failed to bind image memory!");
+    }
+  }
+
 } // namespace lve
\ No newline at end of file
@@ -1,13 +1,23 @@
 #pragma once
 
+#include "lve_allocator.hpp"
+#include "lve_deletion_queue.hpp"
 #include "lve_window.hpp"
 
 // std lib headers
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace lve {
 
+class LveAssetCache;
+class LveBindlessTable;
+class LveTextureCache;
+class LveUploadBatcher;
+
 struct SwapChainSupportDetails {
     VkSurfaceCapabilitiesKHR capabilities;
     std::vector<VkSurfaceFormatKHR> formats;
@@ -18,9 +28,13 @@ struct QueueFamilyIndices {
     // uint32_t graphicsFamily;
     uint32_t graphicsAndComputeFamily;
     uint32_t presentFamily;
+    // compute only family when the device has one, graphicsAndComputeFamily otherwise
+    uint32_t computeFamily;
     bool graphicsFamilyHasValue = false;
     bool presentFamilyHasValue = false;
+    bool computeFamilyHasValue = false;
     bool isComplete() { return graphicsFamilyHasValue && presentFamilyHasValue; }
+    bool hasDedicatedCompute() const { return computeFamilyHasValue && computeFamily != graphicsAndComputeFamily; }
 };
 
 class LveDevice {
@@ -41,22 +55,67 @@ class LveDevice {
     LveDevice &operator=(LveDevice &&) = delete;
 
     VkCommandPool getCommandPool() { return commandPool; }
+    // Pool of the compute queue family, the graphics pool when there is no dedicated compute queue
+    VkCommandPool getComputeCommandPool() { return computeCommandPool; }
     VkDevice device() { return device_; }
     VkSurfaceKHR surface() { return surface_; }
     VkQueue graphicsQueue() { return graphicsQueue_; }
     VkQueue presentQueue() { return presentQueue_; }
+    VkQueue computeQueue() { return computeQueue_; }
+    bool hasDedicatedComputeQueue() const { return queueFamilies.hasDedicatedCompute(); }
+    // No surface nor VK_KHR_swapchain, see LveWindow
+    bool isHeadless() const { return headless; }
+
+    // Engine wide cache given to every vkCreate*Pipelines, persisted in PIPELINE_CACHE_PATH
+    VkPipelineCache pipelineCache() { return pipelineCache_; }
+    // Also called at destruction, can be called earlier so a crash doesn't lose the compiled pipelines
+    void savePipelineCache();
+    // True when a valid cache for this device and driver was loaded from disk
+    bool isPipelineCacheWarm() const { return pipelineCacheWarm; }
+    // Time spent in vkCreate*Pipelines, to compare cold and warm startups
+    void recordPipelineCreation(double seconds) {
+        pipelineCreationSeconds += seconds;
+        pipelineCreationCount++;
+    }
+    double getPipelineCreationSeconds() const { return pipelineCreationSeconds; }
+    uint32_t getPipelineCreationCount() const { return pipelineCreationCount; }
 
     SwapChainSupportDetails getSwapChainSupport() { return querySwapChainSupport(physicalDevice); }
     uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
     QueueFamilyIndices findPhysicalQueueFamilies() { return findQueueFamilies(physicalDevice); }
+    // Families the logical device was created with
+    const QueueFamilyIndices &getQueueFamilies() const { return queueFamilies; }
     VkFormat findSupportedFormat(const std::vector<VkFormat> &candidates, VkImageTiling tiling,
                                  VkFormatFeatureFlags features);
+    // Samplers are shared : identical create infos return the same sampler, which lives as long as the device and must
+    // not be destroyed by the caller. Create infos with a pNext chain are rejected (std::runtime_error)
+    VkSampler getSampler(const VkSamplerCreateInfo &samplerInfo);
+    size_t getSamplerCount() const { return samplers.size(); }
+
+    // Optimal tiling images of this format can be sampled, block compressed formats also need their feature enabled
+    bool supportsSampledFormat(VkFormat format);
+    bool isTextureCompressionBCEnabled() const { return textureCompressionBCEnabled; }
 
     VkPhysicalDevice getPhysicalDevice() { return physicalDevice; }
+    LveAllocator &getAllocator() { return *allocator; }
+    LveUploadBatcher &getUploadBatcher() { return *uploadBatcher; }
+    // Decoded images of the previous runs, see LveTextureCache
+    LveTextureCache &getTextureCache() { return *textureCache; }
+    // Textures and models shared by everything that loads them, see LveAssetCache
+    LveAssetCache &getAssetCache() { return *assetCache; }
+    // Every sampled texture in one descriptor set, see LveBindlessTable
+    LveBindlessTable &getBindlessTable() { return *bindlessTable; }
+    // Destroys objects once the frames that may use them have completed, see LveDeletionQueue
+    LveDeletionQueue &getDeletionQueue() { return *deletionQueue; }
+    // Per category usage and heap budgets, from VK_EXT_memory_budget when the device supports it
+    LveMemorySnapshot getMemorySnapshot() const { return allocator->getMemorySnapshot(); }
+    void printMemoryReport(std::ostream &out) const { allocator->printMemoryReport(out); }
 
     // Buffer Helper Functions
     void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer,
                       VkDeviceMemory &bufferMemory);
+    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer,
+                      LveAllocation &bufferAllocation, LveMemoryCategory category = LveMemoryCategory::General);
     VkCommandBuffer beginSingleTimeCommands();
     void endSingleTimeCommands(VkCommandBuffer commandBuffer);
     void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
@@ -64,6 +123,9 @@ class LveDevice {
 
     void createImageWithInfo(const VkImageCreateInfo &imageInfo, VkMemoryPropertyFlags properties, VkImage &image,
                              VkDeviceMemory &imageMemory);
+    void createImageWithInfo(const VkImageCreateInfo &imageInfo, VkMemoryPropertyFlags properties, VkImage &image,
+                             LveAllocation &imageAllocation,
+                             LveMemoryCategory category = LveMemoryCategory::General);
 
     VkPhysicalDeviceProperties properties;
 
@@ -71,12 +133,39 @@ class LveDevice {
                            VkImageLayout imageLayout);
 
    private:
+    // Every field of VkSamplerCreateInfo but sType and pNext, all 32 bits : compared and hashed as bytes
+    struct SamplerKey {
+        VkSamplerCreateFlags flags;
+        VkFilter magFilter;
+        VkFilter minFilter;
+        VkSamplerMipmapMode mipmapMode;
+        VkSamplerAddressMode addressModeU;
+        VkSamplerAddressMode addressModeV;
+        VkSamplerAddressMode addressModeW;
+        float mipLodBias;
+        VkBool32 anisotropyEnable;
+        float maxAnisotropy;
+        VkBool32 compareEnable;
+        VkCompareOp compareOp;
+        float minLod;
+        float maxLod;
+        VkBorderColor borderColor;
+        VkBool32 unnormalizedCoordinates;
+
+        bool operator==(const SamplerKey &other) const;
+    };
+    struct SamplerKeyHash {
+        size_t operator()(const SamplerKey &key) const;
+    };
+
     void createInstance();
     void setupDebugMessenger();
     void createSurface();
     void pickPhysicalDevice();
     void createLogicalDevice();
     void createCommandPool();
+    void createPipelineCache();
+    bool isPipelineCacheCompatible(const std::vector<char> &data);
 
     // helper functions
     bool isDeviceSuitable(VkPhysicalDevice device);
@@ -86,21 +175,52 @@ class LveDevice {
     void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
     void hasGflwRequiredInstanceExtensions();
     bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+    bool isDeviceExtensionSupported(VkPhysicalDevice device, const char *extensionName);
+    // descriptor indexing features and limits needed by LveBindlessTable
+    bool supportsBindlessTextures(VkPhysicalDevice device);
+    // deviceExtensions minus the ones headless mode doesn't need
+    std::vector<const char *> getDeviceExtensions();
     SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device);
 
     VkInstance instance;
     VkDebugUtilsMessengerEXT debugMessenger;
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
     LveWindow &window;
+    bool headless;
     VkCommandPool commandPool;
+    VkCommandPool computeCommandPool;
+    // one-shot command buffers are recycled : the pool is reset once none of them is being recorded
+    VkCommandPool singleTimeCommandPool;
+    std::vector<VkCommandBuffer> singleTimeCommandBuffers;
+    uint32_t nextSingleTimeCommandBuffer = 0;
+    uint32_t singleTimeCommandsInUse = 0;
+    QueueFamilyIndices queueFamilies;
+    std::unique_ptr<LveAllocator> allocator;
+    std::unique_ptr<LveDeletionQueue> deletionQueue;
+    std::unique_ptr<LveUploadBatcher> uploadBatcher;
+    std::unique_ptr<LveTextureCache> textureCache;
+    std::unique_ptr<LveAssetCache> assetCache;
+    std::unique_ptr<LveBindlessTable> bindlessTable;
+    bool memoryBudgetEnabled = false;
+    bool textureCompressionBCEnabled = false;
+    VkPipelineCache pipelineCache_ = VK_NULL_HANDLE;
+    std::mutex samplerMutex;
+    std::unordered_map<SamplerKey, VkSampler, SamplerKeyHash> samplers;
+    bool pipelineCacheWarm = false;
+    double pipelineCreationSeconds = 0.0;
+    uint32_t pipelineCreationCount = 0;
 
     VkDevice device_;
     VkSurfaceKHR surface_;
     VkQueue graphicsQueue_;
     VkQueue presentQueue_;
+    VkQueue computeQueue_;
 
     const std::vector<const char *> validationLayers = {"VK_LAYER_KHRONOS_validation"};
-    const std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+    const std::vector<const char *> deviceExtensions = {
+        VK_KHR_SWAPCHAIN_EXTENSION_NAME, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME,
+        VK_KHR_MAINTENANCE3_EXTENSION_NAME,  // required by VK_EXT_descriptor_indexing on 1.0
+        VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME};
 };
 
 }  // namespace lve
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "lve_file_mapping.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lve {
+
+#ifdef _WIN32
+
+std::unique_ptr<LveFileMapping> LveFileMapping::map(const std::string &filepath) {
+    HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return nullptr;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void *address = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (address == nullptr) {
+        if (mapping != nullptr) CloseHandle(mapping);
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    std::unique_ptr<LveFileMapping> fileMapping{new LveFileMapping()};
+    fileMapping->address = address;
+    fileMapping->length = static_cast<size_t>(fileSize.QuadPart);
+    fileMapping->fileHandle = file;
+    fileMapping->mappingHandle = mapping;
+    return fileMapping;
+}
+
+LveFileMapping::~LveFileMapping() {
+    UnmapViewOfFile(address);
+    CloseHandle(mappingHandle);
+    CloseHandle(fileHandle);
+}
+
+#else
+
+std::unique_ptr<LveFileMapping> LveFileMapping::map(const std::string &filepath) {
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+        close(fd);
+        return nullptr;
+    }
+    void *address = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps the file referenced
+    close(fd);
+    if (address == MAP_FAILED) return nullptr;
+
+    std::unique_ptr<LveFileMapping> fileMapping{new LveFileMapping()};
+    fileMapping->address = address;
+    fileMapping->length = static_cast<size_t>(fileStat.st_size);
+    return fileMapping;
+}
+
+LveFileMapping::~LveFileMapping() { munmap(address, length); }
+
+#endif
+
+}  // namespace lve
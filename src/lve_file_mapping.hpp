@@ -0,0 +1,38 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace lve {
+
+/*
+ * Read only memory mapping of a whole file. Pages are brought in by the OS on first access, so reading a cached
+ * asset costs a page fault per touched page instead of a read into a heap copy.
+ */
+class LveFileMapping {
+   public:
+    // nullptr when the file can't be opened or is empty
+    static std::unique_ptr<LveFileMapping> map(const std::string &filepath);
+    ~LveFileMapping();
+
+    LveFileMapping(const LveFileMapping &) = delete;
+    LveFileMapping &operator=(const LveFileMapping &) = delete;
+
+    const uint8_t *data() const { return static_cast<const uint8_t *>(address); }
+    size_t size() const { return length; }
+
+   private:
+    LveFileMapping() = default;
+
+    void *address = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+};
+
+}  // namespace lve
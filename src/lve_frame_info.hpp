@@ -3,7 +3,12 @@
 
 #include <glm/fwd.hpp>
 
+// std
+#include <array>
+#include <cstdint>
+
 #include "lve_camera.hpp"
+#include "lve_frame_ring.hpp"
 #include "lve_game_object.hpp"
 
 namespace lve {
@@ -23,6 +28,8 @@ struct GlobalUbo {
     glm::vec4 ambientLightColor{1.f, 1.f, 1.f, .02f};  // w is intensity
     PointLight pointLights[MAX_LIGHTS];
     int numLights;
+    // angle covered by one pixel at the center of the view, from the projection and the viewport height
+    float pixelAngle = .0015f;
 };
 
 struct FrameInfo {
@@ -34,7 +41,13 @@ struct FrameInfo {
     VkCommandBuffer postProcessingCommandBuffer;
     LveCamera &camera;
     VkDescriptorSet globalDescriptorSet;
+    // dynamic offsets of the global set : this frame's GlobalUbo inside the frame ring (binding 0) and its
+    // instance of the object buffer (binding 1)
+    std::array<uint32_t, 2> globalDynamicOffsets;
     LveGameObject::Map &gameObjects;
+    LveFrameRing &frameRing;
+    // size of the rendered image, the render systems project the LOD errors to its pixels
+    VkExtent2D viewportExtent;
 };
 
 }  // namespace lve
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "lve_frame_ring.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace lve {
+
+// every alignment handed to the ring is a power of two (Vulkan limits and our constants)
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+LveFrameRing::LveFrameRing(LveDevice &device, uint32_t frameCount, VkDeviceSize regionSize)
+    : frameCount{frameCount} {
+    const VkPhysicalDeviceLimits &limits = device.properties.limits;
+    uniformAlignment = std::max<VkDeviceSize>(limits.minUniformBufferOffsetAlignment, 16);
+    storageAlignment = std::max<VkDeviceSize>(limits.minStorageBufferOffsetAlignment, 16);
+    // 16 covers the texel size of every format we upload and the 4 bytes rule of vkCmdCopyBufferToImage
+    stagingAlignment = std::max<VkDeviceSize>(limits.optimalBufferCopyOffsetAlignment, 16);
+
+    // keep every region start aligned for any kind of range
+    VkDeviceSize regionAlignment = std::max({uniformAlignment, storageAlignment, stagingAlignment});
+    this->regionSize = alignUp(regionSize, regionAlignment);
+
+    ringBuffer = std::make_unique<LveBuffer>(
+        device, this->regionSize, frameCount,
+        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 1, LveMemoryCategory::FrameRing);
+    if (ringBuffer->map() != VK_SUCCESS) {
+        throw std::runtime_error("failed to map frame ring buffer!");
+    }
+    mapped = static_cast<char *>(ringBuffer->getMappedMemory());
+}
+
+void LveFrameRing::beginFrame(int frameIndex) {
+    assert(frameIndex >= 0 && static_cast<uint32_t>(frameIndex) < frameCount && "Frame index out of range");
+    std::lock_guard<std::mutex> lock{mutex};
+    regionBegin = regionSize * frameIndex;
+    head = 0;
+    frameActive = true;
+}
+
+void LveFrameRing::endFrame() {
+    std::lock_guard<std::mutex> lock{mutex};
+    frameActive = false;
+}
+
+bool LveFrameRing::tryAllocate(VkDeviceSize size, VkDeviceSize alignment, LveBufferRange &range) {
+    std::lock_guard<std::mutex> lock{mutex};
+    if (!frameActive) return false;
+
+    VkDeviceSize offset = alignUp(head, alignment);
+    if (offset + size > regionSize) return false;
+    head = offset + size;
+
+    range.buffer = ringBuffer->getBuffer();
+    range.offset = regionBegin + offset;
+    range.size = size;
+    range.mapped = mapped + range.offset;
+    return true;
+}
+
+LveBufferRange LveFrameRing::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+    LveBufferRange range{};
+    if (!tryAllocate(size, alignment, range)) {
+        throw std::runtime_error(frameActive ? "frame ring region exhausted, increase its region size!"
+                                             : "frame ring allocation outside of a frame!");
+    }
+    return range;
+}
+
+}  // namespace lve
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "lve_buffer.hpp"
+#include "lve_device.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace lve {
+
+// A sub-range of a buffer, with its host pointer when the buffer is mapped
+struct LveBufferRange {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    void *mapped = nullptr;
+
+    bool isValid() const { return buffer != VK_NULL_HANDLE; }
+    VkDescriptorBufferInfo descriptorInfo() const { return VkDescriptorBufferInfo{buffer, offset, size}; }
+};
+
+/*
+ * One persistently mapped buffer split in one region per frame in flight. Each frame suballocates
+ * linearly from its own region, and the region is rewound when the frame comes back around, once the
+ * frame scheduler has waited on the previous frame of that slot. Nothing is allocated or mapped after construction.
+ *
+ * Ranges live until the same frame index starts again, so they must only be consumed by work submitted
+ * before the frame is presented.
+ */
+class LveFrameRing {
+   public:
+    static constexpr VkDeviceSize DEFAULT_REGION_SIZE = 4ull * 1024 * 1024;
+
+    LveFrameRing(LveDevice &device, uint32_t frameCount, VkDeviceSize regionSize = DEFAULT_REGION_SIZE);
+
+    LveFrameRing(const LveFrameRing &) = delete;
+    LveFrameRing &operator=(const LveFrameRing &) = delete;
+
+    // Rewinds the frame's region, the caller must have waited on the previous frame that used frameIndex
+    void beginFrame(int frameIndex);
+    // Ranges handed out after endFrame would not be covered by any submit, allocations fail until the next frame
+    void endFrame();
+    bool isFrameActive() const { return frameActive; }
+
+    // Returns false when the current region is exhausted or no frame is in progress
+    bool tryAllocate(VkDeviceSize size, VkDeviceSize alignment, LveBufferRange &range);
+    // Same as tryAllocate but throws on failure
+    LveBufferRange allocate(VkDeviceSize size, VkDeviceSize alignment);
+
+    LveBufferRange allocateUniform(VkDeviceSize size) { return allocate(size, uniformAlignment); }
+    LveBufferRange allocateStorage(VkDeviceSize size) { return allocate(size, storageAlignment); }
+    bool tryAllocateStaging(VkDeviceSize size, LveBufferRange &range) {
+        return tryAllocate(size, stagingAlignment, range);
+    }
+
+    VkBuffer getBuffer() const { return ringBuffer->getBuffer(); }
+    VkDeviceSize getRegionSize() const { return regionSize; }
+    // Bytes handed out in the current region, useful to size DEFAULT_REGION_SIZE
+    VkDeviceSize getUsedBytes() const { return head; }
+
+   private:
+    std::unique_ptr<LveBuffer> ringBuffer;
+    char *mapped = nullptr;
+    uint32_t frameCount;
+    VkDeviceSize regionSize;
+
+    VkDeviceSize uniformAlignment;
+    VkDeviceSize storageAlignment;
+    VkDeviceSize stagingAlignment;
+
+    VkDeviceSize regionBegin = 0;
+    VkDeviceSize head = 0;
+    bool frameActive = false;
+    std::mutex mutex;
+};
+
+}  // namespace lve
@@ -0,0 +1,193 @@
+#include "lve_frame_scheduler.hpp"
+
+// std
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+
+namespace lve {
+
+LveFrameScheduler::LveFrameScheduler(LveDevice &device, uint32_t framesInFlight)
+    : lveDevice{device}, framesInFlight{framesInFlight} {
+    waitSemaphores = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(
+        vkGetDeviceProcAddr(lveDevice.device(), "vkWaitSemaphoresKHR"));
+    signalSemaphore = reinterpret_cast<PFN_vkSignalSemaphoreKHR>(
+        vkGetDeviceProcAddr(lveDevice.device(), "vkSignalSemaphoreKHR"));
+    getSemaphoreCounterValue = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(
+        vkGetDeviceProcAddr(lveDevice.device(), "vkGetSemaphoreCounterValueKHR"));
+    if (waitSemaphores == nullptr || signalSemaphore == nullptr || getSemaphoreCounterValue == nullptr) {
+        throw std::runtime_error("failed to load VK_KHR_timeline_semaphore functions!");
+    }
+
+    for (Stage stage = PRE_PROCESS; stage <= PRESENT; stage++) {
+        addStage();
+    }
+    for (uint32_t i = 0; i < framesInFlight; i++) {
+        acquireSemaphores.push_back(createSemaphore(VK_SEMAPHORE_TYPE_BINARY_KHR));
+        presentSemaphores.push_back(createSemaphore(VK_SEMAPHORE_TYPE_BINARY_KHR));
+    }
+}
+
+LveFrameScheduler::~LveFrameScheduler() {
+    for (VkSemaphore semaphore : timelines) vkDestroySemaphore(lveDevice.device(), semaphore, nullptr);
+    for (VkSemaphore semaphore : acquireSemaphores) vkDestroySemaphore(lveDevice.device(), semaphore, nullptr);
+    for (VkSemaphore semaphore : presentSemaphores) vkDestroySemaphore(lveDevice.device(), semaphore, nullptr);
+}
+
+VkSemaphore LveFrameScheduler::createSemaphore(VkSemaphoreTypeKHR type) {
+    VkSemaphoreTypeCreateInfoKHR typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+    typeInfo.semaphoreType = type;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+
+    VkSemaphore semaphore;
+    if (vkCreateSemaphore(lveDevice.device(), &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create frame scheduler semaphore!");
+    }
+    return semaphore;
+}
+
+LveFrameScheduler::Stage LveFrameScheduler::addStage() {
+    assert(frameNumber == 0 && "Stages must be added before the first frame");
+    timelines.push_back(createSemaphore(VK_SEMAPHORE_TYPE_TIMELINE_KHR));
+    pending.emplace_back();
+    return static_cast<Stage>(timelines.size() - 1);
+}
+
+uint64_t LveFrameScheduler::beginFrame() {
+    frameNumber++;
+    if (frameNumber > framesInFlight) {
+        waitForFrame(frameNumber - framesInFlight);
+    }
+    return frameNumber;
+}
+
+void LveFrameScheduler::cancelFrame() {
+    // a host signal must never overtake a pending GPU signal, once the previous frame is presented none is left
+    waitForFrame(frameNumber - 1);
+    for (Stage stage = 0; stage < timelines.size(); stage++) {
+        pending[stage] = PendingSubmit{};
+
+        VkSemaphoreSignalInfoKHR signalInfo{};
+        signalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO_KHR;
+        signalInfo.semaphore = timelines[stage];
+        signalInfo.value = frameNumber;
+        if (signalSemaphore(lveDevice.device(), &signalInfo) != VK_SUCCESS) {
+            throw std::runtime_error("failed to signal frame timeline!");
+        }
+    }
+}
+
+void LveFrameScheduler::addDependency(Stage stage, Stage dependency, VkPipelineStageFlags waitStage) {
+    PendingSubmit &submit = pending[stage];
+    submit.waitSemaphores.push_back(timelines[dependency]);
+    submit.waitValues.push_back(frameNumber);
+    submit.waitStages.push_back(waitStage);
+}
+
+void LveFrameScheduler::addBinaryWait(Stage stage, VkSemaphore semaphore, VkPipelineStageFlags waitStage) {
+    PendingSubmit &submit = pending[stage];
+    submit.waitSemaphores.push_back(semaphore);
+    submit.waitValues.push_back(0);  // ignored for binary semaphores
+    submit.waitStages.push_back(waitStage);
+}
+
+void LveFrameScheduler::addTimelineWait(Stage stage, VkSemaphore semaphore, uint64_t value,
+                                        VkPipelineStageFlags waitStage) {
+    PendingSubmit &submit = pending[stage];
+    submit.waitSemaphores.push_back(semaphore);
+    submit.waitValues.push_back(value);
+    submit.waitStages.push_back(waitStage);
+}
+
+void LveFrameScheduler::signalPresentReady(Stage stage) { pending[stage].signalsPresent = true; }
+
+void LveFrameScheduler::submit(Stage stage, VkQueue queue, const VkCommandBuffer *commandBuffers,
+                               uint32_t commandBufferCount) {
+    PendingSubmit &submit = pending[stage];
+
+    VkSemaphore signalSemaphores[] = {timelines[stage], presentSemaphores[getFrameSlot()]};
+    uint64_t signalValues[] = {frameNumber, 0};
+    uint32_t signalCount = submit.signalsPresent ? 2 : 1;
+
+    VkTimelineSemaphoreSubmitInfoKHR timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+    timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(submit.waitValues.size());
+    timelineInfo.pWaitSemaphoreValues = submit.waitValues.data();
+    timelineInfo.signalSemaphoreValueCount = signalCount;
+    timelineInfo.pSignalSemaphoreValues = signalValues;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.waitSemaphoreCount = static_cast<uint32_t>(submit.waitSemaphores.size());
+    submitInfo.pWaitSemaphores = submit.waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = submit.waitStages.data();
+    submitInfo.commandBufferCount = commandBufferCount;
+    submitInfo.pCommandBuffers = commandBuffers;
+    submitInfo.signalSemaphoreCount = signalCount;
+    submitInfo.pSignalSemaphores = signalSemaphores;
+
+    if (vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit frame stage!");
+    }
+
+    // clear keeps the capacity, no allocation once the first frames went through
+    submit.waitSemaphores.clear();
+    submit.waitValues.clear();
+    submit.waitStages.clear();
+    submit.signalsPresent = false;
+}
+
+VkResult LveFrameScheduler::present(VkQueue queue, VkSwapchainKHR swapChain, uint32_t imageIndex) {
+    assert(pending[PRESENT].waitSemaphores.empty() && "Present can only wait on the present ready semaphore");
+
+    VkSemaphore presentSemaphore = presentSemaphores[getFrameSlot()];
+    VkPresentInfoKHR presentInfo = {};
+    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = &presentSemaphore;
+    presentInfo.swapchainCount = 1;
+    presentInfo.pSwapchains = &swapChain;
+    presentInfo.pImageIndices = &imageIndex;
+
+    // the wait is performed even when the swap chain is out of date
+    VkResult result = vkQueuePresentKHR(queue, &presentInfo);
+
+    // vkQueuePresentKHR can't signal a timeline : an empty submit behind it on the same queue does it. A present is
+    // not a command, nothing orders that submit after the frame's work when the present queue isn't the graphics
+    // one, so it waits on the last stages itself : PRESENT reaching the frame number must mean the slot is retired
+    addDependency(PRESENT, GRAPHICS, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+    addDependency(PRESENT, POST_PROCESS, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+    submit(PRESENT, queue, nullptr, 0);
+    return result;
+}
+
+void LveFrameScheduler::presentOffscreen(VkQueue queue) {
+    assert(pending[PRESENT].waitSemaphores.empty() && "Present can only wait on the present ready semaphore");
+
+    // the binary semaphore has to be waited on before it is signaled again by the same frame slot
+    addBinaryWait(PRESENT, presentSemaphores[getFrameSlot()], VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+    submit(PRESENT, queue, nullptr, 0);
+}
+
+uint64_t LveFrameScheduler::getCompletedValue(Stage stage) const {
+    uint64_t value = 0;
+    getSemaphoreCounterValue(lveDevice.device(), timelines[stage], &value);
+    return value;
+}
+
+void LveFrameScheduler::waitFor(Stage stage, uint64_t value) const {
+    VkSemaphoreWaitInfoKHR waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &timelines[stage];
+    waitInfo.pValues = &value;
+    waitSemaphores(lveDevice.device(), &waitInfo, std::numeric_limits<uint64_t>::max());
+}
+
+}  // namespace lve
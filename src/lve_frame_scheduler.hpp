@@ -0,0 +1,92 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+/*
+ * Frame synchronisation built on VK_KHR_timeline_semaphore. Every stage of a frame (pre processing, graphics,
+ * post processing, present) owns one timeline semaphore and signals it to the frame number when its work is
+ * done, so "frame N finished stage X" is simply "timeline X reached N" and can be waited on from the CPU or
+ * from any queue.
+ *
+ * Binary semaphores are only kept where the WSI requires them : the acquire and the present.
+ */
+class LveFrameScheduler {
+   public:
+    using Stage = uint32_t;
+    static constexpr Stage PRE_PROCESS = 0;
+    static constexpr Stage GRAPHICS = 1;
+    static constexpr Stage POST_PROCESS = 2;
+    static constexpr Stage PRESENT = 3;
+
+    LveFrameScheduler(LveDevice &device, uint32_t framesInFlight);
+    ~LveFrameScheduler();
+
+    LveFrameScheduler(const LveFrameScheduler &) = delete;
+    LveFrameScheduler &operator=(const LveFrameScheduler &) = delete;
+
+    // Adds a stage with its own timeline, chained like the built in ones with addDependency
+    Stage addStage();
+
+    // Starts the next frame, blocks until the frame that last used the same slot has been presented
+    uint64_t beginFrame();
+    // For a frame abandoned before any submit (out of date swap chain), advances every timeline from the host
+    void cancelFrame();
+    uint64_t getFrameNumber() const { return frameNumber; }
+    int getFrameSlot() const { return static_cast<int>((frameNumber - 1) % framesInFlight); }
+
+    // Binary semaphore to give to vkAcquireNextImageKHR for the current frame
+    VkSemaphore getAcquireSemaphore() const { return acquireSemaphores[getFrameSlot()]; }
+
+    // The next submit of stage waits until dependency has finished the current frame, so dependency must submit too
+    void addDependency(Stage stage, Stage dependency, VkPipelineStageFlags waitStage);
+    void addBinaryWait(Stage stage, VkSemaphore semaphore, VkPipelineStageFlags waitStage);
+    // The next submit of stage waits until a timeline semaphore from outside the scheduler reaches value
+    void addTimelineWait(Stage stage, VkSemaphore semaphore, uint64_t value, VkPipelineStageFlags waitStage);
+    // The next submit of stage also signals the binary semaphore waited on by present
+    void signalPresentReady(Stage stage);
+
+    // Submits with the pending waits of the stage and signals its timeline to the current frame number
+    void submit(Stage stage, VkQueue queue, const VkCommandBuffer *commandBuffers, uint32_t commandBufferCount);
+    // Presents, then signals the PRESENT timeline on the present queue once the present has consumed its wait and the
+    // GRAPHICS and POST_PROCESS submits of the frame have completed
+    VkResult present(VkQueue queue, VkSwapchainKHR swapChain, uint32_t imageIndex);
+    // Stand in for present without a swap chain : consumes the present ready semaphore and signals PRESENT
+    void presentOffscreen(VkQueue queue);
+
+    uint64_t getCompletedValue(Stage stage) const;
+    bool hasReached(Stage stage, uint64_t value) const { return getCompletedValue(stage) >= value; }
+    void waitFor(Stage stage, uint64_t value) const;
+    // A frame is retired once presented, every stage it used is then complete
+    void waitForFrame(uint64_t frame) const { waitFor(PRESENT, frame); }
+
+   private:
+    struct PendingSubmit {
+        std::vector<VkSemaphore> waitSemaphores;
+        std::vector<uint64_t> waitValues;
+        std::vector<VkPipelineStageFlags> waitStages;
+        bool signalsPresent = false;
+    };
+
+    VkSemaphore createSemaphore(VkSemaphoreTypeKHR type);
+
+    LveDevice &lveDevice;
+    uint32_t framesInFlight;
+    uint64_t frameNumber = 0;
+
+    std::vector<VkSemaphore> timelines;
+    std::vector<PendingSubmit> pending;
+    std::vector<VkSemaphore> acquireSemaphores;
+    std::vector<VkSemaphore> presentSemaphores;
+
+    PFN_vkWaitSemaphoresKHR waitSemaphores = nullptr;
+    PFN_vkSignalSemaphoreKHR signalSemaphore = nullptr;
+    PFN_vkGetSemaphoreCounterValueKHR getSemaphoreCounterValue = nullptr;
+};
+
+}  // namespace lve
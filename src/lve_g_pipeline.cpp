@@ -5,6 +5,7 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
@@ -23,9 +24,9 @@ LveGPipeline::LveGPipeline(LveDevice &device, const std::string &vertFilepath, c
 }
 
 LveGPipeline::~LveGPipeline() {
-    vkDestroyShaderModule(lveDevice.device(), vertShaderModule, nullptr);
-    vkDestroyShaderModule(lveDevice.device(), fragShaderModule, nullptr);
-    vkDestroyPipeline(lveDevice.device(), graphicsPipeLine, nullptr);
+    lveDevice.getDeletionQueue().destroyShaderModule(vertShaderModule);
+    lveDevice.getDeletionQueue().destroyShaderModule(fragShaderModule);
+    lveDevice.getDeletionQueue().destroyPipeline(graphicsPipeLine);
 }
 
 std::vector<char> LveGPipeline::readFile(const std::string &filepath) {
@@ -105,10 +106,13 @@ void LveGPipeline::creatGraphicsPipeline(const std::string &vertFilepath, const
     pipelineInfo.basePipelineIndex = -1;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(lveDevice.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeLine) !=
-        VK_SUCCESS) {
+    auto start = std::chrono::high_resolution_clock::now();
+    if (vkCreateGraphicsPipelines(lveDevice.device(), lveDevice.pipelineCache(), 1, &pipelineInfo, nullptr,
+                                  &graphicsPipeLine) != VK_SUCCESS) {
         throw std::runtime_error("failed to create graphic pipeline");
     }
+    lveDevice.recordPipelineCreation(
+        std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count());
 }
 
 void LveGPipeline::createShaderModule(const std::vector<char> &code, VkShaderModule *shaderModule) {
@@ -52,12 +52,12 @@ class LveGameObject {
     std::shared_ptr<LveModel> model{};
     std::shared_ptr<LveTexture> texture{};
 
-    std::unique_ptr<LveDescriptorPool> texturePool;
-    VkDescriptorSet textureDescriptorSet;
-
     std::unique_ptr<PoinLightComponent> pointLight = nullptr;
     std::unique_ptr<Water> water = nullptr;
 
+    // entry of this object in the frame's object buffer, set by LveObjectBuffer::update
+    uint32_t objectIndex = 0;
+
    private:
     LveGameObject(id_t objId) : id{objId} {}
     id_t id;
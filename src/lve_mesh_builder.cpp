@@ -0,0 +1,308 @@
+#include "lve_mesh_builder.hpp"
+
+#include "lve_utils.hpp"
+
+// libs
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace std {
+template <>
+struct hash<lve::LveVertex> {
+    size_t operator()(lve::LveVertex const &vertex) const {
+        size_t seed = 0;
+        lve::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
+        return seed;
+    }
+};
+}  // namespace std
+
+namespace lve {
+
+namespace {
+
+constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+// below this many face corners per thread, starting the thread costs more than it saves
+constexpr size_t MIN_CORNERS_PER_THREAD = 32 * 1024;
+// the overdraw order is dropped when it raises the ACMR of the cache order by more than this
+constexpr float MAX_OVERDRAW_ACMR_COST = 1.1f;
+constexpr size_t MAX_LOD_COUNT = 6;
+// under this many triangles the draw call costs more than the vertices a LOD saves
+constexpr uint32_t MIN_LOD_TRIANGLES = 64;
+// a LOD keeping more than this fraction of the previous one's triangles is not worth its memory, the rest of the mesh
+// is held by seams and borders
+constexpr float MAX_LOD_INDEX_RATIO = 0.8f;
+
+void parseObj(const std::string &filepath, tinyobj::attrib_t &attrib, std::vector<tinyobj::shape_t> &shapes) {
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath.c_str())) {
+        throw std::runtime_error(warn + err);
+    }
+}
+
+LveVertex makeVertex(const tinyobj::attrib_t &attrib, const tinyobj::index_t &index) {
+    LveVertex vertex{};
+
+    if (index.vertex_index >= 0) {
+        vertex.position = {
+            attrib.vertices[3 * index.vertex_index + 0],
+            attrib.vertices[3 * index.vertex_index + 1],
+            attrib.vertices[3 * index.vertex_index + 2],
+        };
+
+        vertex.color = {
+            attrib.colors[3 * index.vertex_index + 0],
+            attrib.colors[3 * index.vertex_index + 1],
+            attrib.colors[3 * index.vertex_index + 2],
+        };
+    }
+
+    if (index.normal_index >= 0) {
+        vertex.normal = {
+            attrib.normals[3 * index.normal_index + 0],
+            attrib.normals[3 * index.normal_index + 1],
+            attrib.normals[3 * index.normal_index + 2],
+        };
+    }
+
+    if (index.texcoord_index >= 0) {
+        vertex.uv = {
+            attrib.texcoords[2 * index.texcoord_index + 0],
+            attrib.texcoords[2 * index.texcoord_index + 1],
+        };
+    }
+    return vertex;
+}
+
+// Hash of the raw vertex words, much cheaper than combining std::hash of each glm component
+uint64_t hashVertex(const LveVertex &vertex) {
+    static_assert(sizeof(LveVertex) % sizeof(uint32_t) == 0, "LveVertex must be made of 32 bits words");
+    uint32_t words[sizeof(LveVertex) / sizeof(uint32_t)];
+    memcpy(words, &vertex, sizeof(LveVertex));
+
+    uint64_t hash = 0;
+    for (uint32_t word : words) {
+        // -0.f == 0.f for operator==, both must land on the same slot
+        if (word == 0x80000000u) word = 0;
+        hash = (hash ^ word) * 0x100000001b3ull;
+    }
+    // the slot comes from the low bits, fold the high ones into them (murmur3 finalizer)
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// Open addressing set of vertex indices with linear probing, sized once for its worst case and kept at most half
+// full. The vertices themselves stay in the caller's vector
+class VertexTable {
+   public:
+    explicit VertexTable(size_t maxVertices) {
+        size_t capacity = 16;
+        while (capacity < maxVertices * 2) capacity *= 2;
+        slots.assign(capacity, EMPTY_SLOT);
+    }
+
+    // Index of vertex in vertices, appended when it isn't there yet
+    uint32_t insert(const LveVertex &vertex, std::vector<LveVertex> &vertices) {
+        size_t mask = slots.size() - 1;
+        for (size_t slot = hashVertex(vertex) & mask;; slot = (slot + 1) & mask) {
+            uint32_t index = slots[slot];
+            if (index == EMPTY_SLOT) {
+                index = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(vertex);
+                slots[slot] = index;
+                return index;
+            }
+            if (vertices[index] == vertex) return index;
+        }
+    }
+
+   private:
+    std::vector<uint32_t> slots;
+};
+
+// Runs task(0) .. task(count - 1), task(0) on the calling thread
+template <typename Task>
+void runParallel(size_t count, const Task &task) {
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < count; i++) threads.emplace_back(task, i);
+    task(0);
+    for (std::thread &thread : threads) thread.join();
+}
+
+}  // namespace
+
+void LveMeshBuilder::loadModel(const std::string &filepath) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    parseObj(filepath, attrib, shapes);
+
+    // every face corner of every shape, in file order
+    std::vector<tinyobj::index_t> corners;
+    for (const auto &shape : shapes) {
+        corners.insert(corners.end(), shape.mesh.indices.begin(), shape.mesh.indices.end());
+    }
+    size_t cornerCount = corners.size();
+
+    size_t threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    threadCount = std::clamp<size_t>(cornerCount / MIN_CORNERS_PER_THREAD, 1, threadCount);
+
+    // each range gets its own vertices (first seen order) and indices into them
+    struct Range {
+        size_t begin;
+        size_t end;
+        std::vector<LveVertex> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<uint32_t> remap;
+    };
+    std::vector<Range> ranges(threadCount);
+    runParallel(threadCount, [&](size_t i) {
+        Range &range = ranges[i];
+        range.begin = cornerCount * i / threadCount;
+        range.end = cornerCount * (i + 1) / threadCount;
+        VertexTable table{range.end - range.begin};
+        range.indices.reserve(range.end - range.begin);
+        for (size_t corner = range.begin; corner < range.end; corner++) {
+            range.indices.push_back(table.insert(makeVertex(attrib, corners[corner]), range.vertices));
+        }
+    });
+
+    // merging the ranges in order numbers every vertex where the serial loop first meets it, the output doesn't
+    // depend on the thread count
+    size_t rangeVertexCount = 0;
+    for (const Range &range : ranges) rangeVertexCount += range.vertices.size();
+    VertexTable table{rangeVertexCount};
+    vertices.clear();
+    vertices.reserve(rangeVertexCount);
+    for (Range &range : ranges) {
+        range.remap.resize(range.vertices.size());
+        for (size_t i = 0; i < range.vertices.size(); i++) range.remap[i] = table.insert(range.vertices[i], vertices);
+    }
+
+    lods.clear();
+    indices.resize(cornerCount);
+    runParallel(threadCount, [&](size_t i) {
+        const Range &range = ranges[i];
+        for (size_t corner = range.begin; corner < range.end; corner++) {
+            indices[corner] = range.remap[range.indices[corner - range.begin]];
+        }
+    });
+}
+
+void LveMeshBuilder::loadModelSerial(const std::string &filepath) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    parseObj(filepath, attrib, shapes);
+
+    vertices.clear();
+    indices.clear();
+    lods.clear();
+
+    std::unordered_map<LveVertex, uint32_t> uniqueVertices{};
+    for (const auto &shape : shapes) {
+        for (const auto &index : shape.mesh.indices) {
+            LveVertex vertex = makeVertex(attrib, index);
+
+            if (uniqueVertices.count(vertex) == 0) {
+                uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(vertex);
+            }
+            indices.push_back(uniqueVertices[vertex]);
+        }
+    }
+}
+
+LveMeshOptimizationReport LveMeshBuilder::optimize() {
+    LveMeshOptimizationReport report{};
+    report.before = analyzeVertexCache(indices, vertices.size());
+
+    // exporters that already optimize (comode.obj) can beat Tipsify, their order is kept then
+    std::vector<uint32_t> cacheOrder = indices;
+    optimizeVertexCache(cacheOrder, vertices.size());
+    if (analyzeVertexCache(cacheOrder, vertices.size()).acmr < report.before.acmr) indices.swap(cacheOrder);
+
+    // the cluster order is only worth so many extra vertex transforms
+    float cacheAcmr = analyzeVertexCache(indices, vertices.size()).acmr;
+    std::vector<uint32_t> overdrawOrder = indices;
+    optimizeOverdraw(overdrawOrder, vertices);
+    if (analyzeVertexCache(overdrawOrder, vertices.size()).acmr <= cacheAcmr * MAX_OVERDRAW_ACMR_COST) {
+        indices.swap(overdrawOrder);
+    }
+    optimizeVertexFetch(vertices, indices);
+
+    report.after = analyzeVertexCache(indices, vertices.size());
+    return report;
+}
+
+void LveMeshBuilder::generateLods() {
+    // a second call starts again from LOD 0
+    if (!lods.empty()) indices.resize(lods[0].indexCount);
+    std::vector<uint32_t> fullMesh = indices;
+    lods = {LveMeshLod{0, static_cast<uint32_t>(fullMesh.size()), 0.f, 0}};
+
+    while (lods.size() < MAX_LOD_COUNT) {
+        const LveMeshLod &previous = lods.back();
+        if (previous.indexCount / 2 < MIN_LOD_TRIANGLES * 3) break;
+        float error = 0.f;
+        // each LOD starts over from the full mesh so the errors don't pile up
+        std::vector<uint32_t> simplified = simplifyMesh(vertices, fullMesh, previous.indexCount / 2,
+                                                        std::numeric_limits<float>::max(), &error);
+        if (simplified.empty() || simplified.size() > previous.indexCount * MAX_LOD_INDEX_RATIO) break;
+        optimizeVertexCache(simplified, vertices.size());
+
+        // selectLod takes the coarsest LOD under the pixel error : a finer one that isn't more accurate is never drawn
+        while (lods.size() > 1 && error <= lods.back().error) {
+            indices.resize(lods.back().indexOffset);
+            lods.pop_back();
+        }
+        LveMeshLod lod{static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(simplified.size()), error, 0};
+        indices.insert(indices.end(), simplified.begin(), simplified.end());
+        lods.push_back(lod);
+    }
+}
+
+void LveMeshBuilder::computeBounds(glm::vec3 &boundsMin, glm::vec3 &boundsMax) const {
+    if (vertices.empty()) {
+        boundsMin = boundsMax = glm::vec3{0.f};
+        return;
+    }
+    boundsMin = boundsMax = vertices[0].position;
+    for (const LveVertex &vertex : vertices) {
+        boundsMin = glm::min(boundsMin, vertex.position);
+        boundsMax = glm::max(boundsMax, vertex.position);
+    }
+}
+
+LveMeshContainer LveMeshBuilder::toContainer(const std::string &sourcePath, LveVertexFormat format) const {
+    glm::vec3 boundsMin, boundsMax;
+    computeBounds(boundsMin, boundsMax);
+
+    std::vector<uint8_t> vertexData = packVertices(vertices, format, boundsMin, boundsMax);
+    LveMeshContainer container{};
+    container.setGeometry(format, vertexData.data(), vertexStride(format), static_cast<uint32_t>(vertices.size()),
+                          indices.data(), static_cast<uint32_t>(indices.size()));
+    if (!lods.empty()) container.lods = lods;
+    for (int i = 0; i < 3; i++) {
+        container.boundsMin[i] = boundsMin[i];
+        container.boundsMax[i] = boundsMax[i];
+    }
+    if (!container.setSource(sourcePath)) {
+        throw std::runtime_error("failed to read model source: " + sourcePath);
+    }
+    return container;
+}
+
+}  // namespace lve
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "lve_mesh_container.hpp"
+#include "lve_mesh_optimizer.hpp"
+#include "lve_mesh_simplifier.hpp"
+#include "lve_vertex_format.hpp"
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+// Post-transform cache efficiency of a mesh before and after LveMeshBuilder::optimize
+struct LveMeshOptimizationReport {
+    LveVertexCacheStats before{};
+    LveVertexCacheStats after{};
+};
+
+/*
+ * CPU side of a model (LveModel::Builder) : OBJ import and conversion to and from .lvemesh containers. It doesn't
+ * touch the device, the offline mesh baker shares it with the engine.
+ */
+struct LveMeshBuilder {
+    std::vector<LveVertex> vertices{};
+    std::vector<uint32_t> indices{};
+    // index ranges of the simplified versions (generateLods), empty when indices are a single full mesh
+    std::vector<LveMeshLod> lods{};
+
+    // Splits the face corners across threads, each dedups its range in a flat hash table, then the ranges are merged
+    // in file order : same vertices and indices as loadModelSerial
+    void loadModel(const std::string &filepath);
+    // Single threaded std::unordered_map dedup, the reference loadModel is benchmarked against (mesh baker)
+    void loadModelSerial(const std::string &filepath);
+
+    // Reorders the triangles for the vertex cache then for overdraw, and the vertices in first use order (see
+    // lve_mesh_optimizer.hpp). A step that doesn't pay off (source already cache ordered, clusters costing over 10%
+    // of ACMR) is skipped. Same geometry, deterministic
+    LveMeshOptimizationReport optimize();
+    // Appends LODs of about half the triangles of the previous one, simplified from the full mesh and cache ordered,
+    // until simplifying stops paying off (see lve_mesh_simplifier.hpp). A LOD replaces the finer ones whose error it
+    // doesn't exceed, so errors strictly grow along the chain. Call it after optimize, which reorders the whole index
+    // list
+    void generateLods();
+
+    // Axis aligned box of the vertex positions, zero for an empty mesh
+    void computeBounds(glm::vec3 &boundsMin, glm::vec3 &boundsMax) const;
+    // Container of the current geometry encoded in format, sourcePath is the model file it was imported from
+    LveMeshContainer toContainer(const std::string &sourcePath, LveVertexFormat format = LveVertexFormat::Full) const;
+};
+
+}  // namespace lve
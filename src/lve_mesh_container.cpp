@@ -0,0 +1,224 @@
+#include "lve_mesh_container.hpp"
+
+// std
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace lve {
+
+namespace {
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t vertexStride;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t vertexFormat;
+    uint32_t lodCount;
+    uint32_t reserved;
+    float boundsMin[3];
+    float boundsMax[3];
+    uint64_t sourceSize;
+    uint64_t sourceHash;
+};
+
+constexpr char MAGIC[4] = {'L', 'V', 'M', 'S'};
+
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+uint64_t fnv1a(const uint8_t *data, size_t size) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+// .packed.lvemesh, .packed.nolods.lvemesh for a model imported without its LOD chain
+std::string containerExtension(LveVertexFormat format, bool withLods) {
+    return std::string{"."} + toString(format) + (withLods ? "" : ".nolods") + ".lvemesh";
+}
+
+}  // namespace
+
+const char *toString(LveVertexFormat format) {
+    switch (format) {
+        case LveVertexFormat::Packed:
+            return "packed";
+        case LveVertexFormat::PackedColor:
+            return "packed-color";
+        default:
+            return "full";
+    }
+}
+
+bool parseVertexFormat(const std::string &name, LveVertexFormat &format) {
+    if (name == "full") format = LveVertexFormat::Full;
+    else if (name == "packed") format = LveVertexFormat::Packed;
+    else if (name == "packed-color") format = LveVertexFormat::PackedColor;
+    else return false;
+    return true;
+}
+
+void LveMeshContainer::setGeometry(LveVertexFormat format, const void *vertices, uint32_t stride, uint32_t vertexCount,
+                                   const uint32_t *indices, uint32_t indexCount) {
+    mapping.reset();
+    mappedDataOffset = 0;
+    vertexFormat = format;
+    vertexStride = stride;
+    this->vertexCount = vertexCount;
+    this->indexCount = indexCount;
+    lods = {LveMeshLod{0, indexCount, 0.f, 0}};
+    data.resize(vertexDataSize() + indexDataSize());
+    memcpy(data.data(), vertices, vertexDataSize());
+    memcpy(data.data() + vertexDataSize(), indices, indexDataSize());
+}
+
+bool LveMeshContainer::setSource(const std::string &sourcePath) {
+    std::unique_ptr<LveFileMapping> source = LveFileMapping::map(sourcePath);
+    if (!source) return false;
+    sourceSize = source->size();
+    sourceHash = fnv1a(source->data(), source->size());
+    return true;
+}
+
+bool LveMeshContainer::matchesSource(const std::string &sourcePath, const std::string &containerPath) const {
+    std::error_code error;
+    uint64_t size = fs::file_size(sourcePath, error);
+    if (error || size != sourceSize) return false;
+
+    // written after the last edit of the source, its content can't have changed. Otherwise the source was touched
+    // (checkout, copy) and only its content tells
+    fs::file_time_type sourceTime = fs::last_write_time(sourcePath, error);
+    if (!error) {
+        fs::file_time_type containerTime = fs::last_write_time(containerPath, error);
+        if (!error && containerTime >= sourceTime) return true;
+    }
+
+    std::unique_ptr<LveFileMapping> source = LveFileMapping::map(sourcePath);
+    return source && fnv1a(source->data(), source->size()) == sourceHash;
+}
+
+void LveMeshContainer::save(const std::string &filepath) const {
+    if (lods.empty()) {
+        throw std::runtime_error("mesh container without LOD: " + filepath);
+    }
+    std::string temporaryPath = filepath + ".tmp";
+    std::ofstream file{temporaryPath, std::ios::binary | std::ios::trunc};
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open mesh container for writing: " + temporaryPath);
+    }
+
+    FileHeader header{};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.vertexStride = vertexStride;
+    header.vertexCount = vertexCount;
+    header.indexCount = indexCount;
+    header.vertexFormat = static_cast<uint32_t>(vertexFormat);
+    header.lodCount = static_cast<uint32_t>(lods.size());
+    memcpy(header.boundsMin, boundsMin, sizeof(boundsMin));
+    memcpy(header.boundsMax, boundsMax, sizeof(boundsMax));
+    header.sourceSize = sourceSize;
+    header.sourceHash = sourceHash;
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(lods.data()), lods.size() * sizeof(LveMeshLod));
+    file.write(reinterpret_cast<const char *>(vertexData()), vertexDataSize() + indexDataSize());
+    file.close();
+    std::error_code error;
+    if (!file) {
+        fs::remove(temporaryPath, error);
+        throw std::runtime_error("failed to write mesh container: " + temporaryPath);
+    }
+    fs::rename(temporaryPath, filepath, error);
+    if (error) {
+        fs::remove(temporaryPath, error);
+        throw std::runtime_error("failed to replace mesh container: " + filepath);
+    }
+}
+
+LveMeshContainer LveMeshContainer::map(const std::string &filepath) {
+    std::unique_ptr<LveFileMapping> fileMapping = LveFileMapping::map(filepath);
+    if (!fileMapping) {
+        throw std::runtime_error("failed to open mesh container: " + filepath);
+    }
+    const uint8_t *bytes = fileMapping->data();
+    uint64_t fileSize = fileMapping->size();
+
+    FileHeader header{};
+    if (fileSize < sizeof(header)) {
+        throw std::runtime_error("invalid mesh container: " + filepath);
+    }
+    memcpy(&header, bytes, sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+        throw std::runtime_error("invalid mesh container: " + filepath);
+    }
+
+    if (header.vertexFormat > static_cast<uint32_t>(LveVertexFormat::PackedColor)) {
+        throw std::runtime_error("unknown vertex format in mesh container: " + filepath);
+    }
+
+    LveMeshContainer container{};
+    container.vertexFormat = static_cast<LveVertexFormat>(header.vertexFormat);
+    container.vertexStride = header.vertexStride;
+    container.vertexCount = header.vertexCount;
+    container.indexCount = header.indexCount;
+    memcpy(container.boundsMin, header.boundsMin, sizeof(header.boundsMin));
+    memcpy(container.boundsMax, header.boundsMax, sizeof(header.boundsMax));
+    container.sourceSize = header.sourceSize;
+    container.sourceHash = header.sourceHash;
+    uint64_t lodTableSize = static_cast<uint64_t>(header.lodCount) * sizeof(LveMeshLod);
+    if (header.lodCount == 0 ||
+        sizeof(header) + lodTableSize + container.vertexDataSize() + container.indexDataSize() != fileSize) {
+        throw std::runtime_error("corrupted mesh container: " + filepath);
+    }
+
+    container.lods.resize(header.lodCount);
+    memcpy(container.lods.data(), bytes + sizeof(header), lodTableSize);
+    for (const LveMeshLod &lod : container.lods) {
+        if (static_cast<uint64_t>(lod.indexOffset) + lod.indexCount > container.indexCount) {
+            throw std::runtime_error("corrupted mesh container: " + filepath);
+        }
+    }
+
+    container.mapping = std::move(fileMapping);
+    container.mappedDataOffset = sizeof(header) + lodTableSize;
+    return container;
+}
+
+LveMeshContainer LveMeshContainer::load(const std::string &filepath) {
+    LveMeshContainer container = map(filepath);
+    container.data.assign(container.vertexData(),
+                          container.vertexData() + container.vertexDataSize() + container.indexDataSize());
+    container.mapping.reset();
+    container.mappedDataOffset = 0;
+    return container;
+}
+
+std::string LveMeshContainer::containerPath(const std::string &sourcePath, LveVertexFormat format, bool withLods) {
+    return fs::path(sourcePath).replace_extension(containerExtension(format, withLods)).string();
+}
+
+std::string LveMeshContainer::cachePath(const std::string &sourcePath, LveVertexFormat format, bool withLods,
+                                        const std::string &cacheDirectory) {
+    // the same file reached through another relative path shares its entry
+    std::error_code error;
+    fs::path normalizedPath = fs::absolute(sourcePath, error).lexically_normal();
+    std::string key = error ? sourcePath : normalizedPath.string();
+    char hash[17];
+    snprintf(hash, sizeof(hash), "%016llx",
+             static_cast<unsigned long long>(fnv1a(reinterpret_cast<const uint8_t *>(key.data()), key.size())));
+    return cacheDirectory + fs::path(sourcePath).stem().string() + "-" + hash + containerExtension(format, withLods);
+}
+
+}  // namespace lve
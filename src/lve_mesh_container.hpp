@@ -0,0 +1,102 @@
+#pragma once
+
+#include "lve_file_mapping.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// relative to the working directory, which is the build directory
+#ifndef MESH_CACHE_DIR
+#define MESH_CACHE_DIR "mesh_cache/"
+#endif
+
+namespace lve {
+
+// Vertex layout of a model (see lve_vertex_format.hpp), independent of Vulkan so the offline tools can share it
+enum class LveVertexFormat : uint32_t {
+    Full = 0,         // LveVertex, fp32 everywhere, 44 bytes
+    Packed = 1,       // LvePackedVertex without its color, 16 bytes
+    PackedColor = 2,  // LvePackedVertex, 20 bytes
+};
+
+const char *toString(LveVertexFormat format);
+// "full", "packed" or "packed-color", false for another name
+bool parseVertexFormat(const std::string &name, LveVertexFormat &format);
+
+// Range of the index blob drawn at one level of detail. error is how far the simplified surface strays from the full
+// mesh, in model units, measured at import at the source vertices (see simplifyMesh) : LOD 0 is the full mesh with
+// error 0, each next one has about half the triangles
+struct LveMeshLod {
+    uint32_t indexOffset = 0;
+    uint32_t indexCount = 0;
+    float error = 0.f;
+    uint32_t reserved = 0;
+};
+
+/*
+ * .lvemesh file : an imported model with its vertices and indices already in the layout LveModel uploads, baked next
+ * to the source by tools/mesh_baker or written to the build side MESH_CACHE_DIR after a first import, so later
+ * startups skip the OBJ parsing.
+ *
+ * Layout (little endian) : header {"LVMS", version, vertexStride, vertexCount, indexCount, vertexFormat, lodCount,
+ * reserved, boundsMin[3], boundsMax[3], sourceSize, sourceHash}, the LOD table, the vertex blob then the uint32 index
+ * blob. Packed positions are quantized in the bounds. The LODs share the vertices, their index ranges follow each
+ * other in the blob.
+ *
+ * The source size and content hash tell whether the file still matches the model it was imported from. Any change
+ * of the vertex layout must bump VERSION, the stride alone doesn't catch a reordering.
+ */
+struct LveMeshContainer {
+    static constexpr uint32_t VERSION = 4;
+
+    LveVertexFormat vertexFormat = LveVertexFormat::Full;
+    uint32_t vertexStride = 0;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    float boundsMin[3] = {};
+    float boundsMax[3] = {};
+    uint64_t sourceSize = 0;
+    uint64_t sourceHash = 0;
+    // finest first, a single LOD covering every index when the model has no simplified versions
+    std::vector<LveMeshLod> lods;
+    // vertex blob followed by the index blob, empty for mapped containers
+    std::vector<uint8_t> data;
+
+    const uint8_t *vertexData() const { return mapping ? mapping->data() + mappedDataOffset : data.data(); }
+    uint64_t vertexDataSize() const { return static_cast<uint64_t>(vertexStride) * vertexCount; }
+    const uint32_t *indexData() const { return reinterpret_cast<const uint32_t *>(vertexData() + vertexDataSize()); }
+    uint64_t indexDataSize() const { return static_cast<uint64_t>(indexCount) * sizeof(uint32_t); }
+
+    // Replaces the blobs with a single LOD, the bounds are the caller's (and must be the ones packed positions were
+    // quantized in)
+    void setGeometry(LveVertexFormat format, const void *vertices, uint32_t stride, uint32_t vertexCount,
+                     const uint32_t *indices, uint32_t indexCount);
+    // Records the size and content hash of the model file, false when it can't be read
+    bool setSource(const std::string &sourcePath);
+    // Same size as the recorded source and, unless the container file is the newer one, same content hash
+    bool matchesSource(const std::string &sourcePath, const std::string &containerPath) const;
+
+    // Writes a temporary file then renames it over filepath : a crash or a concurrent reader never sees it truncated
+    void save(const std::string &filepath) const;
+    static LveMeshContainer load(const std::string &filepath);
+    // Maps the file instead of reading it, the mapping lives as long as the container (and its copies)
+    static LveMeshContainer map(const std::string &filepath);
+
+    // models/duck.obj -> models/duck.packed.lvemesh, baked by tools/mesh_baker. The format and whether the LOD chain
+    // was generated are part of the name (models/ocean.packed.nolods.lvemesh), so a model loaded both ways keeps one
+    // container for each
+    static std::string containerPath(const std::string &sourcePath, LveVertexFormat format, bool withLods = true);
+    // models/duck.obj -> mesh_cache/duck-<hash of the source path>.packed.lvemesh, written by the engine after an
+    // import
+    static std::string cachePath(const std::string &sourcePath, LveVertexFormat format, bool withLods = true,
+                                 const std::string &cacheDirectory = MESH_CACHE_DIR);
+
+   private:
+    std::shared_ptr<LveFileMapping> mapping;
+    uint64_t mappedDataOffset = 0;
+};
+
+}  // namespace lve
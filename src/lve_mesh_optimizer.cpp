@@ -0,0 +1,247 @@
+#include "lve_mesh_optimizer.hpp"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace lve {
+
+namespace {
+
+constexpr uint32_t NO_VERTEX = UINT32_MAX;
+
+// FIFO cache kept as timestamps : a vertex is cached until cacheSize other vertices missed after it
+class CacheTimestamps {
+   public:
+    CacheTimestamps(size_t vertexCount, uint32_t cacheSize)
+        : cacheSize{cacheSize}, times(vertexCount, 0), now{cacheSize + 1} {}
+
+    // Misses since the vertex entered the cache, more than cacheSize when it isn't there
+    uint32_t age(uint32_t vertex) const { return now - times[vertex]; }
+    // Number of misses among the three vertices
+    uint32_t useTriangle(const uint32_t *triangle) {
+        uint32_t misses = 0;
+        for (int i = 0; i < 3; i++) {
+            if (age(triangle[i]) > cacheSize) {
+                times[triangle[i]] = now++;
+                misses++;
+            }
+        }
+        return misses;
+    }
+    // Empties the cache
+    void flush() { now += cacheSize + 1; }
+
+   private:
+    uint32_t cacheSize;
+    std::vector<uint32_t> times;
+    uint32_t now;
+};
+
+// Triangles using each vertex, those of vertex v are triangles[offsets[v]] .. triangles[offsets[v + 1] - 1]
+struct TriangleAdjacency {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+};
+
+TriangleAdjacency buildAdjacency(const std::vector<uint32_t> &indices, size_t vertexCount) {
+    TriangleAdjacency adjacency{};
+    adjacency.offsets.assign(vertexCount + 1, 0);
+    for (uint32_t index : indices) adjacency.offsets[index + 1]++;
+    for (size_t v = 0; v < vertexCount; v++) adjacency.offsets[v + 1] += adjacency.offsets[v];
+
+    std::vector<uint32_t> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    adjacency.triangles.resize(indices.size());
+    for (size_t i = 0; i < indices.size(); i++) {
+        adjacency.triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+    return adjacency;
+}
+
+// First triangle of each cluster. A cluster starts wherever the cache order jumps to a disjoint patch (three misses),
+// then is split again where its running ACMR falls under threshold times the ACMR of the whole patch
+std::vector<uint32_t> buildClusters(const std::vector<uint32_t> &indices, size_t vertexCount, float threshold,
+                                    uint32_t cacheSize) {
+    uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    CacheTimestamps cache{vertexCount, cacheSize};
+
+    std::vector<uint32_t> patches;
+    for (uint32_t t = 0; t < triangleCount; t++) {
+        uint32_t misses = cache.useTriangle(&indices[3 * t]);
+        if (t == 0 || misses == 3) patches.push_back(t);
+    }
+    patches.push_back(triangleCount);
+
+    std::vector<uint32_t> clusters;
+    for (size_t p = 0; p + 1 < patches.size(); p++) {
+        uint32_t begin = patches[p];
+        uint32_t end = patches[p + 1];
+
+        cache.flush();
+        uint32_t patchMisses = 0;
+        for (uint32_t t = begin; t < end; t++) patchMisses += cache.useTriangle(&indices[3 * t]);
+        float clusterThreshold = threshold * static_cast<float>(patchMisses) / static_cast<float>(end - begin);
+
+        clusters.push_back(begin);
+        cache.flush();
+        uint32_t clusterMisses = 0;
+        for (uint32_t t = begin; t < end; t++) {
+            clusterMisses += cache.useTriangle(&indices[3 * t]);
+            float clusterAcmr = static_cast<float>(clusterMisses) / static_cast<float>(t + 1 - clusters.back());
+            if (clusterAcmr <= clusterThreshold && t + 1 < end) {
+                clusters.push_back(t + 1);
+                cache.flush();
+                clusterMisses = 0;
+            }
+        }
+    }
+    return clusters;
+}
+
+}  // namespace
+
+LveVertexCacheStats analyzeVertexCache(const std::vector<uint32_t> &indices, size_t vertexCount,
+                                       uint32_t cacheSize) {
+    LveVertexCacheStats stats{};
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0) return stats;
+
+    CacheTimestamps cache{vertexCount, cacheSize};
+    size_t transformed = 0;
+    for (size_t t = 0; t < triangleCount; t++) transformed += cache.useTriangle(&indices[3 * t]);
+
+    stats.acmr = static_cast<float>(transformed) / static_cast<float>(triangleCount);
+    stats.atvr = static_cast<float>(transformed) / static_cast<float>(vertexCount);
+    return stats;
+}
+
+void optimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount, uint32_t cacheSize) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    TriangleAdjacency adjacency = buildAdjacency(indices, vertexCount);
+    // triangles of each vertex not emitted yet
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+
+    CacheTimestamps cache{vertexCount, cacheSize};
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnds;  // emitted vertices, most recent last
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    uint32_t cursor = 0;
+
+    // fans every remaining triangle around one vertex, then moves to the candidate that is the most recently cached
+    // while staying cached through its own fan
+    uint32_t fanning = 0;
+    while (fanning != NO_VERTEX) {
+        candidates.clear();
+        for (uint32_t i = adjacency.offsets[fanning]; i < adjacency.offsets[fanning + 1]; i++) {
+            uint32_t triangle = adjacency.triangles[i];
+            if (emitted[triangle]) continue;
+            emitted[triangle] = true;
+
+            const uint32_t *corners = &indices[3 * triangle];
+            cache.useTriangle(corners);
+            for (int c = 0; c < 3; c++) {
+                output.push_back(corners[c]);
+                deadEnds.push_back(corners[c]);
+                candidates.push_back(corners[c]);
+                liveTriangles[corners[c]]--;
+            }
+        }
+
+        fanning = NO_VERTEX;
+        int64_t bestPriority = -1;
+        for (uint32_t v : candidates) {
+            if (liveTriangles[v] == 0) continue;
+            // each of its triangles brings at most two new vertices
+            int64_t age = cache.age(v);
+            int64_t priority = 0;
+            if (age + 2 * static_cast<int64_t>(liveTriangles[v]) <= cacheSize) priority = age;
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                fanning = v;
+            }
+        }
+        // dead end : the latest emitted vertex with triangles left, otherwise the next one in index order
+        while (fanning == NO_VERTEX && !deadEnds.empty()) {
+            uint32_t v = deadEnds.back();
+            deadEnds.pop_back();
+            if (liveTriangles[v] > 0) fanning = v;
+        }
+        while (fanning == NO_VERTEX && cursor < vertexCount) {
+            if (liveTriangles[cursor] > 0) fanning = cursor;
+            cursor++;
+        }
+    }
+    indices.swap(output);
+}
+
+void optimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<LveVertex> &vertices, float threshold,
+                      uint32_t cacheSize) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    std::vector<uint32_t> clusters = buildClusters(indices, vertices.size(), threshold, cacheSize);
+    clusters.push_back(static_cast<uint32_t>(triangleCount));
+    size_t clusterCount = clusters.size() - 1;
+
+    // area weighted centroids, and the summed cross products as cluster normals
+    std::vector<glm::vec3> centroids(clusterCount, glm::vec3{0.f});
+    std::vector<glm::vec3> normals(clusterCount, glm::vec3{0.f});
+    std::vector<float> areas(clusterCount, 0.f);
+    glm::vec3 meshCentroid{0.f};
+    float meshArea = 0.f;
+    for (size_t c = 0; c < clusterCount; c++) {
+        for (uint32_t t = clusters[c]; t < clusters[c + 1]; t++) {
+            const glm::vec3 &p0 = vertices[indices[3 * t + 0]].position;
+            const glm::vec3 &p1 = vertices[indices[3 * t + 1]].position;
+            const glm::vec3 &p2 = vertices[indices[3 * t + 2]].position;
+            glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            float area = glm::length(normal);
+            centroids[c] += (p0 + p1 + p2) * (area / 3.f);
+            normals[c] += normal;
+            areas[c] += area;
+        }
+        meshCentroid += centroids[c];
+        meshArea += areas[c];
+    }
+    if (meshArea > 0.f) meshCentroid /= meshArea;
+
+    // clusters facing away from the center are drawn first, they are the likeliest to hide the others
+    std::vector<float> keys(clusterCount, 0.f);
+    for (size_t c = 0; c < clusterCount; c++) {
+        float normalLength = glm::length(normals[c]);
+        if (areas[c] <= 0.f || normalLength <= 0.f) continue;
+        keys[c] = glm::dot(centroids[c] / areas[c] - meshCentroid, normals[c] / normalLength);
+    }
+    std::vector<uint32_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++) order[c] = static_cast<uint32_t>(c);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] > keys[b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (uint32_t c : order) {
+        output.insert(output.end(), indices.begin() + 3 * clusters[c], indices.begin() + 3 * clusters[c + 1]);
+    }
+    indices.swap(output);
+}
+
+void optimizeVertexFetch(std::vector<LveVertex> &vertices, std::vector<uint32_t> &indices) {
+    std::vector<uint32_t> remap(vertices.size(), NO_VERTEX);
+    std::vector<LveVertex> ordered;
+    ordered.reserve(vertices.size());
+    for (uint32_t &index : indices) {
+        if (remap[index] == NO_VERTEX) {
+            remap[index] = static_cast<uint32_t>(ordered.size());
+            ordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(ordered);
+}
+
+}  // namespace lve
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "lve_vertex_format.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+/*
+ * Import time reordering of a mesh for the GPU, run by LveMeshBuilder::optimize before the mesh is cached :
+ *  - optimizeVertexCache : triangle order for the post-transform vertex cache (Tipsify, Sander et al. 2007)
+ *  - optimizeOverdraw : groups of triangles that stay cache friendly, sorted so the outward facing ones come first
+ *  - optimizeVertexFetch : vertices in the order the triangles first use them, indices remapped
+ *
+ * Nothing depends on hashing or thread timing, the same mesh always gives the same output so a re-import writes the
+ * same .lvemesh.
+ */
+
+// FIFO cache size the orders are optimized for and measured with, at or below what current GPUs keep
+constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+struct LveVertexCacheStats {
+    float acmr = 0.f;  // transformed vertices per triangle : 3 at worst, about 0.5 for a regular grid
+    float atvr = 0.f;  // transformed vertices per vertex : 1 when each vertex is transformed once
+};
+
+// Simulates a FIFO post-transform cache over the triangles
+LveVertexCacheStats analyzeVertexCache(const std::vector<uint32_t> &indices, size_t vertexCount,
+                                       uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+void optimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount, uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+// Expects the output of optimizeVertexCache. A cluster keeps at most threshold times the ACMR of its part of the mesh,
+// so the reordering costs at most that much vertex cache efficiency
+void optimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<LveVertex> &vertices, float threshold = 1.05f,
+                      uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+// Vertices no triangle uses are dropped
+void optimizeVertexFetch(std::vector<LveVertex> &vertices, std::vector<uint32_t> &indices);
+
+}  // namespace lve
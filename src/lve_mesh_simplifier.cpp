@@ -0,0 +1,503 @@
+#include "lve_mesh_simplifier.hpp"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+namespace lve {
+
+namespace {
+
+constexpr uint32_t NO_VERTEX = UINT32_MAX;
+// border planes outweigh the surface ones so outlines are kept before flat areas
+constexpr double BORDER_WEIGHT = 10.0;
+// a collapse is rejected when it turns a triangle by more than about 75 degrees
+constexpr float MIN_NORMAL_COSINE = 0.25f;
+
+enum class VertexKind : uint8_t {
+    Manifold,  // collapses onto any neighbour
+    Border,    // on an open edge, collapses along it only
+    Locked,    // seam, corner of the border or non-manifold, never moves
+};
+
+// Sum of squared distances to weighted planes, error() divides by the weights to give an average squared distance
+struct Quadric {
+    double a00 = 0.0, a11 = 0.0, a22 = 0.0, a01 = 0.0, a02 = 0.0, a12 = 0.0;
+    double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+    double c = 0.0;
+    double weight = 0.0;
+
+    void addPlane(const glm::vec3 &normal, float distance, double planeWeight) {
+        double x = normal.x, y = normal.y, z = normal.z, d = distance;
+        a00 += planeWeight * x * x;
+        a11 += planeWeight * y * y;
+        a22 += planeWeight * z * z;
+        a01 += planeWeight * x * y;
+        a02 += planeWeight * x * z;
+        a12 += planeWeight * y * z;
+        b0 += planeWeight * x * d;
+        b1 += planeWeight * y * d;
+        b2 += planeWeight * z * d;
+        c += planeWeight * d * d;
+        weight += planeWeight;
+    }
+
+    Quadric &operator+=(const Quadric &other) {
+        a00 += other.a00;
+        a11 += other.a11;
+        a22 += other.a22;
+        a01 += other.a01;
+        a02 += other.a02;
+        a12 += other.a12;
+        b0 += other.b0;
+        b1 += other.b1;
+        b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+        return *this;
+    }
+
+    double error(const glm::vec3 &point) const {
+        if (weight <= 0.0) return 0.0;
+        double x = point.x, y = point.y, z = point.z;
+        double result = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                        2.0 * (b0 * x + b1 * y + b2 * z) + c;
+        return std::max(result, 0.0) / weight;
+    }
+};
+
+// Triangles using each vertex, those of vertex v are triangles[offsets[v]] .. triangles[offsets[v + 1] - 1]
+struct VertexTriangles {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+
+    VertexTriangles(const std::vector<uint32_t> &indices, size_t vertexCount) : offsets(vertexCount + 1, 0) {
+        for (uint32_t index : indices) offsets[index + 1]++;
+        for (size_t v = 0; v < vertexCount; v++) offsets[v + 1] += offsets[v];
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        triangles.resize(indices.size());
+        for (size_t i = 0; i < indices.size(); i++) triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+};
+
+// First vertex with the same position as each vertex, so the welded mesh can be walked through the wedges
+std::vector<uint32_t> buildPositionRemap(const std::vector<LveVertex> &vertices) {
+    std::vector<uint32_t> order(vertices.size());
+    std::iota(order.begin(), order.end(), 0u);
+    auto positionLess = [&](uint32_t a, uint32_t b) {
+        const glm::vec3 &pa = vertices[a].position;
+        const glm::vec3 &pb = vertices[b].position;
+        return std::tie(pa.x, pa.y, pa.z, a) < std::tie(pb.x, pb.y, pb.z, b);
+    };
+    std::sort(order.begin(), order.end(), positionLess);
+
+    std::vector<uint32_t> remap(vertices.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        bool samePosition = i > 0 && vertices[order[i]].position == vertices[order[i - 1]].position;
+        remap[order[i]] = samePosition ? remap[order[i - 1]] : order[i];
+    }
+    return remap;
+}
+
+// Circular list of the vertices sharing a position : next[v] is the following copy of v, v itself when it has none
+std::vector<uint32_t> buildWedgeLoops(const std::vector<uint32_t> &wedge) {
+    std::vector<uint32_t> next(wedge.size());
+    std::iota(next.begin(), next.end(), 0u);
+    for (uint32_t v = 0; v < wedge.size(); v++) {
+        uint32_t first = wedge[v];
+        if (first == v) continue;
+        next[v] = next[first];
+        next[first] = v;
+    }
+    return next;
+}
+
+uint64_t edgeKey(uint32_t a, uint32_t b) {
+    if (a > b) std::swap(a, b);
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+// Kinds are decided once on the welded source mesh, collapses keep them true : borders stay borders and locked
+// vertices don't move
+std::vector<VertexKind> classifyVertices(const std::vector<uint32_t> &indices, const std::vector<uint32_t> &wedge) {
+    size_t vertexCount = wedge.size();
+    std::vector<uint32_t> wedgeCount(vertexCount, 0);
+    for (size_t v = 0; v < vertexCount; v++) wedgeCount[wedge[v]]++;
+
+    std::vector<uint64_t> edges;
+    edges.reserve(indices.size());
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        for (int e = 0; e < 3; e++) {
+            uint32_t a = wedge[indices[t + e]];
+            uint32_t b = wedge[indices[t + (e + 1) % 3]];
+            if (a != b) edges.push_back(edgeKey(a, b));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    // per welded position : open edges, and whether an edge is shared by more than two triangles
+    std::vector<uint32_t> borderEdges(vertexCount, 0);
+    std::vector<bool> nonManifold(vertexCount, false);
+    for (size_t i = 0; i < edges.size();) {
+        size_t j = i;
+        while (j < edges.size() && edges[j] == edges[i]) j++;
+        uint32_t a = static_cast<uint32_t>(edges[i] >> 32);
+        uint32_t b = static_cast<uint32_t>(edges[i] & 0xffffffffu);
+        if (j - i == 1) {
+            borderEdges[a]++;
+            borderEdges[b]++;
+        } else if (j - i > 2) {
+            nonManifold[a] = true;
+            nonManifold[b] = true;
+        }
+        i = j;
+    }
+
+    std::vector<VertexKind> kinds(vertexCount, VertexKind::Manifold);
+    for (size_t v = 0; v < vertexCount; v++) {
+        uint32_t w = wedge[v];
+        if (wedgeCount[w] > 1 || nonManifold[w] || (borderEdges[w] != 0 && borderEdges[w] != 2)) {
+            kinds[v] = VertexKind::Locked;
+        } else if (borderEdges[w] == 2) {
+            kinds[v] = VertexKind::Border;
+        }
+    }
+    return kinds;
+}
+
+// Plane of every triangle weighted by its area, plus a plane through each open edge perpendicular to its triangle
+std::vector<Quadric> buildQuadrics(const std::vector<LveVertex> &vertices, const std::vector<uint32_t> &indices,
+                                   const std::vector<uint32_t> &wedge) {
+    std::vector<Quadric> quadrics(vertices.size());
+
+    std::vector<uint64_t> edges;
+    edges.reserve(indices.size());
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        for (int e = 0; e < 3; e++) edges.push_back(edgeKey(wedge[indices[t + e]], wedge[indices[t + (e + 1) % 3]]));
+    }
+    std::sort(edges.begin(), edges.end());
+    auto isBorder = [&](uint32_t a, uint32_t b) {
+        auto range = std::equal_range(edges.begin(), edges.end(), edgeKey(wedge[a], wedge[b]));
+        return range.second - range.first == 1;
+    };
+
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        const uint32_t *corners = &indices[t];
+        glm::vec3 p0 = vertices[corners[0]].position;
+        glm::vec3 normal = glm::cross(vertices[corners[1]].position - p0, vertices[corners[2]].position - p0);
+        float doubleArea = glm::length(normal);
+        if (doubleArea <= 0.f) continue;
+        normal /= doubleArea;
+
+        for (int c = 0; c < 3; c++) quadrics[corners[c]].addPlane(normal, -glm::dot(normal, p0), doubleArea * 0.5);
+
+        for (int e = 0; e < 3; e++) {
+            uint32_t a = corners[e];
+            uint32_t b = corners[(e + 1) % 3];
+            if (!isBorder(a, b)) continue;
+            glm::vec3 edge = vertices[b].position - vertices[a].position;
+            float edgeLength = glm::length(edge);
+            if (edgeLength <= 0.f) continue;
+            glm::vec3 side = glm::cross(edge / edgeLength, normal);
+            float distance = -glm::dot(side, vertices[a].position);
+            double planeWeight = BORDER_WEIGHT * edgeLength * edgeLength;
+            quadrics[a].addPlane(side, distance, planeWeight);
+            quadrics[b].addPlane(side, distance, planeWeight);
+        }
+    }
+    return quadrics;
+}
+
+float pointSegmentDistanceSquared(const glm::vec3 &p, const glm::vec3 &a, const glm::vec3 &b) {
+    glm::vec3 ab = b - a;
+    float lengthSquared = glm::dot(ab, ab);
+    float t = lengthSquared > 0.f ? glm::clamp(glm::dot(p - a, ab) / lengthSquared, 0.f, 1.f) : 0.f;
+    glm::vec3 offset = p - (a + ab * t);
+    return glm::dot(offset, offset);
+}
+
+// Closest point on the triangle by Voronoi region (Ericson, Real-Time Collision Detection 5.1.5)
+float pointTriangleDistanceSquared(const glm::vec3 &p, const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c) {
+    glm::vec3 ab = b - a;
+    glm::vec3 ac = c - a;
+    glm::vec3 normal = glm::cross(ab, ac);
+    // a collapse along a seam can leave triangles with no area, the regions below divide by it
+    if (glm::dot(normal, normal) <= 0.f) {
+        return std::min(pointSegmentDistanceSquared(p, a, b),
+                        std::min(pointSegmentDistanceSquared(p, b, c), pointSegmentDistanceSquared(p, c, a)));
+    }
+
+    glm::vec3 ap = p - a;
+    float d1 = glm::dot(ab, ap);
+    float d2 = glm::dot(ac, ap);
+    if (d1 <= 0.f && d2 <= 0.f) return glm::dot(ap, ap);
+
+    glm::vec3 bp = p - b;
+    float d3 = glm::dot(ab, bp);
+    float d4 = glm::dot(ac, bp);
+    if (d3 >= 0.f && d4 <= d3) return glm::dot(bp, bp);
+
+    glm::vec3 cp = p - c;
+    float d5 = glm::dot(ab, cp);
+    float d6 = glm::dot(ac, cp);
+    if (d6 >= 0.f && d5 <= d6) return glm::dot(cp, cp);
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f) return pointSegmentDistanceSquared(p, a, b);
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f) return pointSegmentDistanceSquared(p, a, c);
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.f && d4 - d3 >= 0.f && d5 - d6 >= 0.f) return pointSegmentDistanceSquared(p, b, c);
+
+    // inside : distance to the plane
+    float distance = glm::dot(ap, normal);
+    return distance * distance / glm::dot(normal, normal);
+}
+
+struct Collapse {
+    uint32_t source;
+    uint32_t target;
+    double cost;
+};
+
+class Simplifier {
+   public:
+    Simplifier(const std::vector<LveVertex> &vertices, const std::vector<uint32_t> &indices)
+        : vertices{vertices},
+          wedge{buildPositionRemap(vertices)},
+          wedgeNext{buildWedgeLoops(wedge)},
+          kinds{classifyVertices(indices, wedge)},
+          quadrics{buildQuadrics(vertices, indices, wedge)},
+          stamps(vertices.size(), 0),
+          movedTo(vertices.size()) {
+        std::iota(movedTo.begin(), movedTo.end(), 0u);
+    }
+
+    // One pass of independent collapses, cheapest first, stopping once removeCount indices are gone. Returns false
+    // when nothing could collapse
+    bool collapsePass(std::vector<uint32_t> &indices, size_t removeCount, double maxCost) {
+        VertexTriangles around{indices, vertices.size()};
+        std::vector<Collapse> collapses = findCollapses(indices, around);
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) {
+            return std::tie(a.cost, a.source) < std::tie(b.cost, b.source);
+        });
+
+        std::vector<uint32_t> remap(vertices.size());
+        std::iota(remap.begin(), remap.end(), 0u);
+        std::vector<bool> touched(vertices.size(), false);
+        size_t removed = 0;
+        bool collapsed = false;
+        for (const Collapse &collapse : collapses) {
+            if (collapse.cost > maxCost || removed >= removeCount) break;
+            uint32_t a = collapse.source;
+            uint32_t b = collapse.target;
+            if (touched[a] || touched[b]) continue;
+            if (!keepsTopology(indices, around, a, b) || flipsTriangle(indices, around, a, b)) continue;
+
+            // the triangles around a are all touched, so later collapses of this pass see them as they are now
+            for (uint32_t i = around.offsets[a]; i < around.offsets[a + 1]; i++) {
+                const uint32_t *corners = &indices[3 * around.triangles[i]];
+                bool sharesEdge = false;
+                for (int c = 0; c < 3; c++) {
+                    touched[corners[c]] = true;
+                    sharesEdge |= corners[c] == b;
+                }
+                if (sharesEdge) removed += 3;
+            }
+            touched[b] = true;
+            remap[a] = b;
+            quadrics[b] += quadrics[a];
+            collapsed = true;
+        }
+        if (!collapsed) return false;
+
+        size_t kept = 0;
+        for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+            uint32_t i0 = remap[indices[t + 0]];
+            uint32_t i1 = remap[indices[t + 1]];
+            uint32_t i2 = remap[indices[t + 2]];
+            if (i0 == i1 || i1 == i2 || i0 == i2) continue;
+            indices[kept++] = i0;
+            indices[kept++] = i1;
+            indices[kept++] = i2;
+        }
+        indices.resize(kept);
+        for (uint32_t &target : movedTo) target = remap[target];
+        return true;
+    }
+
+    // Largest distance from a vertex of the source mesh to the simplified surface. Each vertex is only measured
+    // against the triangles up to two rings around the one it was collapsed onto : the nearest of those may not be the
+    // nearest of the whole surface, which can only overestimate that vertex's distance
+    float measureDeviation(const std::vector<uint32_t> &sourceIndices, const std::vector<uint32_t> &indices) const {
+        if (indices.empty()) return 0.f;
+        std::vector<uint32_t> welded(indices.size());
+        for (size_t i = 0; i < indices.size(); i++) welded[i] = wedge[indices[i]];
+        VertexTriangles around{welded, vertices.size()};
+
+        std::vector<bool> measured(vertices.size(), false);
+        float maxDistanceSquared = 0.f;
+        for (uint32_t v : sourceIndices) {
+            if (measured[v]) continue;
+            measured[v] = true;
+            const glm::vec3 &position = vertices[v].position;
+            float distanceSquared = std::numeric_limits<float>::max();
+            auto measure = [&](uint32_t triangle) {
+                const uint32_t *corners = &indices[3 * triangle];
+                distanceSquared = std::min(distanceSquared, pointTriangleDistanceSquared(
+                                                                position, vertices[corners[0]].position,
+                                                                vertices[corners[1]].position,
+                                                                vertices[corners[2]].position));
+            };
+
+            uint32_t target = wedge[movedTo[v]];
+            for (uint32_t i = around.offsets[target]; i < around.offsets[target + 1]; i++) {
+                const uint32_t *corners = &welded[3 * around.triangles[i]];
+                for (int c = 0; c < 3; c++) {
+                    for (uint32_t j = around.offsets[corners[c]]; j < around.offsets[corners[c] + 1]; j++) {
+                        measure(around.triangles[j]);
+                    }
+                }
+            }
+            // no triangle left around the target : against the whole surface
+            if (around.offsets[target] == around.offsets[target + 1]) {
+                for (uint32_t triangle = 0; triangle < indices.size() / 3; triangle++) measure(triangle);
+            }
+            maxDistanceSquared = std::max(maxDistanceSquared, distanceSquared);
+        }
+        return std::sqrt(maxDistanceSquared);
+    }
+
+   private:
+    // Cheapest allowed target of every vertex
+    std::vector<Collapse> findCollapses(const std::vector<uint32_t> &indices, const VertexTriangles &around) const {
+        std::vector<Collapse> best(vertices.size(), Collapse{NO_VERTEX, NO_VERTEX, 0.0});
+        for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+            for (int e = 0; e < 6; e++) {
+                uint32_t a = indices[t + e % 3];
+                uint32_t b = indices[t + (e < 3 ? (e + 1) % 3 : (e + 2) % 3)];
+                if (a == b || !canCollapse(indices, around, a, b)) continue;
+
+                Quadric merged = quadrics[a];
+                merged += quadrics[b];
+                double cost = merged.error(vertices[b].position);
+                Collapse &current = best[a];
+                if (current.target == NO_VERTEX || std::tie(cost, b) < std::tie(current.cost, current.target)) {
+                    current = Collapse{a, b, cost};
+                }
+            }
+        }
+
+        std::vector<Collapse> collapses;
+        for (const Collapse &collapse : best) {
+            if (collapse.target != NO_VERTEX) collapses.push_back(collapse);
+        }
+        return collapses;
+    }
+
+    bool canCollapse(const std::vector<uint32_t> &indices, const VertexTriangles &around, uint32_t a,
+                     uint32_t b) const {
+        switch (kinds[a]) {
+            case VertexKind::Manifold:
+                return true;
+            case VertexKind::Border: {
+                // along the border : a single triangle holds the edge
+                uint32_t shared = 0;
+                for (uint32_t i = around.offsets[a]; i < around.offsets[a + 1]; i++) {
+                    const uint32_t *corners = &indices[3 * around.triangles[i]];
+                    for (int c = 0; c < 3; c++) shared += wedge[corners[c]] == wedge[b];
+                }
+                return shared == 1;
+            }
+            case VertexKind::Locked:
+                return false;
+        }
+        return false;
+    }
+
+    // Link condition : a and b may only share the neighbours of the triangles holding their edge, otherwise the
+    // collapse pinches the surface. a moves so it has no other copy, b may be a seam : the neighbours of every copy
+    // count
+    bool keepsTopology(const std::vector<uint32_t> &indices, const VertexTriangles &around, uint32_t a, uint32_t b) {
+        currentStamp++;
+        uint32_t copy = b;
+        do {
+            for (uint32_t i = around.offsets[copy]; i < around.offsets[copy + 1]; i++) {
+                const uint32_t *corners = &indices[3 * around.triangles[i]];
+                for (int c = 0; c < 3; c++) stamps[wedge[corners[c]]] = currentStamp;
+            }
+            copy = wedgeNext[copy];
+        } while (copy != b);
+
+        uint32_t sharedTriangles = 0;
+        uint32_t sharedNeighbours = 0;
+        uint32_t visitedStamp = ++currentStamp;
+        for (uint32_t i = around.offsets[a]; i < around.offsets[a + 1]; i++) {
+            const uint32_t *corners = &indices[3 * around.triangles[i]];
+            bool holdsEdge = false;
+            for (int c = 0; c < 3; c++) holdsEdge |= wedge[corners[c]] == wedge[b];
+            sharedTriangles += holdsEdge;
+            for (int c = 0; c < 3; c++) {
+                uint32_t w = wedge[corners[c]];
+                if (w == wedge[a] || w == wedge[b]) continue;
+                if (stamps[w] == visitedStamp - 1) {
+                    stamps[w] = visitedStamp;
+                    sharedNeighbours++;
+                }
+            }
+        }
+        return sharedNeighbours <= sharedTriangles;
+    }
+
+    bool flipsTriangle(const std::vector<uint32_t> &indices, const VertexTriangles &around, uint32_t a,
+                       uint32_t b) const {
+        for (uint32_t i = around.offsets[a]; i < around.offsets[a + 1]; i++) {
+            const uint32_t *corners = &indices[3 * around.triangles[i]];
+            if (corners[0] == b || corners[1] == b || corners[2] == b) continue;
+
+            glm::vec3 before[3];
+            glm::vec3 after[3];
+            for (int c = 0; c < 3; c++) {
+                before[c] = vertices[corners[c]].position;
+                after[c] = corners[c] == a ? vertices[b].position : before[c];
+            }
+            glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+            glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+            float lengths = glm::length(normalBefore) * glm::length(normalAfter);
+            if (glm::dot(normalBefore, normalAfter) <= MIN_NORMAL_COSINE * lengths) return true;
+        }
+        return false;
+    }
+
+    const std::vector<LveVertex> &vertices;
+    std::vector<uint32_t> wedge;
+    std::vector<uint32_t> wedgeNext;
+    std::vector<VertexKind> kinds;
+    std::vector<Quadric> quadrics;
+    std::vector<uint32_t> stamps;
+    uint32_t currentStamp = 0;
+    // vertex of the simplified mesh each source vertex was collapsed onto, itself when it didn't move
+    std::vector<uint32_t> movedTo;
+};
+
+}  // namespace
+
+std::vector<uint32_t> simplifyMesh(const std::vector<LveVertex> &vertices, const std::vector<uint32_t> &indices,
+                                   size_t targetIndexCount, float maxError, float *error) {
+    std::vector<uint32_t> result = indices;
+    targetIndexCount -= targetIndexCount % 3;
+    double maxCost = static_cast<double>(maxError) * static_cast<double>(maxError);
+
+    Simplifier simplifier{vertices, indices};
+    while (result.size() > targetIndexCount) {
+        if (!simplifier.collapsePass(result, result.size() - targetIndexCount, maxCost)) break;
+    }
+
+    if (error != nullptr) *error = simplifier.measureDeviation(indices, result);
+    return result;
+}
+
+}  // namespace lve
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "lve_vertex_format.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace lve {
+
+/*
+ * Quadric error edge collapse (Garland & Heckbert 1997) used to build the LOD chain of a model at import.
+ *
+ * A collapse moves a vertex onto one of its neighbours, so the simplified mesh is only a new index list over the same
+ * vertices and every LOD shares the vertex buffer. Vertices sharing their position with others (uv or normal seams)
+ * and non-manifold vertices never move, border vertices only slide along the border : seams and outlines stay where
+ * they are, at the cost of a floor on how far a mesh full of seams can be reduced.
+ *
+ * Collapses are applied in passes of independent edges sorted by cost, ties broken by vertex index, so the result
+ * only depends on the input.
+ */
+
+// Simplified indices over the same vertices, at most targetIndexCount unless collapsing further isn't possible or
+// would cost more than maxError, as estimated by the quadrics. error receives the deviation measured at the source
+// vertices instead : the largest distance from a vertex of the input to the simplified surface, in model units. Points
+// inside the source triangles and the distance back from the simplified surface aren't measured, it isn't a bound
+std::vector<uint32_t> simplifyMesh(const std::vector<LveVertex> &vertices, const std::vector<uint32_t> &indices,
+                                   size_t targetIndexCount, float maxError = std::numeric_limits<float>::max(),
+                                   float *error = nullptr);
+
+}  // namespace lve
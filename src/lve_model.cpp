@@ -1,113 +1,150 @@
 #include "lve_model.hpp"
 
-#include "lve_descriptor.hpp"
-#include "lve_swap_chain.hpp"
 #include "lve_texture.hpp"
-#include "lve_utils.hpp"
-
-// libs
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tiny_obj_loader.h>
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
 
 // std
 #include <cassert>
 #include <cstring>
+#include <exception>
+#include <filesystem>
 #include <iostream>
-#include <unordered_map>
 
 #ifndef ENGINE_DIR
 #define ENGINE_DIR "../"
 #endif
 
-namespace std {
-template <>
-struct hash<lve::LveModel::Vertex> {
-    size_t operator()(lve::LveModel::Vertex const &vertex) const {
-        size_t seed = 0;
-        lve::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
-        return seed;
-    }
-};
-}  // namespace std
-
 namespace lve {
 
 LveModel::LveModel(LveDevice &device, const LveModel::Builder &builder) : lveDevice{device} {
-    createVertexBuffers(builder.vertices);
-    createIndexBuffers(builder.indices);
+    createVertexBuffers(builder.vertices.data(), sizeof(Vertex), static_cast<uint32_t>(builder.vertices.size()));
+    createIndexBuffers(builder.indices.data(), static_cast<uint32_t>(builder.indices.size()));
+    lods = builder.lods;
+    if (lods.empty()) lods.push_back(LveMeshLod{0, indexCount, 0.f, 0});
+    builder.computeBounds(boundsMin, boundsMax);
+}
+
+LveModel::LveModel(LveDevice &device, const LveMeshContainer &container)
+    : lveDevice{device}, vertexFormat{container.vertexFormat} {
+    assert(container.vertexStride == vertexStride(vertexFormat) && "mesh container stride doesn't match its format");
+    // the blobs go from the file mapping to the staging memory, no intermediate copy
+    createVertexBuffers(container.vertexData(), container.vertexStride, container.vertexCount);
+    createIndexBuffers(container.indexData(), container.indexCount);
+    lods = container.lods;
+    boundsMin = {container.boundsMin[0], container.boundsMin[1], container.boundsMin[2]};
+    boundsMax = {container.boundsMax[0], container.boundsMax[1], container.boundsMax[2]};
 }
 
 LveModel::~LveModel() {}
 
-std::unique_ptr<LveModel> LveModel::createModelFromFile(LveDevice &device, const std::string &filepath) {
+std::unique_ptr<LveModel> LveModel::createModelFromFile(LveDevice &device, const std::string &filepath,
+                                                        LveVertexFormat format, bool generateLods) {
+    std::string sourcePath = ENGINE_DIR + filepath;
+    std::string cachePath = LveMeshContainer::cachePath(sourcePath, format, generateLods);
+
+    // the baked container next to the model first, then the one an earlier import left in the cache
+    for (const std::string &containerPath :
+         {LveMeshContainer::containerPath(sourcePath, format, generateLods), cachePath}) {
+        std::error_code error;
+        if (!std::filesystem::exists(containerPath, error)) continue;
+        try {
+            LveMeshContainer container = LveMeshContainer::map(containerPath);
+            if (container.vertexFormat == format && container.vertexStride == vertexStride(format) &&
+                (generateLods || container.lods.size() == 1) && container.matchesSource(sourcePath, containerPath)) {
+                return std::make_unique<LveModel>(device, container);
+            }
+        } catch (const std::exception &) {
+            // older version or corrupted : imported again below, the cache entry is replaced
+        }
+    }
+
     Builder builder{};
-    builder.loadModel(ENGINE_DIR + filepath);
-    return std::make_unique<LveModel>(device, builder);
+    builder.loadModel(sourcePath);
+    builder.optimize();
+    if (generateLods) builder.generateLods();
+    // uploaded from the container even when it can't be written, the packed formats are only encoded there
+    LveMeshContainer container = builder.toContainer(sourcePath, format);
+    try {
+        std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path());
+        container.save(cachePath);
+    } catch (const std::exception &e) {
+        std::cerr << "mesh cache : " << e.what() << std::endl;
+    }
+    return std::make_unique<LveModel>(device, container);
 }
 
-void LveModel::createVertexBuffers(const std::vector<Vertex> &vertices) {
-    vertexCount = static_cast<uint32_t>(vertices.size());
-    assert(vertexCount >= 3 && "Vertex count must be at least 3");
-    VkDeviceSize bufferSize = sizeof(vertices[0]) * vertexCount;
-    uint32_t vertexSize = sizeof(vertices[0]);
+glm::vec3 LveModel::getPositionOffset() const {
+    return vertexFormat == LveVertexFormat::Full ? glm::vec3{0.f} : boundsMin;
+}
 
-    LveBuffer stagingBuffer{
-        lveDevice,
-        vertexSize,
-        vertexCount,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-    };
+glm::vec3 LveModel::getPositionScale() const {
+    return vertexFormat == LveVertexFormat::Full ? glm::vec3{1.f} : boundsMax - boundsMin;
+}
+
+void LveModel::createVertexBuffers(const void *vertices, uint32_t stride, uint32_t vertexCount) {
+    this->vertexCount = vertexCount;
+    assert(vertexCount >= 3 && "Vertex count must be at least 3");
+    VkDeviceSize bufferSize = static_cast<VkDeviceSize>(stride) * vertexCount;
+    uint32_t vertexSize = stride;
 
-    stagingBuffer.map();
-    stagingBuffer.writeToBuffer((void *)vertices.data());
+    LveUploadBatcher &uploadBatcher = lveDevice.getUploadBatcher();
+    LveBufferRange staging = uploadBatcher.stage(vertices, bufferSize);
 
     vertexBuffer = std::make_unique<LveBuffer>(lveDevice, vertexSize, vertexCount,
                                                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, LveMemoryCategory::Mesh);
 
-    lveDevice.copyBuffer(stagingBuffer.getBuffer(), vertexBuffer->getBuffer(), bufferSize);
+    uploadBatcher.copyBuffer(staging, vertexBuffer->getBuffer());
+    uploadToken = uploadBatcher.currentToken();
 }
 
-void LveModel::createIndexBuffers(const std::vector<uint32_t> &indices) {
-    indexCount = static_cast<uint32_t>(indices.size());
+void LveModel::createIndexBuffers(const uint32_t *indices, uint32_t indexCount) {
+    this->indexCount = indexCount;
     hasIndexBuffer = indexCount > 0;
 
     if (!hasIndexBuffer) {
         return;
     }
 
-    VkDeviceSize bufferSize = sizeof(indices[0]) * indexCount;
-    uint32_t indexSize = sizeof(indices[0]);
+    VkDeviceSize bufferSize = sizeof(uint32_t) * indexCount;
+    uint32_t indexSize = sizeof(uint32_t);
 
-    LveBuffer stagingBuffer{
-        lveDevice,
-        indexSize,
-        indexCount,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-    };
-
-    stagingBuffer.map();
-    stagingBuffer.writeToBuffer((void *)indices.data());
+    LveUploadBatcher &uploadBatcher = lveDevice.getUploadBatcher();
+    LveBufferRange staging = uploadBatcher.stage(indices, bufferSize);
 
     indexBuffer = std::make_unique<LveBuffer>(lveDevice, indexSize, indexCount,
                                               VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+                                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, LveMemoryCategory::Mesh);
 
-    lveDevice.copyBuffer(stagingBuffer.getBuffer(), indexBuffer->getBuffer(), bufferSize);
+    uploadBatcher.copyBuffer(staging, indexBuffer->getBuffer());
+    uploadToken = uploadBatcher.currentToken();
 }
 
-void LveModel::draw(VkCommandBuffer commandBuffer) {
+void LveModel::draw(VkCommandBuffer commandBuffer, uint32_t firstInstance, uint32_t lod) {
     if (hasIndexBuffer) {
-        vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+        assert(lod < lods.size() && "LOD out of range");
+        vkCmdDrawIndexed(commandBuffer, lods[lod].indexCount, 1, lods[lod].indexOffset, 0, firstInstance);
     } else {
-        vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0);
+        vkCmdDraw(commandBuffer, vertexCount, 1, 0, firstInstance);
     }
 }
 
+uint32_t LveModel::selectLod(const LveCamera &camera, const glm::mat4 &modelMatrix, float viewportHeight,
+                             float maxPixelError) const {
+    if (lods.size() < 2) return 0;
+
+    float scale = glm::max(glm::length(glm::vec3{modelMatrix[0]}),
+                           glm::max(glm::length(glm::vec3{modelMatrix[1]}), glm::length(glm::vec3{modelMatrix[2]})));
+    glm::vec3 center = glm::vec3{modelMatrix * glm::vec4{(boundsMin + boundsMax) * .5f, 1.f}};
+    float radius = glm::length(boundsMax - boundsMin) * .5f * scale;
+    float distance = glm::length(center - camera.getPosition()) - radius;
+    float pixelsPerUnit = camera.getPixelsPerUnit(distance, viewportHeight) * scale;
+
+    for (uint32_t lod = static_cast<uint32_t>(lods.size()) - 1; lod > 0; lod--) {
+        if (lods[lod].error * pixelsPerUnit <= maxPixelError) return lod;
+    }
+    return 0;
+}
+
 void LveModel::bind(VkCommandBuffer commandBuffer) {
     VkBuffer buffers[] = {vertexBuffer->getBuffer()};
     VkDeviceSize offsets[] = {0};
@@ -118,99 +155,4 @@ void LveModel::bind(VkCommandBuffer commandBuffer) {
     }
 }
 
-std::vector<VkVertexInputBindingDescription> LveModel::Vertex::getBindingDescriptions() {
-    std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
-    bindingDescriptions[0].binding = 0;
-    bindingDescriptions[0].stride = sizeof(Vertex);
-    bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-    return bindingDescriptions;
-}
-
-std::vector<VkVertexInputAttributeDescription> LveModel::Vertex::getAttributeDescriptions() {
-    std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
-
-    attributeDescriptions.push_back({0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, position)});
-    attributeDescriptions.push_back({1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, color)});
-    attributeDescriptions.push_back({2, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, normal)});
-    attributeDescriptions.push_back({3, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, uv)});
-
-    return attributeDescriptions;
-}
-
-void LveModel::Builder::loadModel(const std::string &filepath) {
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warn, err;
-
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath.c_str())) {
-        throw std::runtime_error(warn + err);
-    }
-
-    vertices.clear();
-    indices.clear();
-
-    std::unordered_map<Vertex, uint32_t> uniqueVertices{};
-    for (const auto &shape : shapes) {
-        for (const auto &index : shape.mesh.indices) {
-            Vertex vertex{};
-
-            if (index.vertex_index >= 0) {
-                vertex.position = {
-                    attrib.vertices[3 * index.vertex_index + 0],
-                    attrib.vertices[3 * index.vertex_index + 1],
-                    attrib.vertices[3 * index.vertex_index + 2],
-                };
-
-                vertex.color = {
-                    attrib.colors[3 * index.vertex_index + 0],
-                    attrib.colors[3 * index.vertex_index + 1],
-                    attrib.colors[3 * index.vertex_index + 2],
-                };
-            }
-
-            if (index.normal_index >= 0) {
-                vertex.normal = {
-                    attrib.normals[3 * index.normal_index + 0],
-                    attrib.normals[3 * index.normal_index + 1],
-                    attrib.normals[3 * index.normal_index + 2],
-                };
-            }
-
-            if (index.texcoord_index >= 0) {
-                vertex.uv = {
-                    attrib.texcoords[2 * index.texcoord_index + 0],
-                    attrib.texcoords[2 * index.texcoord_index + 1],
-                };
-            }
-
-            if (uniqueVertices.count(vertex) == 0) {
-                uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                vertices.push_back(vertex);
-            }
-            indices.push_back(uniqueVertices[vertex]);
-        }
-    }
-}
-
-void LveModel::createDescriptorSet(LveDevice &lveDevice, LveTexture *texture,
-                                   LveDescriptorSetLayout *textureSetLayout) {
-    if (textureSetLayout == nullptr) {
-        textureSetLayout = LveDescriptorSetLayout::defaultTextureSetLayout.get();
-    }
-
-    texturePool = LveDescriptorPool::Builder(lveDevice)
-                      .setMaxSets(1)
-                      .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, LveSwapChain::MAX_FRAMES_IN_FLIGHT)
-                      .build();
-
-    VkDescriptorImageInfo imageDescriptorInfo{};
-    imageDescriptorInfo.sampler = texture->getSampler();
-    imageDescriptorInfo.imageView = texture->getImageView();
-    imageDescriptorInfo.imageLayout = texture->getImageLayout();
-    LveDescriptorWriter(*textureSetLayout, *texturePool)
-        .writeImage(0, &imageDescriptorInfo)
-        .build(textureDescriptorSet);
-}
-
 }  // namespace lve
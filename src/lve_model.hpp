@@ -1,9 +1,14 @@
 #pragma once
 
 #include "lve_buffer.hpp"
+#include "lve_camera.hpp"
 #include "lve_descriptor.hpp"
 #include "lve_device.hpp"
+#include "lve_mesh_builder.hpp"
+#include "lve_mesh_container.hpp"
 #include "lve_texture.hpp"
+#include "lve_upload_batcher.hpp"
+#include "lve_vertex_format.hpp"
 // libs
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -16,54 +21,68 @@
 namespace lve {
 class LveModel {
    public:
-    struct Vertex {
-        glm::vec3 position{};
-        glm::vec3 color{};
-        glm::vec3 normal{};
-        glm::vec2 uv{};
-
-        static std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
-        static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
-
-        bool operator==(const Vertex &other) const {
-            return position == other.position && color == other.color && normal == other.normal && uv == other.uv;
-        }
-    };
-
-    struct Builder {
-        std::vector<Vertex> vertices{};
-        std::vector<uint32_t> indices{};
-
-        void loadModel(const std::string &filepath);
-    };
+    using Vertex = LveVertex;
+    using Builder = LveMeshBuilder;
 
     LveModel(LveDevice &device, const LveModel::Builder &builder);
+    // Stages the blobs of the container as they are, in its vertex format
+    LveModel(LveDevice &device, const LveMeshContainer &container);
     ~LveModel();
 
     LveModel(const LveModel &) = delete;
     LveModel &operator=(const LveModel &) = delete;
 
-    static std::unique_ptr<LveModel> createModelFromFile(LveDevice &device, const std::string &filepath);
+    // An up to date .lvemesh of the same vertex format, baked next to the model or left in MESH_CACHE_DIR by an
+    // earlier import, is mapped instead of parsing the model. One is written to the cache after each import (a failed
+    // write is reported and ignored). Without generateLods the model only holds LOD 0, for meshes never drawn
+    // through selectLod
+    static std::unique_ptr<LveModel> createModelFromFile(LveDevice &device, const std::string &filepath,
+                                                         LveVertexFormat format = LveVertexFormat::Full,
+                                                         bool generateLods = true);
 
     void bind(VkCommandBuffer commandBuffer);
-    void draw(VkCommandBuffer commandBuffer);
-
-    void createDescriptorSet(LveDevice &lveDevice, LveTexture *texture, LveDescriptorSetLayout *textureSetLayout);
-
-    std::unique_ptr<LveDescriptorPool> texturePool;
-    VkDescriptorSet textureDescriptorSet;
+    // firstInstance reaches the shaders as gl_InstanceIndex, used to index the object buffer. lod is an index of
+    // getLods(), all of them share the bound buffers
+    void draw(VkCommandBuffer commandBuffer, uint32_t firstInstance = 0, uint32_t lod = 0);
+
+    // Finest first, at least one
+    const std::vector<LveMeshLod> &getLods() const { return lods; }
+    // Coarsest LOD whose error stays under maxPixelError pixels on screen, for the model placed by modelMatrix. The
+    // error is projected at the point of the bounding sphere nearest to the camera so it holds over the whole model,
+    // and by distance rather than depth so turning the camera doesn't switch LODs
+    uint32_t selectLod(const LveCamera &camera, const glm::mat4 &modelMatrix, float viewportHeight,
+                       float maxPixelError) const;
+
+    // Completes once the vertex and index data have reached device memory
+    LveUploadBatcher::Token getUploadToken() const { return uploadToken; }
+    // Model space box of the vertex positions
+    const glm::vec3 &getBoundsMin() const { return boundsMin; }
+    const glm::vec3 &getBoundsMax() const { return boundsMax; }
+
+    // Layout of the vertex buffer, the render systems bind the pipeline made for it
+    LveVertexFormat getVertexFormat() const { return vertexFormat; }
+    // model space position = offset + scale * stored position (quantized in the bounds for the packed formats)
+    glm::vec3 getPositionOffset() const;
+    glm::vec3 getPositionScale() const;
 
    private:
-    void createVertexBuffers(const std::vector<Vertex> &vertices);
-    void createIndexBuffers(const std::vector<uint32_t> &indices);
+    void createVertexBuffers(const void *vertices, uint32_t stride, uint32_t vertexCount);
+    void createIndexBuffers(const uint32_t *indices, uint32_t indexCount);
 
     LveDevice &lveDevice;
 
+    LveVertexFormat vertexFormat = LveVertexFormat::Full;
     std::unique_ptr<LveBuffer> vertexBuffer;
     uint32_t vertexCount;
 
     bool hasIndexBuffer = false;
     std::unique_ptr<LveBuffer> indexBuffer;
     uint32_t indexCount;
+    std::vector<LveMeshLod> lods;
+
+    glm::vec3 boundsMin{0.f};
+    glm::vec3 boundsMax{0.f};
+
+    LveUploadBatcher::Token uploadToken = 0;
 };
 }  // namespace lve
@@ -0,0 +1,44 @@
+#include "lve_object_buffer.hpp"
+
+// std
+#include <stdexcept>
+
+namespace lve {
+
+LveObjectBuffer::LveObjectBuffer(LveDevice &device, uint32_t frameCount, uint32_t maxObjects)
+    : maxObjects{maxObjects} {
+    objectBuffer = std::make_unique<LveBuffer>(
+        device, sizeof(ObjectData) * maxObjects, frameCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        device.properties.limits.minStorageBufferOffsetAlignment, LveMemoryCategory::FrameRing);
+    if (objectBuffer->map() != VK_SUCCESS) {
+        throw std::runtime_error("failed to map object buffer!");
+    }
+}
+
+void LveObjectBuffer::update(int frameIndex, LveGameObject::Map &gameObjects) {
+    // written in place, the buffer stays mapped
+    ObjectData *entries = reinterpret_cast<ObjectData *>(static_cast<char *>(objectBuffer->getMappedMemory()) +
+                                                         getDynamicOffset(frameIndex));
+
+    objectCount = 0;
+    for (auto &kv : gameObjects) {
+        auto &obj = kv.second;
+        if (obj.model == nullptr) continue;
+        if (objectCount == maxObjects) {
+            throw std::runtime_error("too many game objects for the object buffer!");
+        }
+
+        obj.objectIndex = objectCount;
+        entries[objectCount].modelMatrix = obj.transform.mat4();
+        entries[objectCount].normalMatrix = obj.transform.normalMatrix();
+        entries[objectCount].positionOffset = glm::vec4{obj.model->getPositionOffset(), 0.f};
+        entries[objectCount].positionScale = glm::vec4{obj.model->getPositionScale(), 0.f};
+        entries[objectCount].textureIndex =
+            obj.texture != nullptr ? obj.texture->getBindlessIndex() : LveBindlessTable::NO_TEXTURE;
+        objectCount++;
+    }
+    objectBuffer->flushIndex(frameIndex);
+}
+
+}  // namespace lve
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "lve_bindless_table.hpp"
+#include "lve_buffer.hpp"
+#include "lve_device.hpp"
+#include "lve_game_object.hpp"
+
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+#include <memory>
+
+namespace lve {
+
+// std430 layout of ObjectBuffer in the shaders (set 0, binding 1)
+struct ObjectData {
+    glm::mat4 modelMatrix{1.f};
+    glm::mat4 normalMatrix{1.f};
+    // LveModel::getPositionOffset / getPositionScale, xyz only
+    glm::vec4 positionOffset{0.f};
+    glm::vec4 positionScale{1.f};
+    // slot of the object's texture in the bindless table, LveBindlessTable::NO_TEXTURE without texture
+    uint32_t textureIndex = LveBindlessTable::NO_TEXTURE;
+    uint32_t padding[3]{};  // the array stride is rounded up to the mat4 alignment
+};
+static_assert(sizeof(ObjectData) % 16 == 0, "ObjectData must match the std430 array stride");
+
+/*
+ * Per frame storage buffer holding the transform of every drawable game object, read by the shaders
+ * through a dynamic offset on the global descriptor set. Each frame in flight owns one instance of the
+ * buffer. update fills it in a single pass and stores the entry index in LveGameObject::objectIndex, so
+ * a draw only has to pass that index as its first instance.
+ */
+class LveObjectBuffer {
+   public:
+    static constexpr uint32_t DEFAULT_MAX_OBJECTS = 1024;
+
+    LveObjectBuffer(LveDevice &device, uint32_t frameCount, uint32_t maxObjects = DEFAULT_MAX_OBJECTS);
+
+    LveObjectBuffer(const LveObjectBuffer &) = delete;
+    LveObjectBuffer &operator=(const LveObjectBuffer &) = delete;
+
+    // Writes the entries of the frame, the previous frame that used frameIndex must be complete
+    void update(int frameIndex, LveGameObject::Map &gameObjects);
+
+    // Descriptor of one frame's instance, to write as a VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC
+    VkDescriptorBufferInfo descriptorInfo() { return objectBuffer->descriptorInfoForIndex(0); }
+    uint32_t getDynamicOffset(int frameIndex) const {
+        return static_cast<uint32_t>(objectBuffer->getAlignmentSize() * frameIndex);
+    }
+    uint32_t getObjectCount() const { return objectCount; }
+
+   private:
+    std::unique_ptr<LveBuffer> objectBuffer;
+    uint32_t maxObjects;
+    uint32_t objectCount = 0;
+};
+
+}  // namespace lve
@@ -19,8 +19,6 @@ LvePostProcessingManager::LvePostProcessingManager(LveDevice &lveDevice, VkExten
     createDescriptorSet(depthImageViews, depthSamplers);
 
     createImageBarrier();
-
-    createSyncObjects();
 }
 
 LvePostProcessingManager::LvePostProcessingManager(VkExtent2D windowExtent,
@@ -37,17 +35,10 @@ LvePostProcessingManager::LvePostProcessingManager(VkExtent2D windowExtent,
     createDescriptorSet(depthImageViews, depthSamplers);
 
     createImageBarrier();
-
-    createSyncObjects();
-}
-
-LvePostProcessingManager::~LvePostProcessingManager() {
-    for (size_t i = 0; i < LveSwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
-        vkDestroySemaphore(lveDevice.device(), computeFinishedSemaphores[i], nullptr);
-    }
 }
 
 void LvePostProcessingManager::createTexture() {
+    LveMemoryScope memoryScope{LveMemoryCategory::PostProcess};
     textures.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT * 2);
     for (int i = 0; i < LveSwapChain::MAX_FRAMES_IN_FLIGHT * 2; i++) {
         textures[i] = std::make_unique<LveTexture>(lveDevice, windowExtent.width, windowExtent.height);
@@ -110,9 +101,11 @@ void LvePostProcessingManager::addPostProcessing(std::shared_ptr<LveIPostProcess
 
 void LvePostProcessingManager::clearPostProcessings() { postProcessings.clear(); }
 
-void LvePostProcessingManager::drawPostProcessings(FrameInfo frameInfo, VkImage swapChainImage, VkImage depthImage,
-                                                   SynchronisationObjects &syncObjects) {
-    copySwapChainImageToTexture(frameInfo, swapChainImage, textures[frameInfo.frameIndex * 2]->getTextureImage());
+void LvePostProcessingManager::drawPostProcessings(FrameInfo frameInfo, VkImage swapChainImage,
+                                                   VkImageLayout swapChainImageLayout, VkImage depthImage,
+                                                   LveFrameScheduler &scheduler) {
+    copySwapChainImageToTexture(frameInfo, swapChainImage, swapChainImageLayout,
+                                textures[frameInfo.frameIndex * 2]->getTextureImage());
 
     VkImageMemoryBarrier transferDestImageBarrier{};
     transferDestImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -143,7 +136,7 @@ void LvePostProcessingManager::drawPostProcessings(FrameInfo frameInfo, VkImage
         std::swap(texturesDescriptorSets[frameInfo.frameIndex].first,
                   texturesDescriptorSets[frameInfo.frameIndex].second);
     }
-    copyTextureToSwapChainImage(frameInfo, swapChainImage,
+    copyTextureToSwapChainImage(frameInfo, swapChainImage, swapChainImageLayout,
                                 textures[frameInfo.frameIndex * 2 + i % 2]->getTextureImage());
 
     transferDestImageBarrier = {};
@@ -163,40 +156,8 @@ void LvePostProcessingManager::drawPostProcessings(FrameInfo frameInfo, VkImage
         throw std::runtime_error("failed to record command buffer!");
     }
 
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-
-    VkSemaphore signalSemaphores[] = {computeFinishedSemaphores[frameInfo.frameIndex]};
-
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &frameInfo.postProcessingCommandBuffer;
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = signalSemaphores;
-    submitInfo.waitSemaphoreCount = syncObjects.semaphores.size();
-    submitInfo.pWaitSemaphores = syncObjects.semaphores.data();
-    ;
-    submitInfo.pWaitDstStageMask = waitStages;
-
-    if (vkQueueSubmit(lveDevice.graphicsQueue(), 1, &submitInfo, syncObjects.fences[0]) != VK_SUCCESS) {
-        throw std::runtime_error("failed to submit compute command buffer!");
-    }
-    syncObjects.fences.clear();
-    syncObjects.semaphores.clear();
-    syncObjects.semaphores.push_back(computeFinishedSemaphores[frameInfo.frameIndex]);
-}
-
-void LvePostProcessingManager::createSyncObjects() {
-    computeFinishedSemaphores.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
-    VkSemaphoreCreateInfo semaphoreInfo{};
-    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-
-    for (size_t i = 0; i < LveSwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
-        if (vkCreateSemaphore(lveDevice.device(), &semaphoreInfo, nullptr, &computeFinishedSemaphores[i]) !=
-            VK_SUCCESS) {
-            throw std::runtime_error("failed to create compute synchronization objects for a frame!");
-        }
-    }
+    scheduler.submit(LveFrameScheduler::POST_PROCESS, lveDevice.graphicsQueue(),
+                     &frameInfo.postProcessingCommandBuffer, 1);
 }
 
 void LvePostProcessingManager::createImageBarrier() {
@@ -216,6 +177,7 @@ void LvePostProcessingManager::createImageBarrier() {
 }
 
 void LvePostProcessingManager::copySwapChainImageToTexture(FrameInfo frameInfo, VkImage swapChainImage,
+                                                           VkImageLayout swapChainImageLayout,
                                                            VkImage postprocessingImage) {
     VkImageMemoryBarrier transferDestImageBarrier{};
     transferDestImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -230,7 +192,7 @@ void LvePostProcessingManager::copySwapChainImageToTexture(FrameInfo frameInfo,
     transferSwapChainImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     transferSwapChainImageBarrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;
     transferSwapChainImageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-    transferSwapChainImageBarrier.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    transferSwapChainImageBarrier.oldLayout = swapChainImageLayout;
     transferSwapChainImageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
     transferSwapChainImageBarrier.image = swapChainImage;
     transferSwapChainImageBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
@@ -268,6 +230,7 @@ void LvePostProcessingManager::copySwapChainImageToTexture(FrameInfo frameInfo,
 }
 
 void LvePostProcessingManager::copyTextureToSwapChainImage(FrameInfo frameInfo, VkImage swapChainImage,
+                                                           VkImageLayout swapChainImageLayout,
                                                            VkImage postprocessingImage) {
     VkImageMemoryBarrier transferDestImageBarrier{};
     transferDestImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -319,7 +282,7 @@ void LvePostProcessingManager::copyTextureToSwapChainImage(FrameInfo frameInfo,
     transferBackSwapchainImageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
     transferBackSwapchainImageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
     transferBackSwapchainImageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    transferBackSwapchainImageBarrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    transferBackSwapchainImageBarrier.newLayout = swapChainImageLayout;
     transferBackSwapchainImageBarrier.image = swapChainImage;
     transferBackSwapchainImageBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
 
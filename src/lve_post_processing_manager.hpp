@@ -4,7 +4,7 @@
 #include "lve_texture.hpp"
 #include "systems/lve_Ipost_processing.hpp"
 #include "lve_frame_info.hpp"
-#include "lve_utils.hpp"
+#include "lve_frame_scheduler.hpp"
 
 #include <memory>
 #include <vector>
@@ -17,25 +17,25 @@ namespace lve
   public:
     LvePostProcessingManager(LveDevice &deviceRef, VkExtent2D windowExtent, std::vector<VkImageView> depthImageViews, std::vector<VkSampler> depthSamplers);
     LvePostProcessingManager(VkExtent2D windowExtent,LvePostProcessingManager &postProcessingManager, std::vector<VkImageView> depthImageViews, std::vector<VkSampler> depthSamplers);
-    ~LvePostProcessingManager();
     
     void createTexture();
     void createDescriptorPool();
     void createDescriptorSet(std::vector<VkImageView> depthImageViews, std::vector<VkSampler> depthSamplers);
-    void createSyncObjects();
     void createImageBarrier();
 
     void addPostProcessing(std::shared_ptr<LveIPostProcessing> postProcessing);
     
     void clearPostProcessings();
 
-    void drawPostProcessings(FrameInfo frameInfo, VkImage swapChainImage, VkImage depthImage, SynchronisationObjects &syncObjects);
+    // swapChainImageLayout is the layout the render pass leaves the color image in, and the one it is given back in
+    void drawPostProcessings(FrameInfo frameInfo, VkImage swapChainImage, VkImageLayout swapChainImageLayout,
+                             VkImage depthImage, LveFrameScheduler &scheduler);
 
-    void copySwapChainImageToTexture(FrameInfo frameInfo, VkImage swapChainImage, VkImage postprocessingImage);
+    void copySwapChainImageToTexture(FrameInfo frameInfo, VkImage swapChainImage, VkImageLayout swapChainImageLayout,
+                                     VkImage postprocessingImage);
 
-    void copyTextureToSwapChainImage(FrameInfo frameInfo, VkImage swapChainImage, VkImage postprocessingImage);
-
-    VkSemaphore getComputeSemaphore(int frame_index) const {return computeFinishedSemaphores[frame_index];};
+    void copyTextureToSwapChainImage(FrameInfo frameInfo, VkImage swapChainImage, VkImageLayout swapChainImageLayout,
+                                     VkImage postprocessingImage);
 
 
 
@@ -48,7 +48,6 @@ namespace lve
     std::vector<std::pair<VkDescriptorSet, VkDescriptorSet>> texturesDescriptorSets;
     std::vector<std::shared_ptr<LveIPostProcessing>> postProcessings;
     std::vector<VkImageMemoryBarrier> imagesBarriers;
-    std::vector<VkSemaphore> computeFinishedSemaphores;
     std::vector<VkDescriptorSet> depthDescriptorSets;
     
   };
@@ -1,17 +1,10 @@
 #include "lve_pre_processing_manager.hpp"
 
 #include <iostream>
-
-#include "lve_swap_chain.hpp"
+#include <stdexcept>
 
 namespace lve {
-LvePreProcessingManager::LvePreProcessingManager(LveDevice &lveDevice) : lveDevice{lveDevice} { createSyncObjects(); }
-
-LvePreProcessingManager::~LvePreProcessingManager() {
-    for (size_t i = 0; i < LveSwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
-        vkDestroySemaphore(lveDevice.device(), computeFinishedSemaphores[i], nullptr);
-    }
-}
+LvePreProcessingManager::LvePreProcessingManager(LveDevice &lveDevice) : lveDevice{lveDevice} {}
 
 void LvePreProcessingManager::addPreProcessing(std::shared_ptr<LveIPreProcessing> postProcessing) {
     preProcessings.push_back(postProcessing);
@@ -19,47 +12,43 @@ void LvePreProcessingManager::addPreProcessing(std::shared_ptr<LveIPreProcessing
 
 void LvePreProcessingManager::clearPreProcessings() { preProcessings.clear(); }
 
-void LvePreProcessingManager::executePreprocessing(FrameInfo frameInfo, SynchronisationObjects &syncObjects) {
+void LvePreProcessingManager::executePreprocessing(FrameInfo frameInfo, LveFrameScheduler &scheduler) {
     int i;
     for (i = 0; i < preProcessings.size(); i++) {
         preProcessings[i]->executePreCpS(frameInfo);
     }
+    for (i = 0; i < preProcessings.size(); i++) {
+        preProcessings[i]->releaseOutputs(frameInfo);
+    }
 
     if (vkEndCommandBuffer(frameInfo.preProcessingCommandBuffer) != VK_SUCCESS) {
         throw std::runtime_error("failed to record command buffer!");
     }
 
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-
-    VkSemaphore signalSemaphores[] = {computeFinishedSemaphores[frameInfo.frameIndex]};
-
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &frameInfo.preProcessingCommandBuffer;
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = signalSemaphores;
-    submitInfo.waitSemaphoreCount = syncObjects.semaphores.size();
-    submitInfo.pWaitSemaphores = syncObjects.semaphores.data();
-    submitInfo.pWaitDstStageMask = waitStages;
-
-    if (vkQueueSubmit(lveDevice.graphicsQueue(), 1, &submitInfo, nullptr) != VK_SUCCESS) {
-        throw std::runtime_error("failed to submit compute command buffer!");
+    if (lveDevice.hasDedicatedComputeQueue()) {
+        // the uploads recorded so far go out now so the compute queue can wait on them on the GPU, only frames
+        // following new uploads (mostly the first one) wait at all
+        LveUploadBatcher &uploadBatcher = lveDevice.getUploadBatcher();
+        LveUploadBatcher::Token uploadToken = uploadBatcher.submit();
+        if (uploadToken > syncedUploadToken) {
+            scheduler.addTimelineWait(LveFrameScheduler::PRE_PROCESS, uploadBatcher.getTimeline(), uploadToken,
+                                      VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+            syncedUploadToken = uploadToken;
+        }
     }
-    syncObjects.semaphores.clear();
-    syncObjects.semaphores.push_back(computeFinishedSemaphores[frameInfo.frameIndex]);
-}
 
-void LvePreProcessingManager::createSyncObjects() {
-    computeFinishedSemaphores.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
-    VkSemaphoreCreateInfo semaphoreInfo{};
-    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    // The simulation doesn't touch the swap chain image, so it doesn't wait on the acquire : on a dedicated
+    // compute queue it starts as soon as it is submitted and overlaps the previous frame's rendering
+    scheduler.submit(LveFrameScheduler::PRE_PROCESS, lveDevice.computeQueue(), &frameInfo.preProcessingCommandBuffer,
+                     1);
+    // the frame waits on both the acquired image and the simulation, which is sampled by the water shaders and
+    // read by the transfers building the output mip chains
+    scheduler.addDependency(LveFrameScheduler::GRAPHICS, LveFrameScheduler::PRE_PROCESS,
+                            VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                VK_PIPELINE_STAGE_TRANSFER_BIT);
 
-    for (size_t i = 0; i < LveSwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
-        if (vkCreateSemaphore(lveDevice.device(), &semaphoreInfo, nullptr, &computeFinishedSemaphores[i]) !=
-            VK_SUCCESS) {
-            throw std::runtime_error("failed to create compute synchronization objects for a frame!");
-        }
+    for (i = 0; i < preProcessings.size(); i++) {
+        preProcessings[i]->acquireOutputs(frameInfo);
     }
 }
 }  // namespace lve
\ No newline at end of file
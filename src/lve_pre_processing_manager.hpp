@@ -4,28 +4,25 @@
 
 #include "lve_device.hpp"
 #include "lve_frame_info.hpp"
-#include "lve_utils.hpp"
+#include "lve_frame_scheduler.hpp"
+#include "lve_upload_batcher.hpp"
 #include "systems/lve_Ipre_processing.hpp"
 
 namespace lve {
 class LvePreProcessingManager {
    public:
     LvePreProcessingManager(LveDevice &deviceRef);
-    ~LvePreProcessingManager();
-
-    void createSyncObjects();
 
     void addPreProcessing(std::shared_ptr<LveIPreProcessing> preProcessing);
 
     void clearPreProcessings();
 
-    void executePreprocessing(FrameInfo frameInfo, SynchronisationObjects &syncObjects);
-
-    VkSemaphore getComputeSemaphore(int frame_index) const { return computeFinishedSemaphores[frame_index]; };
+    void executePreprocessing(FrameInfo frameInfo, LveFrameScheduler &scheduler);
 
    private:
     LveDevice &lveDevice;
     std::vector<std::shared_ptr<LveIPreProcessing>> preProcessings;
-    std::vector<VkSemaphore> computeFinishedSemaphores;
+    // last upload batch a compute submit waited on, its trailing barrier only covers the graphics queue
+    LveUploadBatcher::Token syncedUploadToken = 0;
 };
 }  // namespace lve
\ No newline at end of file
@@ -11,6 +11,7 @@
 
 #include "lve_device.hpp"
 #include "lve_swap_chain.hpp"
+#include "lve_upload_batcher.hpp"
 #include "lve_utils.hpp"
 #include "lve_window.hpp"
 #include "systems/lve_Ipost_processing.hpp"
@@ -28,12 +29,19 @@ LveRenderer::LveRenderer(LveWindow &window, LveDevice &device) : lveWindow{windo
     setLayoutBuilder->addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT);
     LveDescriptorSetLayout::depthTextureSetLayout = setLayoutBuilder->build();
 
+    frameScheduler = std::make_unique<LveFrameScheduler>(lveDevice, LveSwapChain::MAX_FRAMES_IN_FLIGHT);
     recreateSwapChain();
 
     preProcessingManager = std::make_unique<LvePreProcessingManager>(lveDevice);
     createCommandBuffers();
+
+    frameRing = std::make_unique<LveFrameRing>(lveDevice, LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+    lveDevice.getUploadBatcher().setFrameRing(frameRing.get());
+}
+LveRenderer::~LveRenderer() {
+    lveDevice.getUploadBatcher().setFrameRing(nullptr);
+    freeCommandBuffers();
 }
-LveRenderer::~LveRenderer() { freeCommandBuffers(); }
 
 void LveRenderer::recreateSwapChain() {
     auto extent = lveWindow.getExtend();
@@ -42,7 +50,8 @@ void LveRenderer::recreateSwapChain() {
         glfwWaitEvents();
     }
 
-    vkDeviceWaitIdle(lveDevice.device());
+    // no device idle : the old swap chain and post processing resources go through the deletion queue and are
+    // destroyed once the frames still using them have retired
 
     if (lveSwapChain == nullptr) {
         lveSwapChain = std::make_unique<LveSwapChain>(lveDevice, extent);
@@ -64,62 +73,34 @@ void LveRenderer::recreateSwapChain() {
 }
 
 void LveRenderer::createCommandBuffers() {
-    commandBuffers.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
-
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = lveDevice.getCommandPool();
-    allocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
-
-    if (vkAllocateCommandBuffers(lveDevice.device(), &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate commande buffers!");
-    }
+    commandPools = std::make_unique<LveCommandPools>(lveDevice, LveSwapChain::MAX_FRAMES_IN_FLIGHT, RECORDING_THREADS);
 
+    // filled from the frame pools at the start of every frame
+    commandBuffers.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
     preProcessingBuffers.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
-
-    allocInfo = {};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = lveDevice.getCommandPool();
-    allocInfo.commandBufferCount = static_cast<uint32_t>(preProcessingBuffers.size());
-
-    if (vkAllocateCommandBuffers(lveDevice.device(), &allocInfo, preProcessingBuffers.data()) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate commande buffers!");
-    }
-
     postProcessingBuffers.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
-
-    allocInfo = {};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = lveDevice.getCommandPool();
-    allocInfo.commandBufferCount = static_cast<uint32_t>(postProcessingBuffers.size());
-
-    if (vkAllocateCommandBuffers(lveDevice.device(), &allocInfo, postProcessingBuffers.data()) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate commande buffers!");
-    }
 }
 
 void LveRenderer::freeCommandBuffers() {
-    vkFreeCommandBuffers(lveDevice.device(), lveDevice.getCommandPool(), static_cast<uint32_t>(commandBuffers.size()),
-                         commandBuffers.data());
     commandBuffers.clear();
-
-    vkFreeCommandBuffers(lveDevice.device(), lveDevice.getCommandPool(),
-                         static_cast<uint32_t>(preProcessingBuffers.size()), preProcessingBuffers.data());
     preProcessingBuffers.clear();
-
-    vkFreeCommandBuffers(lveDevice.device(), lveDevice.getCommandPool(),
-                         static_cast<uint32_t>(postProcessingBuffers.size()), postProcessingBuffers.data());
     postProcessingBuffers.clear();
+    commandPools.reset();
 }
 
-bool LveRenderer::startRendering(SynchronisationObjects &syncObjects) {
+bool LveRenderer::startRendering() {
     assert(!isFrameStarted && "Can't call beginFrame while already in progress");
-    auto result = lveSwapChain->acquireNextImage(&currentImageIndex, syncObjects);
+    // waits until the frame that last used this slot has been presented
+    frameScheduler->beginFrame();
+    currentFrameIndex = frameScheduler->getFrameSlot();
+    // POST_PROCESS follows GRAPHICS on the graphics queue : a frame it reached no longer uses any released object
+    lveDevice.getDeletionQueue().beginFrame(frameScheduler->getFrameNumber(),
+                                            frameScheduler->getCompletedValue(LveFrameScheduler::POST_PROCESS));
+
+    auto result = lveSwapChain->acquireNextImage(&currentImageIndex, *frameScheduler);
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+        frameScheduler->cancelFrame();
         recreateSwapChain();
         return false;
     }
@@ -127,11 +108,33 @@ bool LveRenderer::startRendering(SynchronisationObjects &syncObjects) {
     if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
         throw std::runtime_error("failed to acquire swap chain image!");
     }
+
+    // the slot's previous frame is retired : its pools are reset at once instead of buffer by buffer. POST_PROCESS is
+    // the last submit of that frame on the graphics queue (after GRAPHICS, itself after PRE_PROCESS), its command
+    // buffers are all done once it is reached whatever queue presented
+    uint64_t frameNumber = frameScheduler->getFrameNumber();
+    uint64_t framesInFlight = LveSwapChain::MAX_FRAMES_IN_FLIGHT;
+    if (frameNumber > framesInFlight) {
+        frameScheduler->waitFor(LveFrameScheduler::POST_PROCESS, frameNumber - framesInFlight);
+    }
+    commandPools->beginFrame(currentFrameIndex);
+    commandBuffers[currentFrameIndex] = commandPools->allocatePrimary();
+    // pre processing is submitted on the compute queue
+    preProcessingBuffers[currentFrameIndex] =
+        commandPools->allocatePrimary(0, LveCommandPools::QueueType::Compute);
+    postProcessingBuffers[currentFrameIndex] = commandPools->allocatePrimary();
+
+    // pending uploads go out ahead of this frame's command buffers, their trailing barrier orders them
+    lveDevice.getUploadBatcher().submit();
+
+    // the scheduler waited on the previous frame of this slot, so its ring region is free again
+    frameRing->beginFrame(currentFrameIndex);
+
     isFrameStarted = true;
     return true;
 }
 
-VkCommandBuffer LveRenderer::beginFrame(SynchronisationObjects &syncObjects) {
+VkCommandBuffer LveRenderer::beginFrame() {
     auto commandBuffer = getCurrentCommandBuffer();
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -141,19 +144,23 @@ VkCommandBuffer LveRenderer::beginFrame(SynchronisationObjects &syncObjects) {
     return commandBuffer;
 }
 
-void LveRenderer::endFrame(SynchronisationObjects &syncObjects) {
+void LveRenderer::endFrame() {
     assert(isFrameStarted && "Can't call endFrame while frame is not in progress");
     auto commandBuffer = getCurrentCommandBuffer();
     if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
         throw std::runtime_error("failed to record command buffer!");
     }
-    auto result = lveSwapChain->submitCommandBuffers(&commandBuffer, &currentImageIndex, syncObjects);
+    lveSwapChain->submitCommandBuffers(&commandBuffer, *frameScheduler);
 }
 
-void LveRenderer::presentFrame(SynchronisationObjects &syncObjects) {
-    // VkSemaphore postProssessingSemaphore = postProcessingManager->getComputeSemaphore(currentFrameIndex);
-    VkSemaphore postProssessingSemaphore = postProcessingManager->getComputeSemaphore(currentFrameIndex);
-    auto result = lveSwapChain->presentImage(&currentImageIndex, syncObjects);
+void LveRenderer::presentFrame() {
+    if (!pendingCapturePath.empty()) {
+        frameScheduler->waitFor(LveFrameScheduler::POST_PROCESS, frameScheduler->getFrameNumber());
+        lveSwapChain->saveImage(currentImageIndex, pendingCapturePath);
+        pendingCapturePath.clear();
+    }
+
+    auto result = lveSwapChain->presentImage(&currentImageIndex, *frameScheduler);
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || lveWindow.wasWindowResized()) {
         lveWindow.resetWindowResizedFlag();
         recreateSwapChain();
@@ -162,10 +169,9 @@ void LveRenderer::presentFrame(SynchronisationObjects &syncObjects) {
     }
 
     isFrameStarted = false;
-    currentFrameIndex = (currentFrameIndex + 1) % LveSwapChain::MAX_FRAMES_IN_FLIGHT;
 }
 
-void LveRenderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer) {
+void LveRenderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer, VkSubpassContents contents) {
     assert(isFrameStarted && "Can't call beginSwapChainRenderPass while frame is not in progress");
     assert(commandBuffer == getCurrentCommandBuffer() &&
            "Can't beging render pass on command buffer from a different frame");
@@ -183,8 +189,13 @@ void LveRenderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer) {
     renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
     renderPassInfo.pClearValues = clearValues.data();
 
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
 
+    // only vkCmdExecuteCommands is allowed in the pass, the secondaries set their own viewport
+    if (contents == VK_SUBPASS_CONTENTS_INLINE) setViewportAndScissor(commandBuffer);
+}
+
+void LveRenderer::setViewportAndScissor(VkCommandBuffer commandBuffer) const {
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
@@ -196,6 +207,42 @@ void LveRenderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer) {
     vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 }
+
+VkCommandBuffer LveRenderer::beginSecondaryCommandBuffer(uint32_t threadIndex) {
+    assert(isFrameStarted && "Can't begin a secondary command buffer while frame is not in progress");
+    assert(threadIndex < RECORDING_THREADS && "Recording thread index out of range");
+    VkCommandBuffer commandBuffer = commandPools->allocateSecondary(threadIndex);
+
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = lveSwapChain->getRenderPass();
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = lveSwapChain->getFrameBuffer(currentImageIndex);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags =
+        VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording secondary command buffer!");
+    }
+    setViewportAndScissor(commandBuffer);
+    return commandBuffer;
+}
+
+void LveRenderer::executeSecondaryCommandBuffers(VkCommandBuffer commandBuffer,
+                                                 const std::vector<VkCommandBuffer> &secondaryBuffers) {
+    assert(commandBuffer == getCurrentCommandBuffer() &&
+           "Can't execute secondary command buffers on command buffer from a different frame");
+    for (VkCommandBuffer secondaryBuffer : secondaryBuffers) {
+        if (vkEndCommandBuffer(secondaryBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to record secondary command buffer!");
+        }
+    }
+    vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(secondaryBuffers.size()), secondaryBuffers.data());
+}
+
 void LveRenderer::endSwapChainRenderPass(VkCommandBuffer commandBuffer) {
     assert(isFrameStarted && "Can't call endSwapChainRenderPass while frame is not in progress");
     assert(commandBuffer == getCurrentCommandBuffer() &&
@@ -203,7 +250,7 @@ void LveRenderer::endSwapChainRenderPass(VkCommandBuffer commandBuffer) {
     vkCmdEndRenderPass(commandBuffer);
 }
 
-void LveRenderer::renderPostProssessingEffects(FrameInfo frameInfo, SynchronisationObjects &syncObjects) {
+void LveRenderer::renderPostProssessingEffects(FrameInfo frameInfo) {
     VkImage swapchainImage = lveSwapChain->getActualswapChainImages(currentImageIndex);
     VkImage depthImage = lveSwapChain->getActualDepthImages(currentImageIndex);
     VkCommandBufferBeginInfo beginInfo{};
@@ -212,21 +259,30 @@ void LveRenderer::renderPostProssessingEffects(FrameInfo frameInfo, Synchronisat
         throw std::runtime_error("failed to begin recording command buffer!");
     }
 
-    postProcessingManager->drawPostProcessings(frameInfo, swapchainImage, depthImage, syncObjects);
+    // post processing copies the rendered image then runs compute shaders on it, present waits on its submit
+    frameScheduler->addDependency(LveFrameScheduler::POST_PROCESS, LveFrameScheduler::GRAPHICS,
+                                  VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    frameScheduler->signalPresentReady(LveFrameScheduler::POST_PROCESS);
+
+    // uploads staged in the ring during this frame must be submitted before the last submit of the frame
+    lveDevice.getUploadBatcher().submit();
+    postProcessingManager->drawPostProcessings(frameInfo, swapchainImage, lveSwapChain->getPresentLayout(), depthImage,
+                                               *frameScheduler);
+    frameRing->endFrame();
 }
 
 void LveRenderer::addPostProcessingEffect(std::shared_ptr<LveIPostProcessing> postProcessing) {
     postProcessingManager->addPostProcessing(postProcessing);
 }
 
-void LveRenderer::executePreProssessingEffects(FrameInfo frameInfo, SynchronisationObjects &syncObjects) {
+void LveRenderer::executePreProssessingEffects(FrameInfo frameInfo) {
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     if (vkBeginCommandBuffer(frameInfo.preProcessingCommandBuffer, &beginInfo) != VK_SUCCESS) {
         throw std::runtime_error("failed to begin recording command buffer!");
     }
 
-    preProcessingManager->executePreprocessing(frameInfo, syncObjects);
+    preProcessingManager->executePreprocessing(frameInfo, *frameScheduler);
 }
 
 void LveRenderer::addPreProcessingEffect(std::shared_ptr<LveIPreProcessing> preProcessing) {
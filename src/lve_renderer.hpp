@@ -3,8 +3,13 @@
 #include <cassert>
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
+#include "lve_command_pools.hpp"
 #include "lve_device.hpp"
+#include "lve_frame_ring.hpp"
+#include "lve_frame_scheduler.hpp"
 #include "lve_post_processing_manager.hpp"
 #include "lve_pre_processing_manager.hpp"
 #include "lve_swap_chain.hpp"
@@ -14,11 +19,15 @@
 namespace lve {
 class LveRenderer {
    public:
+    // thread 0 records the primary command buffers, the others can record secondaries in parallel
+    static constexpr uint32_t RECORDING_THREADS = 4;
+
     LveRenderer(LveWindow &window, LveDevice &device);
     ~LveRenderer();
 
     VkRenderPass getSwapChainRenderPass() const { return lveSwapChain->getRenderPass(); }
     float getAspectRatio() const { return lveSwapChain->extentAspectRatio(); }
+    VkExtent2D getSwapChainExtent() const { return lveSwapChain->getSwapChainExtent(); }
     bool isFrameInProgress() const { return isFrameStarted; }
 
     VkCommandBuffer getCurrentCommandBuffer() const {
@@ -46,27 +55,44 @@ class LveRenderer {
         return currentImageIndex;
     }
 
-    bool startRendering(SynchronisationObjects &syncObjects);
-    VkCommandBuffer beginFrame(SynchronisationObjects &syncObjects);
-    void endFrame(SynchronisationObjects &syncObjects);
-    void presentFrame(SynchronisationObjects &syncObjects);
-    void renderPostProssessingEffects(FrameInfo frameInfo, SynchronisationObjects &syncObjects);
-    void executePreProssessingEffects(FrameInfo frameInfo, SynchronisationObjects &syncObjects);
-    void beginSwapChainRenderPass(VkCommandBuffer commandBuffer);
+    LveFrameRing &getFrameRing() const { return *frameRing; }
+    LveFrameScheduler &getFrameScheduler() const { return *frameScheduler; }
+
+    bool startRendering();
+    VkCommandBuffer beginFrame();
+    void endFrame();
+    void presentFrame();
+    void renderPostProssessingEffects(FrameInfo frameInfo);
+    void executePreProssessingEffects(FrameInfo frameInfo);
+    // VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS when the pass is recorded by beginSecondaryCommandBuffer users
+    void beginSwapChainRenderPass(VkCommandBuffer commandBuffer,
+                                  VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+    // Secondary command buffer of the recording thread, begun inside the swap chain render pass with the viewport
+    // set. Each thread index must be used by one thread at a time.
+    VkCommandBuffer beginSecondaryCommandBuffer(uint32_t threadIndex);
+    // Ends the secondaries once every worker is done with them, then executes them in order
+    void executeSecondaryCommandBuffers(VkCommandBuffer commandBuffer,
+                                        const std::vector<VkCommandBuffer> &secondaryBuffers);
     void endSwapChainRenderPass(VkCommandBuffer commandBuffer);
     void addPostProcessingEffect(std::shared_ptr<LveIPostProcessing> postProcessing);
     void addPreProcessingEffect(std::shared_ptr<LveIPreProcessing> preProcessing);
+    // The image of the current frame is written to filepath (PPM) right before it is presented
+    void captureFrame(const std::string &filepath) { pendingCapturePath = filepath; }
 
    private:
     void createCommandBuffers();
     void freeCommandBuffers();
     void recreateSwapChain();
+    void setViewportAndScissor(VkCommandBuffer commandBuffer) const;
 
     LveWindow &lveWindow;
     LveDevice &lveDevice;
     std::unique_ptr<LveSwapChain> lveSwapChain;
     std::unique_ptr<LvePostProcessingManager> postProcessingManager;
     std::unique_ptr<LvePreProcessingManager> preProcessingManager;
+    std::unique_ptr<LveFrameRing> frameRing;
+    std::unique_ptr<LveFrameScheduler> frameScheduler;
+    std::unique_ptr<LveCommandPools> commandPools;
     std::vector<VkCommandBuffer> commandBuffers;
     std::vector<VkCommandBuffer> preProcessingBuffers;
     std::vector<VkCommandBuffer> postProcessingBuffers;
@@ -74,5 +100,6 @@ class LveRenderer {
     std::uint32_t currentImageIndex;
     int currentFrameIndex{0};
     bool isFrameStarted{false};
+    std::string pendingCapturePath;
 };
 }  // namespace lve
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "lve_swap_chain.hpp"
 
+#include "lve_buffer.hpp"
 #include "lve_utils.hpp"
 
 // std
@@ -8,6 +9,7 @@
 #include <array>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <limits>
 #include <memory>
@@ -16,127 +18,203 @@
 
 namespace lve {
 
-LveSwapChain::LveSwapChain(LveDevice &deviceRef, VkExtent2D extent) : device{deviceRef}, windowExtent{extent} {
+LveSwapChain::LveSwapChain(LveDevice &deviceRef, VkExtent2D extent)
+    : device{deviceRef}, windowExtent{extent}, headless{deviceRef.isHeadless()} {
     init();
 }
 
 LveSwapChain::LveSwapChain(LveDevice &deviceRef, VkExtent2D extent, std::shared_ptr<LveSwapChain> previous)
-    : device{deviceRef}, windowExtent{extent}, oldSwapChain{previous} {
+    : device{deviceRef}, windowExtent{extent}, headless{deviceRef.isHeadless()}, oldSwapChain{previous} {
     init();
 
     oldSwapChain = nullptr;
 }
 
 void LveSwapChain::init() {
-    createSwapChain();
+    // without a surface the images are never presented, they stay ready to be copied out
+    presentLayout = headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    if (headless) {
+        createOffscreenImages();
+    } else {
+        createSwapChain();
+    }
     createImageViews();
     createRenderPass();
     createDepthResources();
     createFramebuffers();
-    createSyncObjects();
+    imagesInFlight.resize(imageCount(), 0);
 }
 
 LveSwapChain::~LveSwapChain() {
+    // a replaced swap chain can still be used by the frames in flight, nothing is destroyed before they retire
+    LveDeletionQueue &deletionQueue = device.getDeletionQueue();
     for (auto imageView : swapChainImageViews) {
-        vkDestroyImageView(device.device(), imageView, nullptr);
+        deletionQueue.destroyImageView(imageView);
     }
     swapChainImageViews.clear();
 
     if (swapChain != nullptr) {
-        vkDestroySwapchainKHR(device.device(), swapChain, nullptr);
+        deletionQueue.destroySwapchain(swapChain);
         swapChain = nullptr;
     }
 
+    for (int i = 0; i < offscreenImageAllocations.size(); i++) {
+        deletionQueue.destroyImage(swapChainImages[i], offscreenImageAllocations[i]);
+    }
+
     for (int i = 0; i < depthImages.size(); i++) {
-        vkDestroyImageView(device.device(), depthImageViews[i], nullptr);
-        vkDestroyImage(device.device(), depthImages[i], nullptr);
-        vkFreeMemory(device.device(), depthImageMemorys[i], nullptr);
+        deletionQueue.destroyImageView(depthImageViews[i]);
+        deletionQueue.destroyImage(depthImages[i], depthImageAllocations[i]);
     }
 
     for (auto framebuffer : swapChainFramebuffers) {
-        vkDestroyFramebuffer(device.device(), framebuffer, nullptr);
+        deletionQueue.destroyFramebuffer(framebuffer);
     }
 
-    vkDestroyRenderPass(device.device(), renderPass, nullptr);
-
-    // cleanup synchronization objects
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        vkDestroySemaphore(device.device(), (renderFinishedSemaphores)[i], nullptr);
-        vkDestroySemaphore(device.device(), imageAvailableSemaphores[i], nullptr);
-        vkDestroyFence(device.device(), inFlightFences[i], nullptr);
-    }
+    deletionQueue.destroyRenderPass(renderPass);
 }
 
-VkResult LveSwapChain::acquireNextImage(uint32_t *imageIndex, SynchronisationObjects &syncObjects) {
-    vkWaitForFences(device.device(), 1, &inFlightFences[currentFrame], VK_TRUE, std::numeric_limits<uint64_t>::max());
+VkResult LveSwapChain::acquireNextImage(uint32_t *imageIndex, LveFrameScheduler &scheduler) {
+    if (headless) {
+        *imageIndex = nextOffscreenImage;
+        nextOffscreenImage = (nextOffscreenImage + 1) % imageCount();
+        if (imagesInFlight[*imageIndex] != 0) {
+            scheduler.waitForFrame(imagesInFlight[*imageIndex]);
+        }
+        imagesInFlight[*imageIndex] = scheduler.getFrameNumber();
+        return VK_SUCCESS;
+    }
 
+    VkSemaphore acquireSemaphore = scheduler.getAcquireSemaphore();
     VkResult result = vkAcquireNextImageKHR(device.device(), swapChain, std::numeric_limits<uint64_t>::max(),
-                                            imageAvailableSemaphores[currentFrame],  // must be a not signaled
-                                                                                     // semaphore
+                                            acquireSemaphore,  // must be a not signaled semaphore
                                             VK_NULL_HANDLE, imageIndex);
-    syncObjects.semaphores.clear();
-    syncObjects.fences.clear();
-    syncObjects.semaphores.push_back(imageAvailableSemaphores[currentFrame]);
-
-    return result;
-}
-
-VkResult LveSwapChain::submitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex,
-                                            SynchronisationObjects &syncObjects) {
-    if (imagesInFlight[*imageIndex] != VK_NULL_HANDLE) {
-        vkWaitForFences(device.device(), 1, &imagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
+    if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+        return result;
     }
-    imagesInFlight[*imageIndex] = inFlightFences[currentFrame];
 
-    VkSubmitInfo submitInfo = {};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-
-    // VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
-
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = syncObjects.semaphores.data();
-    submitInfo.pWaitDstStageMask = waitStages;
-
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = buffers;
-
-    VkSemaphore signalSemaphores[] = {(renderFinishedSemaphores)[currentFrame]};
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = signalSemaphores;
-
-    vkResetFences(device.device(), 1, &inFlightFences[currentFrame]);
-    syncObjects.fences.push_back(inFlightFences[currentFrame]);
-
-    auto result = vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-    if (result != VK_SUCCESS) {
-        throw std::runtime_error("failed to submit draw command buffer!");
+    // the image may still be used by an older frame than the one the scheduler waited for
+    if (imagesInFlight[*imageIndex] != 0) {
+        scheduler.waitForFrame(imagesInFlight[*imageIndex]);
     }
+    imagesInFlight[*imageIndex] = scheduler.getFrameNumber();
 
-    syncObjects.semaphores.clear();
-    syncObjects.semaphores.push_back((renderFinishedSemaphores)[currentFrame]);
+    scheduler.addBinaryWait(LveFrameScheduler::GRAPHICS, acquireSemaphore,
+                            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
     return result;
 }
 
-VkResult LveSwapChain::presentImage(uint32_t *imageIndex, SynchronisationObjects &syncObjects) {
-    //   VkSemaphore waitSemaphores[] = {waitSemaphore};
+void LveSwapChain::submitCommandBuffers(const VkCommandBuffer *buffers, LveFrameScheduler &scheduler) {
+    scheduler.submit(LveFrameScheduler::GRAPHICS, device.graphicsQueue(), buffers, 1);
+}
 
-    VkPresentInfoKHR presentInfo = {};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+VkResult LveSwapChain::presentImage(uint32_t *imageIndex, LveFrameScheduler &scheduler) {
+    if (headless) {
+        scheduler.presentOffscreen(device.graphicsQueue());
+        return VK_SUCCESS;
+    }
+    return scheduler.present(device.presentQueue(), swapChain, *imageIndex);
+}
 
-    presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = syncObjects.semaphores.data();
+void LveSwapChain::saveImage(uint32_t imageIndex, const std::string &filepath) {
+    VkDeviceSize imageSize = static_cast<VkDeviceSize>(swapChainExtent.width) * swapChainExtent.height * 4;
+    LveBuffer readbackBuffer{device,
+                             imageSize,
+                             1,
+                             VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                             1,
+                             LveMemoryCategory::Staging};
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = swapChainImages[imageIndex];
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    VkCommandBuffer commandBuffer = device.beginSingleTimeCommands();
+
+    barrier.oldLayout = presentLayout;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                         nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {swapChainExtent.width, swapChainExtent.height, 1};
+    vkCmdCopyImageToBuffer(commandBuffer, swapChainImages[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           readbackBuffer.getBuffer(), 1, &region);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = presentLayout;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = 0;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0,
+                         nullptr, 0, nullptr, 1, &barrier);
+
+    device.endSingleTimeCommands(commandBuffer);
+
+    readbackBuffer.map();
+    const uint8_t *pixels = static_cast<const uint8_t *>(readbackBuffer.getMappedMemory());
+    // B8G8R8A8 for both the offscreen images and the preferred surface format
+    bool bgr = swapChainImageFormat == VK_FORMAT_B8G8R8A8_SRGB || swapChainImageFormat == VK_FORMAT_B8G8R8A8_UNORM;
+
+    std::ofstream file{filepath, std::ios::binary};
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open file: " + filepath);
+    }
+    file << "P6\n" << swapChainExtent.width << " " << swapChainExtent.height << "\n255\n";
+    std::vector<uint8_t> row(swapChainExtent.width * 3);
+    for (uint32_t y = 0; y < swapChainExtent.height; y++) {
+        const uint8_t *texel = pixels + static_cast<size_t>(y) * swapChainExtent.width * 4;
+        for (uint32_t x = 0; x < swapChainExtent.width; x++, texel += 4) {
+            row[x * 3 + 0] = bgr ? texel[2] : texel[0];
+            row[x * 3 + 1] = texel[1];
+            row[x * 3 + 2] = bgr ? texel[0] : texel[2];
+        }
+        file.write(reinterpret_cast<const char *>(row.data()), row.size());
+    }
+    readbackBuffer.unmap();
+}
 
-    VkSwapchainKHR swapChains[] = {swapChain};
-    presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = swapChains;
+void LveSwapChain::createOffscreenImages() {
+    swapChainImageFormat = VK_FORMAT_B8G8R8A8_SRGB;
+    swapChainExtent = windowExtent;
 
-    presentInfo.pImageIndices = imageIndex;
+    swapChainImages.resize(MAX_FRAMES_IN_FLIGHT);
+    offscreenImageAllocations.resize(MAX_FRAMES_IN_FLIGHT);
+    for (int i = 0; i < swapChainImages.size(); i++) {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent.width = swapChainExtent.width;
+        imageInfo.extent.height = swapChainExtent.height;
+        imageInfo.extent.depth = 1;
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = swapChainImageFormat;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        // same usage as the swap chain images, the post processing copies to and from them
+        imageInfo.usage =
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.flags = 0;
 
-    auto result = vkQueuePresentKHR(device.presentQueue(), &presentInfo);
-    syncObjects.semaphores.clear();
-    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
-    return result;
+        device.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, swapChainImages[i],
+                                   offscreenImageAllocations[i], LveMemoryCategory::Swapchain);
+    }
 }
 
 void LveSwapChain::createSwapChain() {
@@ -246,7 +324,7 @@ void LveSwapChain::createRenderPass() {
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.finalLayout = presentLayout;
 
     VkAttachmentReference colorAttachmentRef = {};
     colorAttachmentRef.attachment = 0;
@@ -310,7 +388,7 @@ void LveSwapChain::createDepthResources() {
     VkExtent2D swapChainExtent = getSwapChainExtent();
 
     depthImages.resize(imageCount());
-    depthImageMemorys.resize(imageCount());
+    depthImageAllocations.resize(imageCount());
     depthImageViews.resize(imageCount());
     depthImagesSamplers.resize(imageCount());
 
@@ -332,7 +410,7 @@ void LveSwapChain::createDepthResources() {
         imageInfo.flags = 0;
 
         device.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depthImages[i],
-                                   depthImageMemorys[i]);
+                                   depthImageAllocations[i], LveMemoryCategory::Swapchain);
 
         VkImageViewCreateInfo viewInfo{};
         viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -365,29 +443,7 @@ void LveSwapChain::createDepthResources() {
         samplerInfo.anisotropyEnable = VK_FALSE;                     // VK_FALSE
         samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_WHITE;  // VK_BORDER_COLOR_INT_OPAQUE_BLACK
 
-        vkCreateSampler(device.device(), &samplerInfo, nullptr, &depthImagesSamplers[i]);
-    }
-}
-
-void LveSwapChain::createSyncObjects() {
-    imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-    imagesInFlight.resize(imageCount(), VK_NULL_HANDLE);
-
-    VkSemaphoreCreateInfo semaphoreInfo = {};
-    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-
-    VkFenceCreateInfo fenceInfo = {};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        if (vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-            vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &(renderFinishedSemaphores)[i]) != VK_SUCCESS ||
-            vkCreateFence(device.device(), &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create synchronization objects for a frame!");
-        }
+        depthImagesSamplers[i] = device.getSampler(samplerInfo);
     }
 }
 
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "lve_device.hpp"
-#include "lve_utils.hpp"
+#include "lve_frame_scheduler.hpp"
 
 // vulkan headers
 #include <vulkan/vulkan.h>
@@ -38,13 +38,17 @@ class LveSwapChain {
     }
     VkFormat findDepthFormat();
 
-    VkResult acquireNextImage(uint32_t *imageIndex, SynchronisationObjects &syncObjects);
-    VkResult submitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex,
-                                  SynchronisationObjects &syncObjects);
+    // The scheduler must have begun the frame, the acquire is waited on by its next GRAPHICS submit
+    VkResult acquireNextImage(uint32_t *imageIndex, LveFrameScheduler &scheduler);
+    void submitCommandBuffers(const VkCommandBuffer *buffers, LveFrameScheduler &scheduler);
 
-    VkResult presentImage(uint32_t *imageIndex, SynchronisationObjects &syncObjects);
+    VkResult presentImage(uint32_t *imageIndex, LveFrameScheduler &scheduler);
 
-    VkSemaphore getActualRenderFinishedSemaphores() const { return renderFinishedSemaphores[currentFrame]; }
+    // Layout the color images are left in at the end of a frame, TRANSFER_SRC_OPTIMAL for the offscreen images
+    VkImageLayout getPresentLayout() const { return presentLayout; }
+    bool isHeadless() const { return headless; }
+    // Reads back a rendered image into a binary PPM, the frame that rendered it must be complete
+    void saveImage(uint32_t imageIndex, const std::string &filepath);
 
     VkImage getActualswapChainImages(uint32_t imageIndex) const { return swapChainImages[imageIndex]; }
 
@@ -56,23 +60,19 @@ class LveSwapChain {
 
     std::vector<VkSampler> getDepthImagesSamplers() const { return depthImagesSamplers; }
 
-    VkFence getActualInFlightFences() const { return inFlightFences[currentFrame]; }
-
     bool compareSwapFormats(const LveSwapChain &swapChain) const {
         return swapChain.swapChainDepthFormat == swapChainDepthFormat &&
                swapChain.swapChainImageFormat == swapChainImageFormat;
     }
 
-    int getCurrentFrameIndex() const { return currentFrame; }
-
    private:
     void init();
     void createSwapChain();
+    void createOffscreenImages();
     void createImageViews();
     void createDepthResources();
     void createRenderPass();
     void createFramebuffers();
-    void createSyncObjects();
 
     // Helper functions
     VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &availableFormats);
@@ -87,24 +87,26 @@ class LveSwapChain {
     VkRenderPass renderPass;
 
     std::vector<VkImage> depthImages;
-    std::vector<VkDeviceMemory> depthImageMemorys;
+    std::vector<LveAllocation> depthImageAllocations;
     std::vector<VkImageView> depthImageViews;
     std::vector<VkSampler> depthImagesSamplers;
 
     std::vector<VkImage> swapChainImages;
     std::vector<VkImageView> swapChainImageViews;
+    // only used without a surface, the swap chain images are then owned by us
+    std::vector<LveAllocation> offscreenImageAllocations;
+    uint32_t nextOffscreenImage = 0;
 
     LveDevice &device;
     VkExtent2D windowExtent;
+    bool headless;
+    VkImageLayout presentLayout;
 
-    VkSwapchainKHR swapChain;
+    VkSwapchainKHR swapChain = VK_NULL_HANDLE;
     std::shared_ptr<LveSwapChain> oldSwapChain;
 
-    std::vector<VkSemaphore> imageAvailableSemaphores;
-    std::vector<VkSemaphore> renderFinishedSemaphores;
-    std::vector<VkFence> inFlightFences;
-    std::vector<VkFence> imagesInFlight;
-    size_t currentFrame = 0;
+    // frame number of the last frame that rendered to each image, 0 if none
+    std::vector<uint64_t> imagesInFlight;
 };
 
 }  // namespace lve
@@ -4,6 +4,7 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <filesystem>
@@ -13,6 +14,8 @@
 
 #include "lve_buffer.hpp"
 #include "lve_texture.hpp"
+#include "lve_texture_cache.hpp"
+#include "lve_upload_batcher.hpp"
 
 #ifndef ENGINE_DIR
 #define ENGINE_DIR "../"
@@ -20,36 +23,72 @@
 
 namespace lve {
 
-LveTexture::LveTexture(LveDevice &device, const std::string &filepath, bool isComputeTexture)
+namespace {
+// what objectTextureConstructor does to the decoded pixels, part of the texture cache key
+constexpr const char *OBJECT_TEXTURE_IMPORT_OPTIONS = "rgba8 srgb flipped";
+}  // namespace
+
+LveTexture::LveTexture(LveDevice &device, const std::string &filepath, bool isComputeTexture, uint32_t mipLevels)
     : lveDevice{device}, width{0}, height{0} {
     if (isComputeTexture) {
-        computeTextureConstructor(filepath);
+        computeTextureConstructor(filepath, mipLevels);
     } else {
-        objectTextureConstructor(filepath);
+        objectTextureConstructor(filepath, mipLevels);
     }
+    bindlessIndex = lveDevice.getBindlessTable().registerTexture(imageView, sampler, imageLayout);
 }
 
-LveTexture::LveTexture(LveDevice &device, int width, int height) : lveDevice{device}, width{width}, height{height} {
-    postprocessingTextureConstructor(width, height);
+LveTexture::LveTexture(LveDevice &device, int width, int height, uint32_t mipLevels)
+    : lveDevice{device}, width{width}, height{height} {
+    postprocessingTextureConstructor(width, height, mipLevels);
 }
 
 LveTexture::LveTexture(LveDevice &device, int width, int height, void *image, int numberOfChannels,
-                       VkFormat textureFormat)
+                       VkFormat textureFormat, VkSharingMode sharingMode, uint32_t mipLevels)
+    : lveDevice{device}, width(width), height(height) {
+    cpuTextureConstructor(width, height, image, numberOfChannels, textureFormat, sharingMode, mipLevels);
+    bindlessIndex = lveDevice.getBindlessTable().registerTexture(imageView, sampler, imageLayout);
+}
+
+LveTexture::LveTexture(LveDevice &device, int width, int height, uint32_t layerCount, VkFormat textureFormat,
+                       VkSharingMode sharingMode, uint32_t mipLevels)
     : lveDevice{device}, width(width), height(height) {
-    cpuTextureConstructor(width, height, image, numberOfChannels, textureFormat);
+    layeredTextureConstructor(width, height, layerCount, textureFormat, sharingMode, mipLevels);
 }
 
-void LveTexture::postprocessingTextureConstructor(int width, int height) {
-    LveBuffer stagingBuffer{lveDevice, 4, static_cast<u_int32_t>(width * height), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT};
+uint32_t LveTexture::fullMipCount(int width, int height) {
+    uint32_t levels = 1;
+    for (int size = std::max(width, height); size > 1; size >>= 1) levels++;
+    return levels;
+}
+
+void LveTexture::setMipLevels(uint32_t requestedLevels, int width, int height) {
+    uint32_t maxLevels = fullMipCount(width, height);
+    mipLevels = requestedLevels == FULL_MIP_CHAIN ? maxLevels : std::min(requestedLevels, maxLevels);
+    if (mipLevels == 1) return;
 
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(lveDevice.getPhysicalDevice(), imageFormat, &formatProperties);
+    VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+    if ((formatProperties.optimalTilingFeatures & blitFeatures) != blitFeatures) {
+        throw std::runtime_error("texture image format does not support blits for mipmap generation!");
+    }
+    // downsampling stays correct without linear filtering, it just aliases a bit more
+    mipFilter = formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT
+                    ? VK_FILTER_LINEAR
+                    : VK_FILTER_NEAREST;
+}
+
+void LveTexture::postprocessingTextureConstructor(int width, int height, uint32_t mipLevels) {
+    LveUploadBatcher &uploadBatcher = lveDevice.getUploadBatcher();
     imageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    setMipLevels(mipLevels, width, height);
 
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
     imageInfo.format = imageFormat;
-    imageInfo.mipLevels = 1;
+    imageInfo.mipLevels = this->mipLevels;
     imageInfo.arrayLayers = 1;
     imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
@@ -59,14 +98,12 @@ void LveTexture::postprocessingTextureConstructor(int width, int height) {
     imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
                       VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
-    lveDevice.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageMemory);
+    lveDevice.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageAllocation,
+                                  LveMemoryCategory::Texture);
 
-    transitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+    transitionImageLayout(uploadBatcher.getCommandBuffer(), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
     imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-
-    // lveDevice.copyBufferToImage(stagingBuffer.getBuffer(), textureImage,
-    // static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1,
-    // imageLayout);
+    uploadToken = uploadBatcher.currentToken();
 
     VkSamplerCreateInfo samplerInfo{};
     samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -79,12 +116,13 @@ void LveTexture::postprocessingTextureConstructor(int width, int height) {
     samplerInfo.mipLodBias = 0.0f;
     samplerInfo.compareOp = VK_COMPARE_OP_NEVER;  // VK_COMPARE_OP_NEVER
     samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 0.0f;
+    // the image view already stops at the last level, an unclamped sampler is shared by every mip count
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
     samplerInfo.maxAnisotropy = 4.0f;
     samplerInfo.anisotropyEnable = VK_TRUE;                      // VK_FALSE
     samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_WHITE;  // VK_BORDER_COLOR_INT_OPAQUE_BLACK
 
-    vkCreateSampler(lveDevice.device(), &samplerInfo, nullptr, &sampler);
+    sampler = lveDevice.getSampler(samplerInfo);
 
     VkImageViewCreateInfo imageViewInfo{};
     imageViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -96,46 +134,79 @@ void LveTexture::postprocessingTextureConstructor(int width, int height) {
     imageViewInfo.subresourceRange.baseMipLevel = 0;
     imageViewInfo.subresourceRange.baseArrayLayer = 0;
     imageViewInfo.subresourceRange.layerCount = 1;
-    imageViewInfo.subresourceRange.levelCount = 1;
+    imageViewInfo.subresourceRange.levelCount = this->mipLevels;
     imageViewInfo.image = textureImage;
 
     vkCreateImageView(lveDevice.device(), &imageViewInfo, nullptr, &imageView);
+    createStorageImageViews();
 }
 
-void LveTexture::objectTextureConstructor(const std::string &filepath) {
+void LveTexture::objectTextureConstructor(const std::string &filepath, uint32_t mipLevels) {
+    if (loadBakedTexture(filepath, mipLevels)) return;
+
+    // pixels decoded by a previous run are mapped and staged as is
+    LveTextureCache &textureCache = lveDevice.getTextureCache();
+    LveTextureCache::Key cacheKey = textureCache.makeKey(ENGINE_DIR + filepath, OBJECT_TEXTURE_IMPORT_OPTIONS);
+    LveTexContainer cachedTexture{};
+    if (textureCache.find(cacheKey, cachedTexture)) {
+        containerTextureConstructor(cachedTexture, VK_FORMAT_R8G8B8A8_SRGB, mipLevels);
+        return;
+    }
+
     int width, height, channels;
     int byPerPixel;
     stbi_set_flip_vertically_on_load(true);
     stbi_uc *pixels = stbi_load((ENGINE_DIR + filepath).c_str(), &width, &height, &byPerPixel, 4);
-    LveBuffer stagingBuffer{lveDevice, 4, static_cast<u_int32_t>(width * height), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
-    stagingBuffer.map();
-    stagingBuffer.writeToBuffer(pixels);
+    if (pixels == nullptr) {
+        throw std::runtime_error("failed to load texture image " + filepath);
+    }
+
+    LveTexContainer decodedTexture{};
+    decodedTexture.format = LveTexFormat::RGBA8;
+    decodedTexture.flags = LveTexContainer::FLAG_SRGB;
+    decodedTexture.width = static_cast<uint32_t>(width);
+    decodedTexture.height = static_cast<uint32_t>(height);
+    decodedTexture.addMip(decodedTexture.width, decodedTexture.height, pixels);
+    textureCache.store(cacheKey, decodedTexture);
+
+    this->width = width;
+    this->height = height;
+    LveUploadBatcher &uploadBatcher = lveDevice.getUploadBatcher();
+    LveBufferRange staging = uploadBatcher.stage(pixels, static_cast<VkDeviceSize>(width) * height * 4);
     imageFormat = VK_FORMAT_R8G8B8A8_SRGB;
+    setMipLevels(mipLevels, width, height);
 
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
     imageInfo.format = imageFormat;
-    imageInfo.mipLevels = 1;
+    imageInfo.mipLevels = this->mipLevels;
     imageInfo.arrayLayers = 1;
     imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
     imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     imageInfo.extent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
-    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-
-    lveDevice.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageMemory);
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
 
-    transitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    lveDevice.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageAllocation,
+                                  LveMemoryCategory::Texture);
 
-    lveDevice.copyBufferToImage(stagingBuffer.getBuffer(), textureImage, static_cast<uint32_t>(width),
-                                static_cast<uint32_t>(height), 1);
+    VkCommandBuffer commandBuffer = uploadBatcher.getCommandBuffer();
+    transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
-    transitionImageLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    uploadBatcher.copyBufferToImage(staging, textureImage, static_cast<uint32_t>(width),
+                                    static_cast<uint32_t>(height), 1);
 
     imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    if (this->mipLevels > 1) {
+        recordMipChain(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+    } else {
+        transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+    uploadToken = uploadBatcher.currentToken();
 
     VkSamplerCreateInfo samplerInfo{};
     samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -148,12 +219,12 @@ void LveTexture::objectTextureConstructor(const std::string &filepath) {
     samplerInfo.mipLodBias = 0.0f;
     samplerInfo.compareOp = VK_COMPARE_OP_NEVER;  // VK_COMPARE_OP_NEVER
     samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 0.0f;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
     samplerInfo.maxAnisotropy = 4.0f;
     samplerInfo.anisotropyEnable = VK_TRUE;                      // VK_FALSE
     samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_WHITE;  // VK_BORDER_COLOR_INT_OPAQUE_BLACK
 
-    vkCreateSampler(lveDevice.device(), &samplerInfo, nullptr, &sampler);
+    sampler = lveDevice.getSampler(samplerInfo);
 
     VkImageViewCreateInfo imageViewInfo{};
     imageViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -165,7 +236,7 @@ void LveTexture::objectTextureConstructor(const std::string &filepath) {
     imageViewInfo.subresourceRange.baseMipLevel = 0;
     imageViewInfo.subresourceRange.baseArrayLayer = 0;
     imageViewInfo.subresourceRange.layerCount = 1;
-    imageViewInfo.subresourceRange.levelCount = 1;
+    imageViewInfo.subresourceRange.levelCount = this->mipLevels;
     imageViewInfo.image = textureImage;
 
     vkCreateImageView(lveDevice.device(), &imageViewInfo, nullptr, &imageView);
@@ -173,39 +244,190 @@ void LveTexture::objectTextureConstructor(const std::string &filepath) {
     stbi_image_free(pixels);
 }
 
-void LveTexture::computeTextureConstructor(const std::string &filepath) {
+VkFormat LveTexture::toVkFormat(LveTexFormat format, bool srgb) {
+    switch (format) {
+        case LveTexFormat::RGBA8:
+            return srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+        case LveTexFormat::BC1:
+            return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+        case LveTexFormat::BC3:
+            return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+        case LveTexFormat::BC5:
+            return VK_FORMAT_BC5_UNORM_BLOCK;
+        case LveTexFormat::BC7:
+            return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+    }
+    throw std::runtime_error("unknown baked texture format!");
+}
+
+bool LveTexture::loadBakedTexture(const std::string &filepath, uint32_t mipLevels) {
+    std::filesystem::path sourcePath = ENGINE_DIR + filepath;
+    bool isBakedFile = sourcePath.extension() == ".lvetex";
+    std::filesystem::path bakedPath = sourcePath;
+    bakedPath.replace_extension(".lvetex");
+
+    if (!isBakedFile) {
+        // rebaking is manual, an image edited after its bake wins
+        std::error_code error;
+        if (!std::filesystem::exists(bakedPath, error) ||
+            std::filesystem::last_write_time(bakedPath, error) < std::filesystem::last_write_time(sourcePath, error)) {
+            return false;
+        }
+    }
+
+    LveTexContainer container = LveTexContainer::map(bakedPath.string());
+    VkFormat format = toVkFormat(container.format, container.isSrgb());
+    if (!lveDevice.supportsSampledFormat(format)) {
+        if (isBakedFile) {
+            throw std::runtime_error("device cannot sample the format of baked texture " + filepath);
+        }
+        return false;
+    }
+    containerTextureConstructor(container, format, mipLevels);
+    return true;
+}
+
+void LveTexture::containerTextureConstructor(const LveTexContainer &container, VkFormat format, uint32_t mipLevels) {
+    width = static_cast<int>(container.width);
+    height = static_cast<int>(container.height);
+    imageFormat = format;
+    uint32_t storedLevels = static_cast<uint32_t>(container.mips.size());
+    uint32_t uploadedLevels;
+    bool generateMipChain = false;
+    if (container.isBlockCompressed()) {
+        // compressed levels can't be blitted, the chain is limited to the stored levels
+        this->mipLevels = mipLevels == FULL_MIP_CHAIN ? storedLevels : std::min(mipLevels, storedLevels);
+        uploadedLevels = this->mipLevels;
+    } else {
+        // missing levels are blitted from level 0, as for a decoded image
+        setMipLevels(mipLevels, width, height);
+        generateMipChain = this->mipLevels > storedLevels;
+        uploadedLevels = generateMipChain ? 1 : this->mipLevels;
+    }
+
+    // levels are stored back to back from the largest, only the ones used are staged
+    LveUploadBatcher &uploadBatcher = lveDevice.getUploadBatcher();
+    const LveTexMip &lastMip = container.mips[uploadedLevels - 1];
+    LveBufferRange staging = uploadBatcher.stage(container.pixels(), lastMip.offset + lastMip.size);
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = imageFormat;
+    imageInfo.mipLevels = this->mipLevels;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.extent = {container.width, container.height, 1};
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (generateMipChain) imageInfo.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+    lveDevice.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageAllocation,
+                                  LveMemoryCategory::Texture);
+
+    VkCommandBuffer commandBuffer = uploadBatcher.getCommandBuffer();
+    transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+    for (uint32_t level = 0; level < uploadedLevels; level++) {
+        const LveTexMip &mip = container.mips[level];
+        // block sizes keep every level offset aligned on a block, as copies require
+        LveBufferRange levelRange = staging;
+        levelRange.offset += mip.offset;
+        levelRange.size = mip.size;
+        uploadBatcher.copyBufferToImage(levelRange, textureImage, mip.width, mip.height, 1,
+                                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, level);
+    }
+
+    imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    if (generateMipChain) {
+        recordMipChain(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+    } else {
+        transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+    uploadToken = uploadBatcher.currentToken();
+
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.compareOp = VK_COMPARE_OP_NEVER;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+    samplerInfo.maxAnisotropy = 4.0f;
+    samplerInfo.anisotropyEnable = VK_TRUE;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_WHITE;
+
+    sampler = lveDevice.getSampler(samplerInfo);
+
+    VkImageViewCreateInfo imageViewInfo{};
+    imageViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    imageViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    imageViewInfo.format = imageFormat;
+    imageViewInfo.components = {VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B,
+                                VK_COMPONENT_SWIZZLE_A};
+    imageViewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    imageViewInfo.subresourceRange.baseMipLevel = 0;
+    imageViewInfo.subresourceRange.baseArrayLayer = 0;
+    imageViewInfo.subresourceRange.layerCount = 1;
+    imageViewInfo.subresourceRange.levelCount = this->mipLevels;
+    imageViewInfo.image = textureImage;
+
+    vkCreateImageView(lveDevice.device(), &imageViewInfo, nullptr, &imageView);
+}
+
+void LveTexture::computeTextureConstructor(const std::string &filepath, uint32_t mipLevels) {
     int width, height, channels;
     int byPerPixel;
 
     stbi_uc *pixels = stbi_load((ENGINE_DIR + filepath).c_str(), &width, &height, &byPerPixel, 4);
-    LveBuffer stagingBuffer{lveDevice, 4, static_cast<u_int32_t>(width * height), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
-    stagingBuffer.map();
-    stagingBuffer.writeToBuffer(pixels);
+    this->width = width;
+    this->height = height;
+    LveUploadBatcher &uploadBatcher = lveDevice.getUploadBatcher();
+    LveBufferRange staging = uploadBatcher.stage(pixels, static_cast<VkDeviceSize>(width) * height * 4);
     imageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    setMipLevels(mipLevels, width, height);
 
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
     imageInfo.format = imageFormat;
-    imageInfo.mipLevels = 1;
+    imageInfo.mipLevels = this->mipLevels;
     imageInfo.arrayLayers = 1;
     imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
     imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     imageInfo.extent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
-    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
+                      VK_IMAGE_USAGE_SAMPLED_BIT;
 
-    lveDevice.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageMemory);
+    lveDevice.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageAllocation,
+                                  LveMemoryCategory::Texture);
 
-    transitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    VkCommandBuffer commandBuffer = uploadBatcher.getCommandBuffer();
+    transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
-    transitionImageLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL);
+    transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL);
     imageLayout = VK_IMAGE_LAYOUT_GENERAL;
 
-    lveDevice.copyBufferToImage(stagingBuffer.getBuffer(), textureImage, static_cast<uint32_t>(width),
-                                static_cast<uint32_t>(height), 1, imageLayout);
+    uploadBatcher.copyBufferToImage(staging, textureImage, static_cast<uint32_t>(width),
+                                    static_cast<uint32_t>(height), 1, imageLayout);
+    if (this->mipLevels > 1) {
+        recordMipChain(commandBuffer, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_TRANSFER_WRITE_BIT,
+                       VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+    }
+    uploadToken = uploadBatcher.currentToken();
 
     VkSamplerCreateInfo samplerInfo{};
     samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -218,12 +440,12 @@ void LveTexture::computeTextureConstructor(const std::string &filepath) {
     samplerInfo.mipLodBias = 0.0f;
     samplerInfo.compareOp = VK_COMPARE_OP_NEVER;  // VK_COMPARE_OP_NEVER
     samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 0.0f;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
     samplerInfo.maxAnisotropy = 4.0f;
     samplerInfo.anisotropyEnable = VK_TRUE;                      // VK_FALSE
     samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_WHITE;  // VK_BORDER_COLOR_INT_OPAQUE_BLACK
 
-    vkCreateSampler(lveDevice.device(), &samplerInfo, nullptr, &sampler);
+    sampler = lveDevice.getSampler(samplerInfo);
 
     VkImageViewCreateInfo imageViewInfo{};
     imageViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -235,16 +457,17 @@ void LveTexture::computeTextureConstructor(const std::string &filepath) {
     imageViewInfo.subresourceRange.baseMipLevel = 0;
     imageViewInfo.subresourceRange.baseArrayLayer = 0;
     imageViewInfo.subresourceRange.layerCount = 1;
-    imageViewInfo.subresourceRange.levelCount = 1;
+    imageViewInfo.subresourceRange.levelCount = this->mipLevels;
     imageViewInfo.image = textureImage;
 
     vkCreateImageView(lveDevice.device(), &imageViewInfo, nullptr, &imageView);
+    createStorageImageViews();
 
     stbi_image_free(pixels);
 }
 
-void LveTexture::transitionImageLayout(VkImageLayout oldLayout, VkImageLayout newLayout) {
-    VkCommandBuffer commandBuffer = lveDevice.beginSingleTimeCommands();
+void LveTexture::transitionImageLayout(VkCommandBuffer commandBuffer, VkImageLayout oldLayout,
+                                       VkImageLayout newLayout) {
 
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -255,9 +478,9 @@ void LveTexture::transitionImageLayout(VkImageLayout oldLayout, VkImageLayout ne
     barrier.image = textureImage;
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;  // VK_IMAGE_ASPECT_COLOR_BIT
     barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.levelCount = mipLevels;
     barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
+    barrier.subresourceRange.layerCount = layerCount;
 
     VkPipelineStageFlags sourceStage;
     VkPipelineStageFlags destinationStage;
@@ -299,26 +522,24 @@ void LveTexture::transitionImageLayout(VkImageLayout oldLayout, VkImageLayout ne
     }
 
     vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-    lveDevice.endSingleTimeCommands(commandBuffer);
 }
 
 void LveTexture::cpuTextureConstructor(int width, int height, void *image, int numberOfChannels,
-                                       VkFormat textureFormat) {
+                                       VkFormat textureFormat, VkSharingMode sharingMode, uint32_t mipLevels) {
     if (textureFormat == VK_FORMAT_R32G32_SFLOAT || textureFormat == VK_FORMAT_R32G32B32A32_SFLOAT)
         numberOfChannels = numberOfChannels * 4;
-    LveBuffer stagingBuffer{lveDevice, (unsigned long)(unsigned int)numberOfChannels,
-                            static_cast<u_int32_t>(width * height), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
-    stagingBuffer.map();
-    stagingBuffer.writeToBuffer(image);
+    else if (textureFormat == VK_FORMAT_R16G16_SFLOAT || textureFormat == VK_FORMAT_R16G16B16A16_SFLOAT)
+        numberOfChannels = numberOfChannels * 2;
+    LveUploadBatcher &uploadBatcher = lveDevice.getUploadBatcher();
+    LveBufferRange staging = uploadBatcher.stage(image, static_cast<VkDeviceSize>(numberOfChannels) * width * height);
     imageFormat = textureFormat;
+    setMipLevels(mipLevels, width, height);
 
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
     imageInfo.format = imageFormat;
-    imageInfo.mipLevels = 1;
+    imageInfo.mipLevels = this->mipLevels;
     imageInfo.arrayLayers = 1;
     imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
@@ -328,16 +549,34 @@ void LveTexture::cpuTextureConstructor(int width, int height, void *image, int n
     imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
                       VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
-    lveDevice.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageMemory);
+    // concurrent sharing needs two distinct families, with a single queue exclusive is equivalent
+    const QueueFamilyIndices &queueFamilies = lveDevice.getQueueFamilies();
+    uint32_t queueFamilyIndices[] = {queueFamilies.graphicsAndComputeFamily, queueFamilies.computeFamily};
+    if (sharingMode == VK_SHARING_MODE_CONCURRENT && lveDevice.hasDedicatedComputeQueue()) {
+        imageInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        imageInfo.queueFamilyIndexCount = 2;
+        imageInfo.pQueueFamilyIndices = queueFamilyIndices;
+    }
 
-    transitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    lveDevice.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageAllocation,
+                                  LveMemoryCategory::Texture);
 
-    lveDevice.copyBufferToImage(stagingBuffer.getBuffer(), textureImage, static_cast<uint32_t>(width),
-                                static_cast<uint32_t>(height), 1);
+    VkCommandBuffer commandBuffer = uploadBatcher.getCommandBuffer();
+    transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
-    transitionImageLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL);
+    uploadBatcher.copyBufferToImage(staging, textureImage, static_cast<uint32_t>(width),
+                                    static_cast<uint32_t>(height), 1);
 
     imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    if (this->mipLevels > 1) {
+        recordMipChain(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_TRANSFER_WRITE_BIT,
+                       VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+    } else {
+        transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL);
+    }
+    uploadToken = uploadBatcher.currentToken();
     VkSamplerCreateInfo samplerInfo{};
     samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
     samplerInfo.magFilter = VK_FILTER_LINEAR;  // VK_FILTER_LINEAR
@@ -349,12 +588,12 @@ void LveTexture::cpuTextureConstructor(int width, int height, void *image, int n
     samplerInfo.mipLodBias = 0.0f;
     samplerInfo.compareOp = VK_COMPARE_OP_NEVER;  // VK_COMPARE_OP_NEVER
     samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 0.0f;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
     samplerInfo.maxAnisotropy = 8.0f;
     samplerInfo.anisotropyEnable = VK_TRUE;                      // VK_FALSE
     samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_WHITE;  // VK_BORDER_COLOR_INT_OPAQUE_BLACK
 
-    vkCreateSampler(lveDevice.device(), &samplerInfo, nullptr, &sampler);
+    sampler = lveDevice.getSampler(samplerInfo);
 
     VkImageViewCreateInfo imageViewInfo{};
     imageViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -366,15 +605,179 @@ void LveTexture::cpuTextureConstructor(int width, int height, void *image, int n
     imageViewInfo.subresourceRange.baseMipLevel = 0;
     imageViewInfo.subresourceRange.baseArrayLayer = 0;
     imageViewInfo.subresourceRange.layerCount = 1;
-    imageViewInfo.subresourceRange.levelCount = 1;
+    imageViewInfo.subresourceRange.levelCount = this->mipLevels;
     imageViewInfo.image = textureImage;
     vkCreateImageView(lveDevice.device(), &imageViewInfo, nullptr, &imageView);
+    createStorageImageViews();
+}
+
+void LveTexture::layeredTextureConstructor(int width, int height, uint32_t layerCount, VkFormat textureFormat,
+                                           VkSharingMode sharingMode, uint32_t mipLevels) {
+    LveUploadBatcher &uploadBatcher = lveDevice.getUploadBatcher();
+    imageFormat = textureFormat;
+    this->layerCount = layerCount;
+    layered = true;
+    setMipLevels(mipLevels, width, height);
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = imageFormat;
+    imageInfo.mipLevels = this->mipLevels;
+    imageInfo.arrayLayers = layerCount;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.extent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
+    imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                      VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+    const QueueFamilyIndices &queueFamilies = lveDevice.getQueueFamilies();
+    uint32_t queueFamilyIndices[] = {queueFamilies.graphicsAndComputeFamily, queueFamilies.computeFamily};
+    if (sharingMode == VK_SHARING_MODE_CONCURRENT && lveDevice.hasDedicatedComputeQueue()) {
+        imageInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        imageInfo.queueFamilyIndexCount = 2;
+        imageInfo.pQueueFamilyIndices = queueFamilyIndices;
+    }
+
+    lveDevice.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageAllocation,
+                                  LveMemoryCategory::Texture);
+
+    // cleared on the GPU, nothing to stage
+    VkCommandBuffer commandBuffer = uploadBatcher.getCommandBuffer();
+    transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    VkClearColorValue clearColor{};
+    VkImageSubresourceRange clearRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, this->mipLevels, 0, layerCount};
+    vkCmdClearColorImage(commandBuffer, textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearColor, 1,
+                         &clearRange);
+    transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL);
+    imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    uploadToken = uploadBatcher.currentToken();
+
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.compareOp = VK_COMPARE_OP_NEVER;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+    samplerInfo.maxAnisotropy = 8.0f;
+    samplerInfo.anisotropyEnable = VK_TRUE;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_WHITE;
+
+    sampler = lveDevice.getSampler(samplerInfo);
+
+    VkImageViewCreateInfo imageViewInfo{};
+    imageViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    imageViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    imageViewInfo.format = imageFormat;
+    imageViewInfo.components = {VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B,
+                                VK_COMPONENT_SWIZZLE_A};
+    imageViewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, this->mipLevels, 0, layerCount};
+    imageViewInfo.image = textureImage;
+    if (vkCreateImageView(lveDevice.device(), &imageViewInfo, nullptr, &imageView) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create layered texture image view!");
+    }
+    createStorageImageViews();
+}
+
+void LveTexture::createStorageImageViews() {
+    // storage image descriptors address a single level of a single layer, only needed when the sampled view holds
+    // a chain or is an array view
+    if (mipLevels == 1 && !layered) return;
+
+    storageImageViews.resize(layerCount);
+    for (uint32_t layer = 0; layer < layerCount; layer++) {
+        VkImageViewCreateInfo imageViewInfo{};
+        imageViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        imageViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        imageViewInfo.format = imageFormat;
+        imageViewInfo.components = {VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B,
+                                    VK_COMPONENT_SWIZZLE_A};
+        imageViewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, layer, 1};
+        imageViewInfo.image = textureImage;
+        if (vkCreateImageView(lveDevice.device(), &imageViewInfo, nullptr, &storageImageViews[layer]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create texture storage image view!");
+        }
+    }
+}
+
+void LveTexture::generateMipmaps(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStage,
+                                 VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+    if (mipLevels == 1) return;
+    assert(imageLayout == VK_IMAGE_LAYOUT_GENERAL && "Per frame mipmaps need a texture kept in GENERAL layout");
+    recordMipChain(commandBuffer, imageLayout, srcStage, srcAccess, dstStage, dstAccess);
+}
+
+void LveTexture::recordMipChain(VkCommandBuffer commandBuffer, VkImageLayout oldLayout, VkPipelineStageFlags srcStage,
+                                VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+    // GENERAL textures are blitted in place, uploads go through the transfer layouts
+    bool inPlace = oldLayout == VK_IMAGE_LAYOUT_GENERAL;
+    VkImageLayout blitSrcLayout = inPlace ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    VkImageLayout blitDstLayout = inPlace ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+
+    auto levelBarrier = [&](uint32_t baseLevel, uint32_t levelCount, VkImageLayout from, VkImageLayout to,
+                            VkAccessFlags fromAccess, VkAccessFlags toAccess) {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = fromAccess;
+        barrier.dstAccessMask = toAccess;
+        barrier.oldLayout = from;
+        barrier.newLayout = to;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = textureImage;
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, baseLevel, levelCount, 0, layerCount};
+        return barrier;
+    };
+
+    // level 0 becomes the first source, the content of the smaller levels is discarded
+    VkImageMemoryBarrier startBarriers[] = {
+        levelBarrier(0, 1, oldLayout, blitSrcLayout, srcAccess, VK_ACCESS_TRANSFER_READ_BIT),
+        levelBarrier(1, mipLevels - 1, VK_IMAGE_LAYOUT_UNDEFINED, blitDstLayout, 0, VK_ACCESS_TRANSFER_WRITE_BIT)};
+    vkCmdPipelineBarrier(commandBuffer, srcStage, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 2,
+                         startBarriers);
+
+    int32_t mipWidth = width;
+    int32_t mipHeight = height;
+    for (uint32_t level = 1; level < mipLevels; level++) {
+        VkImageBlit blit{};
+        blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
+        blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, layerCount};
+        mipWidth = std::max(mipWidth / 2, 1);
+        mipHeight = std::max(mipHeight / 2, 1);
+        blit.dstOffsets[1] = {mipWidth, mipHeight, 1};
+        blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, layerCount};
+        vkCmdBlitImage(commandBuffer, textureImage, blitSrcLayout, textureImage, blitDstLayout, 1, &blit, mipFilter);
+
+        // the level just written is the source of the next one
+        if (level + 1 < mipLevels) {
+            VkImageMemoryBarrier barrier = levelBarrier(level, 1, blitDstLayout, blitSrcLayout,
+                                                        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                                 nullptr, 0, nullptr, 1, &barrier);
+        }
+    }
+
+    VkImageMemoryBarrier endBarriers[] = {
+        levelBarrier(0, mipLevels - 1, blitSrcLayout, imageLayout, VK_ACCESS_TRANSFER_READ_BIT, dstAccess),
+        levelBarrier(mipLevels - 1, 1, blitDstLayout, imageLayout, VK_ACCESS_TRANSFER_WRITE_BIT, dstAccess)};
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, 0, 0, nullptr, 0, nullptr, 2,
+                         endBarriers);
 }
 
 void LveTexture::copyTexture(VkCommandBuffer commandBuffer, std::shared_ptr<LveTexture> textureFromCopy,
                              std::shared_ptr<LveTexture> textureToCopy) {
     VkImageMemoryBarrier transferFromImageBarrier{};
     transferFromImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    transferFromImageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    transferFromImageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     transferFromImageBarrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
     transferFromImageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
     transferFromImageBarrier.oldLayout = textureFromCopy->getImageLayout();
@@ -384,6 +787,8 @@ void LveTexture::copyTexture(VkCommandBuffer commandBuffer, std::shared_ptr<LveT
 
     VkImageMemoryBarrier transferToImageBarrier{};
     transferToImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    transferToImageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    transferToImageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     transferToImageBarrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
     transferToImageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
     transferToImageBarrier.oldLayout = textureToCopy->getImageLayout();
@@ -412,6 +817,8 @@ void LveTexture::copyTexture(VkCommandBuffer commandBuffer, std::shared_ptr<LveT
 
     VkImageMemoryBarrier transferFromBackImageBarrier{};
     transferFromBackImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    transferFromBackImageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    transferFromBackImageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     transferFromBackImageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
     transferFromBackImageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
     transferFromBackImageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
@@ -424,6 +831,8 @@ void LveTexture::copyTexture(VkCommandBuffer commandBuffer, std::shared_ptr<LveT
 
     VkImageMemoryBarrier transferToBackImageBarrier{};
     transferToBackImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    transferToBackImageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    transferToBackImageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     transferToBackImageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
     transferToBackImageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
     transferToBackImageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
@@ -436,10 +845,12 @@ void LveTexture::copyTexture(VkCommandBuffer commandBuffer, std::shared_ptr<LveT
 }
 
 LveTexture::~LveTexture() {
-    vkDestroyImage(lveDevice.device(), textureImage, nullptr);
-    vkFreeMemory(lveDevice.device(), textureImageMemory, nullptr);
-    vkDestroyImageView(lveDevice.device(), imageView, nullptr);
-    vkDestroySampler(lveDevice.device(), sampler, nullptr);
+    if (bindlessIndex != LveBindlessTable::NO_TEXTURE) lveDevice.getBindlessTable().unregisterTexture(bindlessIndex);
+    LveDeletionQueue &deletionQueue = lveDevice.getDeletionQueue();
+    deletionQueue.destroyImageView(imageView);
+    for (VkImageView storageImageView : storageImageViews) deletionQueue.destroyImageView(storageImageView);
+    // the sampler is shared, it belongs to the device
+    deletionQueue.destroyImage(textureImage, textureImageAllocation);
 }
 
 }  // namespace lve
\ No newline at end of file
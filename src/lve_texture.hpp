@@ -5,29 +5,70 @@
 #include <memory>
 #include <vector>
 
+#include "lve_bindless_table.hpp"
 #include "lve_device.hpp"
+#include "lve_texture_container.hpp"
+#include "lve_upload_batcher.hpp"
 
 namespace lve {
 class LveTexture {
    public:
-    LveTexture(LveDevice& device, const std::string& filepath, bool isComputeTexture);
-    LveTexture(LveDevice& device, int width, int height);
+    // mipLevels value requesting every level down to 1x1
+    static constexpr uint32_t FULL_MIP_CHAIN = 0;
 
-    LveTexture(LveDevice& device, int width, int height, void* image, int numberOfChannels, VkFormat textureFormat);
+    // Loaded images get their mip chain generated on the GPU during the upload. An up to date .lvetex baked next to
+    // the image (tools/texture_baker) is used instead when the device can sample its format, with its own mips
+    LveTexture(LveDevice& device, const std::string& filepath, bool isComputeTexture,
+               uint32_t mipLevels = FULL_MIP_CHAIN);
+    LveTexture(LveDevice& device, int width, int height, uint32_t mipLevels = 1);
+
+    // CONCURRENT lets the graphics and the async compute queue use the image without ownership transfers,
+    // EXCLUSIVE images used on both need explicit release / acquire barriers
+    LveTexture(LveDevice& device, int width, int height, void* image, int numberOfChannels, VkFormat textureFormat,
+               VkSharingMode sharingMode = VK_SHARING_MODE_CONCURRENT, uint32_t mipLevels = 1);
+    // Layered texture written by compute shaders, zeroed and kept in GENERAL layout. It is sampled as a
+    // sampler2DArray through its own descriptor sets, not the bindless table
+    LveTexture(LveDevice& device, int width, int height, uint32_t layerCount, VkFormat textureFormat,
+               VkSharingMode sharingMode = VK_SHARING_MODE_CONCURRENT, uint32_t mipLevels = 1);
     ~LveTexture();
 
     VkSampler getSampler() const { return sampler; }
+    // View over every mip level (and every layer of layered textures), to sample the texture
     VkImageView getImageView() const { return imageView; }
+    // Single level view of mip 0 of one layer, to bind the texture as a storage image
+    VkImageView getStorageImageView(uint32_t layer = 0) const {
+        return storageImageViews.empty() ? imageView : storageImageViews[layer];
+    }
+    uint32_t getMipLevels() const { return mipLevels; }
+    uint32_t getLayerCount() const { return layerCount; }
+    VkFormat getFormat() const { return imageFormat; }
+    // Slot in the device's bindless table, NO_TEXTURE for textures that can't be sampled (post processing)
+    uint32_t getBindlessIndex() const { return bindlessIndex; }
     VkImageLayout getImageLayout() const { return imageLayout; }
     VkImage getTextureImage() const { return textureImage; }
+    // Completes once the image content and its initial layout transition have executed
+    LveUploadBatcher::Token getUploadToken() const { return uploadToken; }
+
+    void objectTextureConstructor(const std::string& filepath, uint32_t mipLevels);
+
+    void computeTextureConstructor(const std::string& filepath, uint32_t mipLevels);
+
+    void postprocessingTextureConstructor(int width, int height, uint32_t mipLevels);
 
-    void objectTextureConstructor(const std::string& filepath);
+    void cpuTextureConstructor(int width, int height, void* image, int numberOfChannels, VkFormat textureFormat,
+                               VkSharingMode sharingMode, uint32_t mipLevels);
 
-    void computeTextureConstructor(const std::string& filepath);
+    void layeredTextureConstructor(int width, int height, uint32_t layerCount, VkFormat textureFormat,
+                                   VkSharingMode sharingMode, uint32_t mipLevels);
 
-    void postprocessingTextureConstructor(int width, int height);
+    // Rebuilds levels 1.. from level 0 with a chain of blits (every layer at once), for textures rewritten every
+    // frame. The image stays in its layout (GENERAL), level 0 must have been written before srcStage / srcAccess and
+    // every level is ready for dstStage / dstAccess afterwards. Needs a graphics queue, does nothing on single level textures
+    void generateMipmaps(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess,
+                         VkPipelineStageFlags dstStage, VkAccessFlags dstAccess);
 
-    void cpuTextureConstructor(int width, int height, void* image, int numberOfChannels, VkFormat textureFormat);
+    static uint32_t fullMipCount(int width, int height);
+    static VkFormat toVkFormat(LveTexFormat format, bool srgb);
 
     static void copyTexture(VkCommandBuffer commandBuffer, std::shared_ptr<LveTexture> textureFromCopy,
                             std::shared_ptr<LveTexture> textureToCopy);
@@ -38,12 +79,30 @@ class LveTexture {
    private:
     LveDevice& lveDevice;
     VkImage textureImage;
-    VkDeviceMemory textureImageMemory;
+    LveAllocation textureImageAllocation{};
     VkImageView imageView;
+    // one per layer, empty when the sampled view is a single level 2D view that storage descriptors can use
+    std::vector<VkImageView> storageImageViews;
     VkSampler sampler;
     VkFormat imageFormat;
     VkImageLayout imageLayout;
+    uint32_t mipLevels = 1;
+    uint32_t layerCount = 1;
+    // layered textures always get a 2D_ARRAY view, even with a single layer
+    bool layered = false;
+    VkFilter mipFilter = VK_FILTER_LINEAR;
+    LveUploadBatcher::Token uploadToken = 0;
+    uint32_t bindlessIndex = LveBindlessTable::NO_TEXTURE;
 
-    void transitionImageLayout(VkImageLayout oldLayout, VkImageLayout newLayout);
+    void transitionImageLayout(VkCommandBuffer commandBuffer, VkImageLayout oldLayout, VkImageLayout newLayout);
+    // Loads the baked container of filepath, false when there is none, it is stale or its format is unsupported
+    bool loadBakedTexture(const std::string& filepath, uint32_t mipLevels);
+    // Uploads the levels of a baked texture or of a texture cache entry, RGBA8 ones missing levels get them blitted
+    void containerTextureConstructor(const LveTexContainer& container, VkFormat format, uint32_t mipLevels);
+    // Resolves FULL_MIP_CHAIN and checks the format can be blitted, before the image is created
+    void setMipLevels(uint32_t requestedLevels, int width, int height);
+    void recordMipChain(VkCommandBuffer commandBuffer, VkImageLayout oldLayout, VkPipelineStageFlags srcStage,
+                        VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess);
+    void createStorageImageViews();
 };
 }  // namespace lve
\ No newline at end of file
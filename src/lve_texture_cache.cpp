@@ -0,0 +1,114 @@
+#include "lve_texture_cache.hpp"
+
+#include "lve_file_mapping.hpp"
+
+// std
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace lve {
+
+namespace {
+
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+uint64_t fnv1a(const uint8_t *data, size_t size) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+uint64_t fnv1a(const std::string &text) { return fnv1a(reinterpret_cast<const uint8_t *>(text.data()), text.size()); }
+
+std::string toHex(uint64_t value) {
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+    return buffer;
+}
+
+}  // namespace
+
+LveTextureCache::LveTextureCache(std::string directory) : directory{std::move(directory)} {}
+
+LveTextureCache::Key LveTextureCache::makeKey(const std::string &sourcePath, const std::string &importOptions) {
+    std::error_code error;
+    uint64_t size = fs::file_size(sourcePath, error);
+    if (error) return {};
+    int64_t modificationTime = fs::last_write_time(sourcePath, error).time_since_epoch().count();
+    if (error) return {};
+
+    // the same file reached through another relative path shares its stamp
+    fs::path normalizedPath = fs::absolute(sourcePath, error).lexically_normal();
+    std::string stampPath = directory + toHex(fnv1a(error ? sourcePath : normalizedPath.string())) + ".stamp";
+
+    Stamp stamp{};
+    std::ifstream stampFile{stampPath, std::ios::binary};
+    bool stampFound = static_cast<bool>(stampFile.read(reinterpret_cast<char *>(&stamp), sizeof(stamp)));
+    stampFile.close();
+
+    if (!stampFound || stamp.size != size || stamp.modificationTime != modificationTime) {
+        std::unique_ptr<LveFileMapping> source = LveFileMapping::map(sourcePath);
+        if (!source) return {};
+        uint64_t contentHash = fnv1a(source->data(), source->size());
+
+        // the entries of the previous content would never be looked up again
+        if (stampFound && stamp.contentHash != contentHash) {
+            std::string stalePrefix = toHex(stamp.contentHash) + "-";
+            for (const fs::directory_entry &entry : fs::directory_iterator(directory, error)) {
+                if (entry.path().filename().string().rfind(stalePrefix, 0) == 0) fs::remove(entry.path(), error);
+            }
+        }
+
+        stamp = {size, modificationTime, contentHash};
+        fs::create_directories(directory, error);
+        std::ofstream file{stampPath, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<const char *>(&stamp), sizeof(stamp));
+        if (!file) {
+            std::cerr << "texture cache : failed to write " << stampPath << std::endl;
+        }
+    }
+
+    return Key{directory + toHex(stamp.contentHash) + "-" + toHex(fnv1a(importOptions)) + ".lvetex"};
+}
+
+bool LveTextureCache::find(const Key &key, LveTexContainer &entry) {
+    std::error_code error;
+    if (!key.isValid() || !fs::exists(key.entryPath, error)) {
+        missCount++;
+        return false;
+    }
+    try {
+        entry = LveTexContainer::map(key.entryPath);
+    } catch (const std::exception &e) {
+        // unreadable entry, it is rebuilt by the store following the miss
+        std::cerr << "texture cache : " << e.what() << ", entry ignored" << std::endl;
+        missCount++;
+        return false;
+    }
+    hitCount++;
+    return true;
+}
+
+void LveTextureCache::store(const Key &key, const LveTexContainer &entry) {
+    if (!key.isValid()) return;
+    std::string temporaryPath = key.entryPath + ".tmp";
+    try {
+        fs::create_directories(directory);
+        entry.save(temporaryPath);
+        // a crash during the write leaves a .tmp, never a truncated entry
+        fs::rename(temporaryPath, key.entryPath);
+    } catch (const std::exception &e) {
+        std::cerr << "texture cache : failed to store " << key.entryPath << " (" << e.what() << ")" << std::endl;
+    }
+}
+
+}  // namespace lve
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "lve_texture_container.hpp"
+
+// std
+#include <cstdint>
+#include <string>
+
+// relative to the working directory, which is the build directory
+#ifndef TEXTURE_CACHE_DIR
+#define TEXTURE_CACHE_DIR "texture_cache/"
+#endif
+
+namespace lve {
+
+/*
+ * On disk cache of decoded images, so a startup maps the pixels LveTexture uploads instead of running stb_image.
+ *
+ * Entries are .lvetex containers named after a hash of the source content and of the import options (anything that
+ * changes the stored pixels : format, orientation...). Each source also gets a small stamp with its size,
+ * modification time and content hash. While the stamp matches, the source isn't read at all. Once it changes, the
+ * content is hashed again : an edited image gets a new entry, a touched but identical one still hits.
+ */
+class LveTextureCache {
+   public:
+    struct Key {
+        std::string entryPath;
+        bool isValid() const { return !entryPath.empty(); }
+    };
+
+    explicit LveTextureCache(std::string directory = TEXTURE_CACHE_DIR);
+
+    LveTextureCache(const LveTextureCache &) = delete;
+    LveTextureCache &operator=(const LveTextureCache &) = delete;
+
+    // Invalid key when the source can't be read, the caller then reports the load failure itself
+    Key makeKey(const std::string &sourcePath, const std::string &importOptions);
+    // Maps the entry, false on a miss
+    bool find(const Key &key, LveTexContainer &entry);
+    // A failed write only costs the next startup a decode, it is reported and ignored
+    void store(const Key &key, const LveTexContainer &entry);
+
+    uint32_t getHitCount() const { return hitCount; }
+    uint32_t getMissCount() const { return missCount; }
+
+   private:
+    struct Stamp {
+        uint64_t size;
+        int64_t modificationTime;
+        uint64_t contentHash;
+    };
+
+    std::string directory;
+    uint32_t hitCount = 0;
+    uint32_t missCount = 0;
+};
+
+}  // namespace lve
@@ -0,0 +1,145 @@
+#include "lve_texture_container.hpp"
+
+// std
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace lve {
+
+namespace {
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t format;
+    uint32_t flags;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipCount;
+    uint32_t reserved;
+};
+
+constexpr char MAGIC[4] = {'L', 'V', 'T', 'X'};
+
+}  // namespace
+
+uint32_t LveTexContainer::blockSize(LveTexFormat format) {
+    switch (format) {
+        case LveTexFormat::RGBA8:
+            return 4;
+        case LveTexFormat::BC1:
+            return 8;
+        case LveTexFormat::BC3:
+        case LveTexFormat::BC5:
+        case LveTexFormat::BC7:
+            return 16;
+    }
+    throw std::runtime_error("unknown texture container format!");
+}
+
+uint64_t LveTexContainer::mipSize(LveTexFormat format, uint32_t width, uint32_t height) {
+    if (format == LveTexFormat::RGBA8) {
+        return static_cast<uint64_t>(width) * height * blockSize(format);
+    }
+    uint64_t blocksX = (width + 3) / 4;
+    uint64_t blocksY = (height + 3) / 4;
+    return blocksX * blocksY * blockSize(format);
+}
+
+void LveTexContainer::addMip(uint32_t mipWidth, uint32_t mipHeight, const void *pixels) {
+    LveTexMip mip{mipWidth, mipHeight, data.size(), mipSize(format, mipWidth, mipHeight)};
+    data.resize(data.size() + mip.size);
+    memcpy(data.data() + mip.offset, pixels, mip.size);
+    mips.push_back(mip);
+}
+
+void LveTexContainer::save(const std::string &filepath) const {
+    std::string temporaryPath = filepath + ".tmp";
+    std::ofstream file{temporaryPath, std::ios::binary | std::ios::trunc};
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open texture container for writing: " + temporaryPath);
+    }
+
+    FileHeader header{};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.format = static_cast<uint32_t>(format);
+    header.flags = flags;
+    header.width = width;
+    header.height = height;
+    header.mipCount = static_cast<uint32_t>(mips.size());
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(mips.data()), sizeof(LveTexMip) * mips.size());
+    file.write(reinterpret_cast<const char *>(pixels()), pixelsSize());
+    file.close();
+    std::error_code error;
+    if (!file) {
+        fs::remove(temporaryPath, error);
+        throw std::runtime_error("failed to write texture container: " + temporaryPath);
+    }
+    fs::rename(temporaryPath, filepath, error);
+    if (error) {
+        fs::remove(temporaryPath, error);
+        throw std::runtime_error("failed to replace texture container: " + filepath);
+    }
+}
+
+LveTexContainer LveTexContainer::map(const std::string &filepath) {
+    std::unique_ptr<LveFileMapping> fileMapping = LveFileMapping::map(filepath);
+    if (!fileMapping) {
+        throw std::runtime_error("failed to open texture container: " + filepath);
+    }
+    const uint8_t *bytes = fileMapping->data();
+    uint64_t fileSize = fileMapping->size();
+
+    FileHeader header{};
+    if (fileSize < sizeof(header)) {
+        throw std::runtime_error("invalid texture container: " + filepath);
+    }
+    memcpy(&header, bytes, sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+        throw std::runtime_error("invalid texture container: " + filepath);
+    }
+    if (header.format > static_cast<uint32_t>(LveTexFormat::BC7) || header.mipCount == 0) {
+        throw std::runtime_error("unsupported texture container content: " + filepath);
+    }
+
+    uint64_t dataOffset = sizeof(header) + sizeof(LveTexMip) * static_cast<uint64_t>(header.mipCount);
+    if (dataOffset > fileSize) {
+        throw std::runtime_error("truncated texture container: " + filepath);
+    }
+
+    LveTexContainer container{};
+    container.format = static_cast<LveTexFormat>(header.format);
+    container.flags = header.flags;
+    container.width = header.width;
+    container.height = header.height;
+    container.mips.resize(header.mipCount);
+    memcpy(container.mips.data(), bytes + sizeof(header), sizeof(LveTexMip) * header.mipCount);
+
+    for (const LveTexMip &mip : container.mips) {
+        if (mip.offset + mip.size > fileSize - dataOffset ||
+            mip.size != mipSize(container.format, mip.width, mip.height)) {
+            throw std::runtime_error("corrupted texture container: " + filepath);
+        }
+    }
+    container.mapping = std::move(fileMapping);
+    container.mappedDataOffset = dataOffset;
+    return container;
+}
+
+LveTexContainer LveTexContainer::load(const std::string &filepath) {
+    LveTexContainer container = map(filepath);
+    container.data.assign(container.pixels(), container.pixels() + container.pixelsSize());
+    container.mapping.reset();
+    container.mappedDataOffset = 0;
+    return container;
+}
+
+}  // namespace lve
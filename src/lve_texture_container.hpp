@@ -0,0 +1,73 @@
+#pragma once
+
+#include "lve_file_mapping.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+// Pixel layout of a container, independent of Vulkan so the offline tools can share it
+enum class LveTexFormat : uint32_t {
+    RGBA8 = 0,
+    BC1 = 1,  // RGB, 4 bits per pixel
+    BC3 = 2,  // RGBA with smooth alpha, 8 bits per pixel
+    BC5 = 3,  // two channels (normal maps), 8 bits per pixel
+    BC7 = 4,  // RGBA, 8 bits per pixel
+};
+
+struct LveTexMip {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;  // from the start of the pixel data
+    uint64_t size;
+};
+
+/*
+ * .lvetex file : a texture stored with all its mip levels already in their GPU format, produced offline by the
+ * texture baker so the engine only has to copy the levels to the image.
+ *
+ * Layout (little endian) : header {"LVTX", version, format, flags, width, height, mipCount, reserved}, one
+ * LveTexMip per level from the largest, then the pixel data of every level.
+ *
+ * A container is either loaded (data owns the pixels) or mapped (the pixels stay in the file mapping), pixels()
+ * reads both.
+ */
+struct LveTexContainer {
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t FLAG_SRGB = 1u << 0;
+
+    LveTexFormat format = LveTexFormat::RGBA8;
+    uint32_t flags = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<LveTexMip> mips;
+    std::vector<uint8_t> data;
+
+    const uint8_t *pixels() const { return mapping ? mapping->data() + mappedDataOffset : data.data(); }
+    uint64_t pixelsSize() const { return mapping ? mapping->size() - mappedDataOffset : data.size(); }
+    bool isSrgb() const { return (flags & FLAG_SRGB) != 0; }
+    bool isBlockCompressed() const { return format != LveTexFormat::RGBA8; }
+
+    // Appends a level after the existing ones, pixels holds mipSize(format, width, height) bytes
+    void addMip(uint32_t mipWidth, uint32_t mipHeight, const void *pixels);
+
+    // Writes a temporary file then renames it over filepath : a crash or a concurrent reader never sees it truncated
+    void save(const std::string &filepath) const;
+    static LveTexContainer load(const std::string &filepath);
+    // Maps the file instead of reading it, the mapping lives as long as the container (and its copies)
+    static LveTexContainer map(const std::string &filepath);
+
+    // Bytes of one 4x4 block, or of one pixel for RGBA8
+    static uint32_t blockSize(LveTexFormat format);
+    static uint64_t mipSize(LveTexFormat format, uint32_t width, uint32_t height);
+
+   private:
+    std::shared_ptr<LveFileMapping> mapping;
+    uint64_t mappedDataOffset = 0;
+};
+
+}  // namespace lve
@@ -0,0 +1,249 @@
+#include "lve_upload_batcher.hpp"
+
+// std
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace lve {
+
+LveUploadBatcher::LveUploadBatcher(LveDevice &device) : lveDevice{device} {
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = lveDevice.findPhysicalQueueFamilies().graphicsAndComputeFamily;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+    if (vkCreateCommandPool(lveDevice.device(), &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create upload command pool!");
+    }
+
+    VkSemaphoreTypeCreateInfoKHR typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+    if (vkCreateSemaphore(lveDevice.device(), &semaphoreInfo, nullptr, &timeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create upload timeline semaphore!");
+    }
+}
+
+LveUploadBatcher::~LveUploadBatcher() {
+    waitIdle();
+    for (VkFence fence : freeFences) {
+        vkDestroyFence(lveDevice.device(), fence, nullptr);
+    }
+    vkDestroySemaphore(lveDevice.device(), timeline, nullptr);
+    vkDestroyCommandPool(lveDevice.device(), commandPool, nullptr);
+}
+
+void LveUploadBatcher::beginBatch() {
+    recording = std::make_unique<Batch>();
+    recording->token = nextToken++;
+
+    if (freeCommandBuffers.empty()) {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = commandPool;
+        allocInfo.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(lveDevice.device(), &allocInfo, &recording->commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate upload command buffer!");
+        }
+    } else {
+        recording->commandBuffer = freeCommandBuffers.back();
+        freeCommandBuffers.pop_back();
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(recording->commandBuffer, &beginInfo);
+}
+
+VkCommandBuffer LveUploadBatcher::getCommandBuffer() {
+    std::lock_guard<std::mutex> lock{mutex};
+    if (!recording) beginBatch();
+    return recording->commandBuffer;
+}
+
+void LveUploadBatcher::setFrameRing(LveFrameRing *ring) {
+    std::lock_guard<std::mutex> lock{mutex};
+    frameRing = ring;
+}
+
+LveBufferRange LveUploadBatcher::stage(const void *data, VkDeviceSize size) {
+    LveBufferRange range{};
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (frameRing != nullptr && frameRing->tryAllocateStaging(size, range)) {
+            // staging memory is only ever written by the CPU, large copies skip the caches
+            if (size >= LveBuffer::STREAMING_THRESHOLD) {
+                LveBuffer::streamCopy(range.mapped, data, size);
+            } else {
+                memcpy(range.mapped, data, size);
+            }
+            return range;
+        }
+    }
+
+    // outside of a frame or too big for the ring : dedicated buffer released with the batch. It is transient, so it
+    // stays Staging even when a subsystem's memory scope is open around the upload
+    LveMemoryScope memoryScope{LveMemoryCategory::Staging};
+    auto stagingBuffer = std::make_unique<LveBuffer>(
+        lveDevice, size, 1, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 1, LveMemoryCategory::Staging);
+    stagingBuffer->map();
+    if (size >= LveBuffer::STREAMING_THRESHOLD) {
+        stagingBuffer->writeToBufferStreaming(data, size);
+    } else {
+        stagingBuffer->writeToBuffer(const_cast<void *>(data), size);
+    }
+    stagingBuffer->unmap();
+
+    range.buffer = stagingBuffer->getBuffer();
+    range.offset = 0;
+    range.size = size;
+    retain(std::move(stagingBuffer));
+    return range;
+}
+
+void LveUploadBatcher::retain(std::unique_ptr<LveBuffer> buffer) {
+    std::lock_guard<std::mutex> lock{mutex};
+    if (!recording) beginBatch();
+    recording->retainedBuffers.push_back(std::move(buffer));
+}
+
+void LveUploadBatcher::copyBuffer(const LveBufferRange &src, VkBuffer dstBuffer, VkDeviceSize dstOffset) {
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = src.offset;
+    copyRegion.dstOffset = dstOffset;
+    copyRegion.size = src.size;
+    vkCmdCopyBuffer(getCommandBuffer(), src.buffer, dstBuffer, 1, &copyRegion);
+}
+
+void LveUploadBatcher::copyBufferToImage(const LveBufferRange &src, VkImage image, uint32_t width, uint32_t height,
+                                         uint32_t layerCount, VkImageLayout imageLayout, uint32_t mipLevel) {
+    VkBufferImageCopy region{};
+    region.bufferOffset = src.offset;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = mipLevel;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = layerCount;
+
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {width, height, 1};
+
+    vkCmdCopyBufferToImage(getCommandBuffer(), src.buffer, image, imageLayout, 1, &region);
+}
+
+LveUploadBatcher::Token LveUploadBatcher::currentToken() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return recording ? recording->token : nextToken - 1;
+}
+
+LveUploadBatcher::Token LveUploadBatcher::submit() {
+    std::lock_guard<std::mutex> lock{mutex};
+    collectLocked();
+    return submitLocked();
+}
+
+LveUploadBatcher::Token LveUploadBatcher::submitLocked() {
+    if (!recording) return nextToken - 1;
+
+    // make the uploads visible to everything submitted after this batch on the queue
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    vkCmdPipelineBarrier(recording->commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    if (vkEndCommandBuffer(recording->commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record upload command buffer!");
+    }
+
+    if (freeFences.empty()) {
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        if (vkCreateFence(lveDevice.device(), &fenceInfo, nullptr, &recording->fence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create upload fence!");
+        }
+    } else {
+        recording->fence = freeFences.back();
+        freeFences.pop_back();
+    }
+
+    // tokens are submitted in increasing order, the timeline only moves forward
+    uint64_t signalValue = recording->token;
+    VkTimelineSemaphoreSubmitInfoKHR timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &recording->commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &timeline;
+
+    if (vkQueueSubmit(lveDevice.graphicsQueue(), 1, &submitInfo, recording->fence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit upload command buffer!");
+    }
+
+    Token token = recording->token;
+    inFlight.push_back(std::move(*recording));
+    recording.reset();
+    return token;
+}
+
+bool LveUploadBatcher::isComplete(Token token) {
+    std::lock_guard<std::mutex> lock{mutex};
+    collectLocked();
+    return token <= completedToken;
+}
+
+void LveUploadBatcher::wait(Token token) {
+    std::lock_guard<std::mutex> lock{mutex};
+    if (token <= completedToken) return;
+
+    if (recording && token >= recording->token) submitLocked();
+    for (Batch &batch : inFlight) {
+        if (batch.token > token) break;
+        vkWaitForFences(lveDevice.device(), 1, &batch.fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+    }
+    collectLocked();
+}
+
+void LveUploadBatcher::waitIdle() { wait(currentToken()); }
+
+void LveUploadBatcher::collect() {
+    std::lock_guard<std::mutex> lock{mutex};
+    collectLocked();
+}
+
+void LveUploadBatcher::collectLocked() {
+    while (!inFlight.empty() && vkGetFenceStatus(lveDevice.device(), inFlight.front().fence) == VK_SUCCESS) {
+        completedToken = inFlight.front().token;
+        recycle(inFlight.front());
+        inFlight.pop_front();
+    }
+}
+
+void LveUploadBatcher::recycle(Batch &batch) {
+    batch.retainedBuffers.clear();
+    vkResetFences(lveDevice.device(), 1, &batch.fence);
+    freeFences.push_back(batch.fence);
+    vkResetCommandBuffer(batch.commandBuffer, 0);
+    freeCommandBuffers.push_back(batch.commandBuffer);
+}
+
+}  // namespace lve
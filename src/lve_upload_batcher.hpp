@@ -0,0 +1,95 @@
+#pragma once
+
+#include "lve_buffer.hpp"
+#include "lve_device.hpp"
+#include "lve_frame_ring.hpp"
+
+// std
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lve {
+
+/*
+ * Collects resource uploads (buffer copies, image copies, layout transitions) into one command buffer
+ * and submits them together with a fence, instead of one vkQueueWaitIdle per operation.
+ *
+ * Every batch ends with a full memory barrier, so any work submitted afterwards on the graphics queue
+ * sees the uploaded data without extra synchronisation. Other queues wait on the batch's timeline semaphore,
+ * which reaches the token once the batch has executed. The CPU only blocks when it explicitly waits on a token.
+ *
+ * While a frame is in progress, staging data goes to the renderer's frame ring instead of a new buffer.
+ * The renderer submits the batch before the frame's fenced submit, so the fence also covers the copies.
+ */
+class LveUploadBatcher {
+   public:
+    using Token = uint64_t;
+
+    explicit LveUploadBatcher(LveDevice &device);
+    ~LveUploadBatcher();
+
+    LveUploadBatcher(const LveUploadBatcher &) = delete;
+    LveUploadBatcher &operator=(const LveUploadBatcher &) = delete;
+
+    // Command buffer of the batch being recorded, opened on first use
+    VkCommandBuffer getCommandBuffer();
+
+    // Copies data into host visible staging memory that stays valid until the batch has completed
+    LveBufferRange stage(const void *data, VkDeviceSize size);
+    // Keeps a buffer alive until the batch being recorded has completed on the GPU
+    void retain(std::unique_ptr<LveBuffer> buffer);
+
+    // Frame ring used for staging while a frame is in progress, nullptr disables it
+    void setFrameRing(LveFrameRing *ring);
+
+    void copyBuffer(const LveBufferRange &src, VkBuffer dstBuffer, VkDeviceSize dstOffset = 0);
+    void copyBufferToImage(const LveBufferRange &src, VkImage image, uint32_t width, uint32_t height,
+                           uint32_t layerCount, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           uint32_t mipLevel = 0);
+
+    // Token completed once everything recorded so far has executed
+    Token currentToken();
+    // Submits the batch being recorded (no-op when empty) and returns its token
+    Token submit();
+    bool isComplete(Token token);
+    // Submits if needed, then blocks until the token's batch has executed
+    void wait(Token token);
+    void waitIdle();
+    // Signaled to the token of every batch when it completes, for queues the batch's barrier doesn't cover
+    VkSemaphore getTimeline() const { return timeline; }
+
+    // Releases staging memory and command buffers of finished batches
+    void collect();
+
+   private:
+    struct Batch {
+        Token token;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        std::vector<std::unique_ptr<LveBuffer>> retainedBuffers;
+    };
+
+    void beginBatch();
+    Token submitLocked();
+    void collectLocked();
+    void recycle(Batch &batch);
+
+    LveDevice &lveDevice;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkSemaphore timeline = VK_NULL_HANDLE;
+    LveFrameRing *frameRing = nullptr;
+
+    std::unique_ptr<Batch> recording;
+    std::deque<Batch> inFlight;
+    std::vector<VkCommandBuffer> freeCommandBuffers;
+    std::vector<VkFence> freeFences;
+
+    Token nextToken = 1;
+    Token completedToken = 0;
+    std::mutex mutex;
+};
+
+}  // namespace lve
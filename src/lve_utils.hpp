@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "lve_device.hpp"
+#include "lve_vertex_format.hpp"
 
 namespace lve {
 
@@ -35,11 +36,8 @@ struct PipelineCreateInfo {
     uint32_t pushConstantRangeSize = 0;
     LvePipelIneFunctionnality functionnality = LvePipelIneFunctionnality::None;
     VkRenderPass renderPass;
-};
-
-struct SynchronisationObjects {
-    std::vector<VkSemaphore> semaphores;
-    std::vector<VkFence> fences;
+    // vertex input of render pipelines drawing models
+    LveVertexFormat vertexFormat = LveVertexFormat::Full;
 };
 
 }  // namespace lve
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "lve_vertex_format.hpp"
+
+// libs
+#include <glm/gtc/packing.hpp>
+
+// std
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+namespace lve {
+
+namespace {
+
+uint16_t quantizeUnorm16(float value) {
+    return static_cast<uint16_t>(std::lround(glm::clamp(value, 0.f, 1.f) * 65535.f));
+}
+
+int16_t quantizeSnorm16(float value) {
+    return static_cast<int16_t>(std::lround(glm::clamp(value, -1.f, 1.f) * 32767.f));
+}
+
+uint8_t quantizeUnorm8(float value) { return static_cast<uint8_t>(std::lround(glm::clamp(value, 0.f, 1.f) * 255.f)); }
+
+// Unit vector on the octahedron |x| + |y| + |z| = 1, its lower half folded over the upper one
+glm::vec2 octahedralEncode(const glm::vec3 &normal) {
+    float length1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (length1 == 0.f) return glm::vec2{0.f};  // missing normal, decodes to +z
+
+    glm::vec2 encoded = glm::vec2{normal.x, normal.y} / length1;
+    if (normal.z < 0.f) {
+        glm::vec2 folded = 1.f - glm::abs(glm::vec2{encoded.y, encoded.x});
+        encoded = {encoded.x >= 0.f ? folded.x : -folded.x, encoded.y >= 0.f ? folded.y : -folded.y};
+    }
+    return encoded;
+}
+
+LvePackedVertex packVertex(const LveVertex &vertex, const glm::vec3 &boundsMin, const glm::vec3 &boundsExtent) {
+    LvePackedVertex packed{};
+    for (int i = 0; i < 3; i++) {
+        // a flat axis (plane) keeps 0, decoded as the bound itself
+        float relative = boundsExtent[i] > 0.f ? (vertex.position[i] - boundsMin[i]) / boundsExtent[i] : 0.f;
+        packed.position[i] = quantizeUnorm16(relative);
+    }
+
+    glm::vec2 normal = octahedralEncode(vertex.normal);
+    packed.normal[0] = quantizeSnorm16(normal.x);
+    packed.normal[1] = quantizeSnorm16(normal.y);
+
+    packed.uv[0] = glm::packHalf1x16(vertex.uv.x);
+    packed.uv[1] = glm::packHalf1x16(vertex.uv.y);
+
+    for (int i = 0; i < 3; i++) packed.color[i] = quantizeUnorm8(vertex.color[i]);
+    packed.color[3] = 255;
+    return packed;
+}
+
+}  // namespace
+
+std::vector<VkVertexInputBindingDescription> LveVertex::getBindingDescriptions() {
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+    bindingDescriptions[0].binding = 0;
+    bindingDescriptions[0].stride = sizeof(LveVertex);
+    bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    return bindingDescriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription> LveVertex::getAttributeDescriptions() {
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+
+    attributeDescriptions.push_back({0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(LveVertex, position)});
+    attributeDescriptions.push_back({1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(LveVertex, color)});
+    attributeDescriptions.push_back({2, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(LveVertex, normal)});
+    attributeDescriptions.push_back({3, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(LveVertex, uv)});
+
+    return attributeDescriptions;
+}
+
+std::vector<VkVertexInputBindingDescription> LvePackedVertex::getBindingDescriptions(bool withColor) {
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+    bindingDescriptions[0].binding = 0;
+    bindingDescriptions[0].stride = withColor ? sizeof(LvePackedVertex) : offsetof(LvePackedVertex, color);
+    bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    return bindingDescriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription> LvePackedVertex::getAttributeDescriptions(bool withColor) {
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+
+    // same locations as LveVertex, the shaders only change the types and the decoding
+    attributeDescriptions.push_back({0, 0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(LvePackedVertex, position)});
+    if (withColor) {
+        attributeDescriptions.push_back({1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(LvePackedVertex, color)});
+    }
+    attributeDescriptions.push_back({2, 0, VK_FORMAT_R16G16_SNORM, offsetof(LvePackedVertex, normal)});
+    attributeDescriptions.push_back({3, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(LvePackedVertex, uv)});
+
+    return attributeDescriptions;
+}
+
+uint32_t vertexStride(LveVertexFormat format) { return getVertexBindingDescriptions(format)[0].stride; }
+
+std::vector<VkVertexInputBindingDescription> getVertexBindingDescriptions(LveVertexFormat format) {
+    if (format == LveVertexFormat::Full) return LveVertex::getBindingDescriptions();
+    return LvePackedVertex::getBindingDescriptions(format == LveVertexFormat::PackedColor);
+}
+
+std::vector<VkVertexInputAttributeDescription> getVertexAttributeDescriptions(LveVertexFormat format) {
+    if (format == LveVertexFormat::Full) return LveVertex::getAttributeDescriptions();
+    return LvePackedVertex::getAttributeDescriptions(format == LveVertexFormat::PackedColor);
+}
+
+std::string vertexShaderPath(const std::string &shader, LveVertexFormat format) {
+    std::string path = "shaders/" + shader;
+    if (format == LveVertexFormat::Packed) path += ".packed";
+    if (format == LveVertexFormat::PackedColor) path += ".packedcolor";
+    return path + ".spv";
+}
+
+std::vector<uint8_t> packVertices(const std::vector<LveVertex> &vertices, LveVertexFormat format,
+                                  const glm::vec3 &boundsMin, const glm::vec3 &boundsMax) {
+    uint32_t stride = vertexStride(format);
+    std::vector<uint8_t> data(static_cast<size_t>(stride) * vertices.size());
+    if (format == LveVertexFormat::Full) {
+        memcpy(data.data(), vertices.data(), data.size());
+        return data;
+    }
+
+    glm::vec3 boundsExtent = boundsMax - boundsMin;
+    for (size_t i = 0; i < vertices.size(); i++) {
+        LvePackedVertex packed = packVertex(vertices[i], boundsMin, boundsExtent);
+        // Packed drops the trailing color
+        memcpy(data.data() + i * stride, &packed, stride);
+    }
+    return data;
+}
+
+}  // namespace lve
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vulkan/vulkan_core.h>
+
+#include "lve_mesh_container.hpp"
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+// Full precision vertex (LveModel::Vertex, LveVertexFormat::Full), what the OBJ import produces
+struct LveVertex {
+    glm::vec3 position{};
+    glm::vec3 color{};
+    glm::vec3 normal{};
+    glm::vec2 uv{};
+
+    static std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
+    static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
+
+    bool operator==(const LveVertex &other) const {
+        return position == other.position && color == other.color && normal == other.normal && uv == other.uv;
+    }
+};
+
+/*
+ * Quantized vertex of the Packed formats, decoded by the vertex shaders (shaders/vertex_input.glsl) :
+ *  - position : unorm16 inside the model bounds, mapped back by LveModel::getPositionOffset / getPositionScale
+ *  - normal : octahedral encoding in two snorm16
+ *  - uv : half floats
+ *  - color : rgba8, only with LveVertexFormat::PackedColor. Packed vertices stop before it and the shaders read white
+ *
+ * All four attribute formats are mandatory vertex buffer formats in Vulkan.
+ */
+struct LvePackedVertex {
+    uint16_t position[4];  // w unused, three component 16 bit formats are rarely supported as vertex input
+    int16_t normal[2];
+    uint16_t uv[2];
+    uint8_t color[4];
+
+    static std::vector<VkVertexInputBindingDescription> getBindingDescriptions(bool withColor);
+    static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions(bool withColor);
+};
+static_assert(sizeof(LvePackedVertex) == 20, "LvePackedVertex must match the vertex input of the shaders");
+
+constexpr uint32_t VERTEX_FORMAT_COUNT = 3;
+
+// Size of one vertex in the vertex buffer
+uint32_t vertexStride(LveVertexFormat format);
+// Vertex input of a pipeline drawing the models of this format
+std::vector<VkVertexInputBindingDescription> getVertexBindingDescriptions(LveVertexFormat format);
+std::vector<VkVertexInputAttributeDescription> getVertexAttributeDescriptions(LveVertexFormat format);
+
+// Compiled variant of a vertex shader reading this format. CMakeLists.txt builds .packed and .packedcolor variants
+// of the shaders including vertex_input.glsl, with PACKED_VERTEX (and PACKED_VERTEX_COLOR)
+std::string vertexShaderPath(const std::string &shader, LveVertexFormat format);
+
+// vertexStride(format) bytes per vertex. Packed positions are quantized in [boundsMin, boundsMax], which must hold
+// every position
+std::vector<uint8_t> packVertices(const std::vector<LveVertex> &vertices, LveVertexFormat format,
+                                  const glm::vec3 &boundsMin, const glm::vec3 &boundsMax);
+
+}  // namespace lve
@@ -9,10 +9,12 @@
 namespace lve {
 class LveWindow {
    public:
-    LveWindow(int w, int h, std::string name);
+    // A headless window never touches GLFW : no surface, the renderer draws into offscreen images
+    LveWindow(int w, int h, std::string name, bool headless = false);
     ~LveWindow();
 
-    bool shouldClose() { return glfwWindowShouldClose(window); }
+    bool isHeadless() const { return headless; }
+    bool shouldClose() { return !headless && glfwWindowShouldClose(window); }
     VkExtent2D getExtend() { return {static_cast<uint32_t>(width), static_cast<uint32_t>(height)}; }
     bool wasWindowResized() { return framebufferResized; }
     void resetWindowResizedFlag() { framebufferResized = false; }
@@ -27,8 +29,9 @@ class LveWindow {
     int width;
     int height;
     bool framebufferResized = false;
+    bool headless;
 
     std::string windowName;
-    GLFWwindow *window;
+    GLFWwindow *window = nullptr;
 };
 }  // namespace lve
\ No newline at end of file
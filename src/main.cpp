@@ -1,17 +1,41 @@
 #include <cstdlib>
+#include <cstring>
 #include <exception>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 
 #include "first_app.hpp"
 
-int main() {
-    lve::FirstApp app{};
+// --headless : no window, render offscreen
+// --frames N : stop after N frames (benchmarks)
+// --capture file.ppm : save the last frame
+// --validate-waves : print the fp16 error of each wave cascade
+static lve::FirstAppOptions parseOptions(int argc, char **argv) {
+    lve::FirstAppOptions options{};
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            options.headless = true;
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            options.frameCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            options.capturePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--validate-waves") == 0) {
+            options.validateWavePrecision = true;
+        } else {
+            throw std::runtime_error(std::string("unknown argument: ") + argv[i]);
+        }
+    }
+    return options;
+}
+
+int main(int argc, char **argv) {
     try {
+        lve::FirstApp app{parseOptions(argc, argv)};
         app.run();
     } catch (const std::exception &e) {
         std::cerr << e.what() << '\n';
         return EXIT_FAILURE;
     }
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -52,7 +52,9 @@ void ShaderToySystem::executePostCpS(FrameInfo frameInfo, VkDescriptorSet comput
                        sizeof(SimplePushConstantData), &push);
 
     vkCmdBindDescriptorSets(frameInfo.postProcessingCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 3,
-                            descriptorSet, 0, 0);
+                            descriptorSet,
+                            static_cast<uint32_t>(frameInfo.globalDynamicOffsets.size()),
+                            frameInfo.globalDynamicOffsets.data());
 
     vkCmdDispatch(frameInfo.postProcessingCommandBuffer, windowExtent.width / 32 + 1, windowExtent.height / 32 + 1, 1);
 }
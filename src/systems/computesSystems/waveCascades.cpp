@@ -0,0 +1,155 @@
+#include "waveCascades.hpp"
+
+#include <vulkan/vulkan_core.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "lve_swap_chain.hpp"
+
+namespace lve {
+
+WaveCascades::WaveCascades(LveDevice &device, const std::vector<WaveCascadeSettings> &settings,
+                           WavePrecision outputPrecision)
+    : lveDevice{device}, settings{settings} {
+    if (settings.empty() || settings.size() > MAX_CASCADES) {
+        throw std::runtime_error("wave cascade count must be between 1 and MAX_CASCADES!");
+    }
+    // the outputs are sampled with linear filtering and their mip chains are blitted
+    this->outputPrecision = resolveWavePrecision(
+        lveDevice, outputPrecision, waveOutputFormat(WavePrecision::Half),
+        VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT |
+            VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT);
+    for (WaveCascadeSettings &cascade : this->settings) {
+        cascade.precision = resolveWavePrecision(lveDevice, cascade.precision,
+                                                 waveIntermediateFormat(WavePrecision::Half),
+                                                 VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+    }
+    createTextures();
+
+    for (uint32_t i = 0; i < this->settings.size(); i++) {
+        const WaveCascadeSettings &cascade = this->settings[i];
+        cascades.push_back(std::make_unique<WaveGen>(lveDevice, cascade.lengthScale, cascade.cutoffLow,
+                                                     cascade.cutoffHigh, displacement, derivatives, turbulence, i,
+                                                     cascade.precision));
+    }
+}
+
+WaveCascades::~WaveCascades() {}
+
+std::vector<float> WaveCascades::getLengthScales() const {
+    std::vector<float> lengthScales;
+    for (const WaveCascadeSettings &cascade : settings) lengthScales.push_back(cascade.lengthScale);
+    return lengthScales;
+}
+
+void WaveCascades::createTextures() {
+    LveMemoryScope memoryScope{LveMemoryCategory::WaveCascade};
+    uint32_t layerCount = static_cast<uint32_t>(settings.size());
+    VkFormat outputFormat = waveOutputFormat(outputPrecision);
+    displacement.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+    derivatives.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+    turbulence.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+
+    for (int i = 0; i < LveSwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+        // outputs are sampled by the graphics queue. Displacement and derivatives are fully rewritten every frame, they
+        // change owner instead of being concurrent and carry a mip chain rebuilt every frame for the distant ocean.
+        // Turbulence accumulates over the previous frames, it is concurrent so its content survives the round trip
+        displacement[i] = std::make_shared<LveTexture>(lveDevice, 512, 512, layerCount, outputFormat,
+                                                       VK_SHARING_MODE_EXCLUSIVE, LveTexture::FULL_MIP_CHAIN);
+
+        derivatives[i] = std::make_shared<LveTexture>(lveDevice, 512, 512, layerCount, outputFormat,
+                                                      VK_SHARING_MODE_EXCLUSIVE, LveTexture::FULL_MIP_CHAIN);
+
+        turbulence[i] = std::make_shared<LveTexture>(lveDevice, 512, 512, layerCount, outputFormat,
+                                                     VK_SHARING_MODE_CONCURRENT);
+    }
+}
+
+void WaveCascades::outputsOwnershipBarrier(VkCommandBuffer commandBuffer, int frameIndex, VkImageLayout oldLayout,
+                                           uint32_t srcQueueFamily, uint32_t dstQueueFamily, VkAccessFlags srcAccess,
+                                           VkAccessFlags dstAccess, VkPipelineStageFlags srcStage,
+                                           VkPipelineStageFlags dstStage) {
+    std::shared_ptr<LveTexture> outputs[] = {displacement[frameIndex], derivatives[frameIndex]};
+    VkImageMemoryBarrier barriers[2]{};
+    for (int i = 0; i < 2; i++) {
+        barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barriers[i].srcAccessMask = srcAccess;
+        barriers[i].dstAccessMask = dstAccess;
+        barriers[i].oldLayout = oldLayout;
+        barriers[i].newLayout = outputs[i]->getImageLayout();
+        barriers[i].srcQueueFamilyIndex = srcQueueFamily;
+        barriers[i].dstQueueFamilyIndex = dstQueueFamily;
+        barriers[i].image = outputs[i]->getTextureImage();
+        barriers[i].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0,
+                                        VK_REMAINING_ARRAY_LAYERS};
+    }
+    vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 2, barriers);
+}
+
+void WaveCascades::releaseOutputs(FrameInfo frameInfo) {
+    if (!lveDevice.hasDedicatedComputeQueue()) return;
+    const QueueFamilyIndices &queueFamilies = lveDevice.getQueueFamilies();
+    outputsOwnershipBarrier(frameInfo.preProcessingCommandBuffer, frameInfo.frameIndex, VK_IMAGE_LAYOUT_GENERAL,
+                            queueFamilies.computeFamily, queueFamilies.graphicsAndComputeFamily,
+                            VK_ACCESS_SHADER_WRITE_BIT, 0, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+}
+
+void WaveCascades::acquireOutputs(FrameInfo frameInfo) {
+    if (lveDevice.hasDedicatedComputeQueue()) {
+        const QueueFamilyIndices &queueFamilies = lveDevice.getQueueFamilies();
+        outputsOwnershipBarrier(frameInfo.commandBuffer, frameInfo.frameIndex, VK_IMAGE_LAYOUT_GENERAL,
+                                queueFamilies.computeFamily, queueFamilies.graphicsAndComputeFamily, 0,
+                                VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+                                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                    VK_PIPELINE_STAGE_TRANSFER_BIT);
+    }
+    updateOutputMips(frameInfo);
+}
+
+void WaveCascades::updateOutputMips(FrameInfo frameInfo) {
+    // blits need the graphics queue, so the chains are rebuilt at the start of the frame's graphics command buffer.
+    // The wait on the simulation (and the acquire) already made level 0 visible to transfers, the vertex and fragment
+    // stages cover the previous frame still sampling the small levels
+    VkPipelineStageFlags srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    displacement[frameInfo.frameIndex]->generateMipmaps(frameInfo.commandBuffer, srcStage, 0, dstStage,
+                                                        VK_ACCESS_SHADER_READ_BIT);
+    derivatives[frameInfo.frameIndex]->generateMipmaps(frameInfo.commandBuffer, srcStage, 0, dstStage,
+                                                       VK_ACCESS_SHADER_READ_BIT);
+}
+
+void WaveCascades::executePreCpS(FrameInfo frameInfo) {
+    if (lveDevice.hasDedicatedComputeQueue()) {
+        // the graphics queue owned displacement and derivatives last, they are fully rewritten so the compute queue
+        // takes them back without a transfer by discarding their content (UNDEFINED), the frame fence already ordered
+        // the reads
+        outputsOwnershipBarrier(frameInfo.preProcessingCommandBuffer, frameInfo.frameIndex, VK_IMAGE_LAYOUT_UNDEFINED,
+                                VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, 0, VK_ACCESS_SHADER_WRITE_BIT,
+                                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    }
+
+    // the merge reads back the turbulence this slot accumulated frames in flight ago before storing it again
+    VkImageMemoryBarrier turbulenceBarrier{};
+    turbulenceBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    turbulenceBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    turbulenceBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    turbulenceBarrier.oldLayout = turbulence[frameInfo.frameIndex]->getImageLayout();
+    turbulenceBarrier.newLayout = turbulence[frameInfo.frameIndex]->getImageLayout();
+    turbulenceBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    turbulenceBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    turbulenceBarrier.image = turbulence[frameInfo.frameIndex]->getTextureImage();
+    turbulenceBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, VK_REMAINING_ARRAY_LAYERS};
+    vkCmdPipelineBarrier(frameInfo.preProcessingCommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &turbulenceBarrier);
+
+    // the cascades only share the outputs, each one merges into its own layer
+    for (std::unique_ptr<WaveGen> &cascade : cascades) {
+        cascade->executePreCpS(frameInfo);
+    }
+}
+
+}  // namespace lve
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../lve_Ipre_processing.hpp"
+#include "lve_device.hpp"
+#include "lve_frame_info.hpp"
+#include "lve_texture.hpp"
+#include "waveGenerationSystem.hpp"
+#include "waveGenerationSystems/wave_precision.hpp"
+
+namespace lve {
+
+struct WaveCascadeSettings {
+    float lengthScale;
+    float cutoffLow;
+    float cutoffHigh;
+    // storage of the spectrum and IFFT textures of this cascade, see WavePrecisionValidator to pick it
+    WavePrecision precision = WavePrecision::Full;
+};
+
+/*
+ * Every wave cascade of the ocean : one WaveGen simulation per cascade, all merged into the same three layered
+ * textures (displacement, derivatives, turbulence, one layer per cascade and one texture per frame in flight).
+ * The water shaders read the three arrays and loop over the cascades, so their number is a runtime setting.
+ *
+ * Queue ownership transfers and the per frame mip chains are recorded once per array, whatever the number of
+ * cascades. Turbulence is the exception : it keeps the sum of the previous frames, so it is shared by both queues
+ * instead of being discarded on the way back to compute.
+ */
+class WaveCascades : public LveIPreProcessing {
+   public:
+    // Size of the length scale array of the water shaders, MAX_WAVE_CASCADES in the shaders
+    static constexpr uint32_t MAX_CASCADES = 8;
+
+    // outputPrecision is the storage of the shared displacement, derivatives and turbulence arrays. Half precisions
+    // fall back to Full on devices without the fp16 storage formats
+    WaveCascades(LveDevice &device, const std::vector<WaveCascadeSettings> &settings,
+                 WavePrecision outputPrecision = WavePrecision::Full);
+    ~WaveCascades();
+
+    WaveCascades(const WaveCascades &) = delete;
+    WaveCascades &operator=(const WaveCascades &) = delete;
+
+    void executePreCpS(FrameInfo frameInfo) override;
+    void releaseOutputs(FrameInfo frameInfo) override;
+    void acquireOutputs(FrameInfo frameInfo) override;
+
+    uint32_t getCascadeCount() const { return static_cast<uint32_t>(cascades.size()); }
+    std::vector<float> getLengthScales() const;
+
+    std::vector<std::shared_ptr<LveTexture>> getAllDisplacement() { return displacement; }
+
+    std::vector<std::shared_ptr<LveTexture>> getAllDerivatives() { return derivatives; }
+
+    std::vector<std::shared_ptr<LveTexture>> getAllTurbulence() { return turbulence; }
+
+   private:
+    void createTextures();
+    // Same barrier on displacement and derivatives of one frame, every layer. Turbulence is concurrent, it never
+    // changes owner
+    void outputsOwnershipBarrier(VkCommandBuffer commandBuffer, int frameIndex, VkImageLayout oldLayout,
+                                 uint32_t srcQueueFamily, uint32_t dstQueueFamily, VkAccessFlags srcAccess,
+                                 VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage);
+    // Rebuilds the mip chains of the frame's displacement and derivatives from their freshly merged level 0
+    void updateOutputMips(FrameInfo frameInfo);
+
+    LveDevice &lveDevice;
+    std::vector<WaveCascadeSettings> settings;
+    WavePrecision outputPrecision;
+
+    std::vector<std::shared_ptr<LveTexture>> displacement;
+    std::vector<std::shared_ptr<LveTexture>> derivatives;
+    std::vector<std::shared_ptr<LveTexture>> turbulence;
+
+    std::vector<std::unique_ptr<WaveGen>> cascades;
+};
+}  // namespace lve
@@ -30,7 +30,15 @@ struct SimplePushConstantData {
     glm::vec2 resolution;
 };
 
-WaveGen::WaveGen(LveDevice &device, float LengthScale, float CutoffLow, float CutoffHigh) : lveDevice{device} {
+WaveGen::WaveGen(LveDevice &device, float LengthScale, float CutoffLow, float CutoffHigh,
+                 std::vector<std::shared_ptr<LveTexture>> displacement,
+                 std::vector<std::shared_ptr<LveTexture>> derivatives,
+                 std::vector<std::shared_ptr<LveTexture>> turbulence, uint32_t cascadeLayer, WavePrecision precision)
+    : precision{precision}, displacement{displacement}, derivatives{derivatives}, turbulence{turbulence},
+      lveDevice{device} {
+    // every texture and buffer of the cascade, including the ones of its stages. The staging of their initial data
+    // stays Staging (see LveUploadBatcher::stage)
+    LveMemoryScope memoryScope{LveMemoryCategory::WaveCascade};
     createTextures();
     waveTextureGenerator = std::make_unique<WaveSpectrum>(lveDevice, 512, 512, spectrumTexture, waveDataTexture,
                                                           LengthScale, CutoffLow, CutoffHigh);
@@ -60,7 +68,7 @@ WaveGen::WaveGen(LveDevice &device, float LengthScale, float CutoffLow, float Cu
     wavePermuteDxxDzz = std::make_unique<WavePermute>(lveDevice, 512, 512, DxxDzz);
 
     waveMerge = std::make_unique<WaveMerge>(lveDevice, 512, 512, DxDz, DyDxz, DyxDyz, DxxDzz, displacement, derivatives,
-                                            turbulence);
+                                            turbulence, cascadeLayer);
 
     waveTimeUpdate = std::make_unique<WaveTimeUpdate>(lveDevice, 512, 512, DxDz, DyDxz, DyxDyz, DxxDzz,
                                                       spectrumConjugateTexture, waveDataTexture);
@@ -98,17 +106,16 @@ std::vector<float> WaveGen::loadPrecomputeData() {
 }
 
 void WaveGen::createTextures() {
+    // two channel textures of the simulation, the four channel ones keep fp32 (initial data, precompute)
+    VkFormat intermediateFormat = waveIntermediateFormat(precision);
     spectrumTextureCopy1.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
     DxDz.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
     DyDxz.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
     DyxDyz.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
     DxxDzz.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
-    displacement.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
-    derivatives.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
-    turbulence.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
 
     spectrumTexture = std::make_shared<LveTexture>(lveDevice, 512, 512, std::vector<uint32_t>(512 * 512 * 2, 0).data(),
-                                                   2, VK_FORMAT_R32G32_SFLOAT);
+                                                   2, intermediateFormat);
 
     waveDataTexture = std::make_shared<LveTexture>(lveDevice, 512, 512, std::vector<uint32_t>(512 * 512 * 4, 0).data(),
                                                    4, VK_FORMAT_R32G32B32A32_SFLOAT);
@@ -119,28 +126,19 @@ void WaveGen::createTextures() {
         lveDevice, 512, 512, std::vector<uint32_t>(512 * 512 * 4, 0).data(), 4, VK_FORMAT_R32G32B32A32_SFLOAT);
     for (int i = 0; i < LveSwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
         spectrumTextureCopy1[i] = std::make_shared<LveTexture>(
-            lveDevice, 512, 512, std::vector<uint32_t>(512 * 512 * 2, 0).data(), 2, VK_FORMAT_R32G32_SFLOAT);
+            lveDevice, 512, 512, std::vector<uint32_t>(512 * 512 * 2, 0).data(), 2, intermediateFormat);
 
         DxDz[i] = std::make_shared<LveTexture>(lveDevice, 512, 512, std::vector<uint32_t>(512 * 512 * 2, 0).data(), 2,
-                                               VK_FORMAT_R32G32_SFLOAT);
+                                               intermediateFormat);
 
         DyDxz[i] = std::make_shared<LveTexture>(lveDevice, 512, 512, std::vector<uint32_t>(512 * 512 * 2, 0).data(), 2,
-                                                VK_FORMAT_R32G32_SFLOAT);
+                                                intermediateFormat);
 
         DyxDyz[i] = std::make_shared<LveTexture>(lveDevice, 512, 512, std::vector<uint32_t>(512 * 512 * 2, 0).data(), 2,
-                                                 VK_FORMAT_R32G32_SFLOAT);
+                                                 intermediateFormat);
 
         DxxDzz[i] = std::make_shared<LveTexture>(lveDevice, 512, 512, std::vector<uint32_t>(512 * 512 * 2, 0).data(), 2,
-                                                 VK_FORMAT_R32G32_SFLOAT);
-
-        displacement[i] = std::make_shared<LveTexture>(
-            lveDevice, 512, 512, std::vector<uint32_t>(512 * 512 * 4, 0).data(), 4, VK_FORMAT_R32G32B32A32_SFLOAT);
-
-        derivatives[i] = std::make_shared<LveTexture>(
-            lveDevice, 512, 512, std::vector<uint32_t>(512 * 512 * 4, 0).data(), 4, VK_FORMAT_R32G32B32A32_SFLOAT);
-
-        turbulence[i] = std::make_shared<LveTexture>(
-            lveDevice, 512, 512, std::vector<uint32_t>(512 * 512 * 4, 0).data(), 4, VK_FORMAT_R32G32B32A32_SFLOAT);
+                                                 intermediateFormat);
     }
 }
 
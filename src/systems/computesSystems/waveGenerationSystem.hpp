@@ -5,7 +5,6 @@
 #include <memory>
 #include <vector>
 
-#include "../lve_Ipre_processing.hpp"
 #include "lve_device.hpp"
 #include "lve_frame_info.hpp"
 #include "lve_texture.hpp"
@@ -15,6 +14,7 @@
 #include "waveGenerationSystems/wave_TimeUpdate.hpp"
 #include "waveGenerationSystems/wave_conjugate.hpp"
 #include "waveGenerationSystems/wave_merge.hpp"
+#include "waveGenerationSystems/wave_precision.hpp"
 #include "waveGenerationSystems/wave_spectrum.hpp"
 
 namespace lve {
@@ -22,24 +22,18 @@ namespace lve {
 * Cette classe et toute les classes qui lui sont associées sont une réimplémentation de l'algorithme de génération de vagues de Jump Trajectory (https://www.youtube.com/watch?v=kGEqaX4Y4bQ)
 * Je me suis aidé de son code source pour comprendre les document de recherche sur JONSWAP ainsi que de la transformation inverse de fourier affin de le réimplémenter en C++ et Vulkan
 */
-class WaveGen : public LveIPreProcessing {
+class WaveGen {
    public:
-    WaveGen(LveDevice &device, float LengthScale, float CutoffLow, float CutoffHigh);
+    // One cascade, merged into the layer cascadeLayer of the layered outputs (one per frame in flight) owned by
+    // WaveCascades, which also handles their queue ownership and mip chains. precision is the storage of the spectrum
+    // and IFFT textures, the device must support it (resolveWavePrecision)
+    WaveGen(LveDevice &device, float LengthScale, float CutoffLow, float CutoffHigh,
+            std::vector<std::shared_ptr<LveTexture>> displacement, std::vector<std::shared_ptr<LveTexture>> derivatives,
+            std::vector<std::shared_ptr<LveTexture>> turbulence, uint32_t cascadeLayer,
+            WavePrecision precision = WavePrecision::Full);
     ~WaveGen();
 
-    void executePreCpS(FrameInfo FrameInfo) override;
-
-    std::shared_ptr<LveTexture> getDisplacement() { return displacement[0]; }
-
-    std::shared_ptr<LveTexture> getDerivatives() { return derivatives[0]; }
-
-    std::shared_ptr<LveTexture> getTurbulence() { return turbulence[0]; }
-
-    std::vector<std::shared_ptr<LveTexture>> getAllDisplacement() { return displacement; }
-
-    std::vector<std::shared_ptr<LveTexture>> getAllDerivatives() { return derivatives; }
-
-    std::vector<std::shared_ptr<LveTexture>> getAllTurbulence() { return turbulence; }
+    void executePreCpS(FrameInfo FrameInfo);
 
    private:
     void CalculateInitial(FrameInfo FrameInfo);
@@ -49,6 +43,7 @@ class WaveGen : public LveIPreProcessing {
     void copySpectrumTexture();
 
     bool DataIsUpdate = true;
+    WavePrecision precision;
 
     std::vector<float> loadPrecomputeData();
 
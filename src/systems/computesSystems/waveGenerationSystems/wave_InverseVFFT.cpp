@@ -13,6 +13,7 @@
 #include "lve_swap_chain.hpp"
 #include "lve_texture.hpp"
 #include "lve_utils.hpp"
+#include "wave_precision.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -63,10 +64,11 @@ WaveVertIFFT::WaveVertIFFT(LveDevice &device, int height, int width, std::vector
     createDescriptorSetLayout();
     createDescriptorSet();
 
+    std::string shaderPath = waveShaderPath("wave_textureInverseVerticalFFT.comp", wavePrecisionOf(*buffer0[0]));
     PipelineCreateInfo pipelineCreateInfo{device,
                                           LvePipeLineType::LvePipeLineTypeCompute,
                                           {waveGenSetLayout->getDescriptorSetLayout()},
-                                          {"shaders/wave_textureInverseVerticalFFT.comp.spv"},
+                                          {shaderPath},
                                           sizeof(SimplePushConstantData),
                                           LvePipelIneFunctionnality::None,
                                           nullptr};
@@ -13,6 +13,7 @@
 #include "lve_swap_chain.hpp"
 #include "lve_texture.hpp"
 #include "lve_utils.hpp"
+#include "wave_precision.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -56,10 +57,11 @@ WavePermute::WavePermute(LveDevice &device, int height, int width, std::vector<s
     createDescriptorSetLayout();
     createDescriptorSet();
 
+    std::string shaderPath = waveShaderPath("wave_texturePermute.comp", wavePrecisionOf(*buffer0[0]));
     PipelineCreateInfo pipelineCreateInfo{device,
                                           LvePipeLineType::LvePipeLineTypeCompute,
                                           {waveGenSetLayout->getDescriptorSetLayout()},
-                                          {"shaders/wave_texturePermute.comp.spv"},
+                                          {shaderPath},
                                           sizeof(SimplePushConstantData),
                                           LvePipelIneFunctionnality::None,
                                           nullptr};
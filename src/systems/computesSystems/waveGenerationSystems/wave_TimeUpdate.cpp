@@ -13,6 +13,7 @@
 #include "lve_swap_chain.hpp"
 #include "lve_texture.hpp"
 #include "lve_utils.hpp"
+#include "wave_precision.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -64,10 +65,11 @@ WaveTimeUpdate::WaveTimeUpdate(LveDevice &device, int height, int width,
     createDescriptorSetLayout();
     createDescriptorSet();
 
+    std::string shaderPath = waveShaderPath("wave_texture_TimeSpectrum.comp", wavePrecisionOf(*Dx_Dz[0]));
     PipelineCreateInfo pipelineCreateInfo{device,
                                           LvePipeLineType::LvePipeLineTypeCompute,
                                           {waveGenSetLayout->getDescriptorSetLayout()},
-                                          {"shaders/wave_texture_TimeSpectrum.comp.spv"},
+                                          {shaderPath},
                                           sizeof(SimplePushConstantData),
                                           LvePipelIneFunctionnality::None,
                                           nullptr};
@@ -13,6 +13,7 @@
 #include "lve_swap_chain.hpp"
 #include "lve_texture.hpp"
 #include "lve_utils.hpp"
+#include "wave_precision.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -53,10 +54,11 @@ WaveConjugate::WaveConjugate(LveDevice &device, int height, int width, std::shar
     createDescriptorSetLayout();
     createDescriptorSet();
 
+    std::string shaderPath = waveShaderPath("wave_texture_spectrumConjugated.comp", wavePrecisionOf(*spectrumTexture));
     PipelineCreateInfo pipelineCreateInfo{device,
                                           LvePipeLineType::LvePipeLineTypeCompute,
                                           {waveGenSetLayout->getDescriptorSetLayout()},
-                                          {"shaders/wave_texture_spectrumConjugated.comp.spv"},
+                                          {shaderPath},
                                           sizeof(SimplePushConstantData),
                                           LvePipelIneFunctionnality::None,
                                           nullptr};
@@ -13,6 +13,7 @@
 #include "lve_swap_chain.hpp"
 #include "lve_texture.hpp"
 #include "lve_utils.hpp"
+#include "wave_precision.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -56,7 +57,7 @@ WaveMerge::WaveMerge(LveDevice &device, int height, int width, std::vector<std::
                      std::vector<std::shared_ptr<LveTexture>> Dxx_Dzz,
                      std::vector<std::shared_ptr<LveTexture>> Displacement,
                      std::vector<std::shared_ptr<LveTexture>> Derivatives,
-                     std::vector<std::shared_ptr<LveTexture>> Turbulence)
+                     std::vector<std::shared_ptr<LveTexture>> Turbulence, uint32_t layer)
     : lveDevice{device},
       height{height},
       width{width},
@@ -66,15 +67,18 @@ WaveMerge::WaveMerge(LveDevice &device, int height, int width, std::vector<std::
       Dxx_Dzz{Dxx_Dzz},
       Displacement{Displacement},
       Derivatives{Derivatives},
-      Turbulence{Turbulence} {
+      Turbulence{Turbulence},
+      layer{layer} {
     createDescriptorPool();
     createDescriptorSetLayout();
     createDescriptorSet();
 
+    std::string shaderPath =
+        waveShaderPath("wave_texture_merge.comp", wavePrecisionOf(*Dx_Dz[0]), wavePrecisionOf(*Displacement[0]));
     PipelineCreateInfo pipelineCreateInfo{device,
                                           LvePipeLineType::LvePipeLineTypeCompute,
                                           {waveGenSetLayout->getDescriptorSetLayout()},
-                                          {"shaders/wave_texture_merge.comp.spv"},
+                                          {shaderPath},
                                           sizeof(SimplePushConstantData),
                                           LvePipelIneFunctionnality::None,
                                           nullptr};
@@ -131,15 +135,15 @@ void WaveMerge::createDescriptorSet() {
         Dxx_DzzDesc.imageLayout = Dxx_Dzz[i]->getImageLayout();
 
         VkDescriptorImageInfo DisplacementorDesv{};
-        DisplacementorDesv.imageView = Displacement[i]->getImageView();
+        DisplacementorDesv.imageView = Displacement[i]->getStorageImageView(layer);
         DisplacementorDesv.imageLayout = Displacement[i]->getImageLayout();
 
         VkDescriptorImageInfo DerivativesDesv{};
-        DerivativesDesv.imageView = Derivatives[i]->getImageView();
+        DerivativesDesv.imageView = Derivatives[i]->getStorageImageView(layer);
         DerivativesDesv.imageLayout = Derivatives[i]->getImageLayout();
 
         VkDescriptorImageInfo TurbulenceDesc{};
-        TurbulenceDesc.imageView = Turbulence[i]->getImageView();
+        TurbulenceDesc.imageView = Turbulence[i]->getStorageImageView(layer);
         TurbulenceDesc.imageLayout = Turbulence[i]->getImageLayout();
 
         LveDescriptorWriter(*waveGenSetLayout, *wavePool)
@@ -36,7 +36,7 @@ class WaveMerge {
               std::vector<std::shared_ptr<LveTexture>> Dy_Dxz, std::vector<std::shared_ptr<LveTexture>> Dyx_Dyz,
               std::vector<std::shared_ptr<LveTexture>> Dxx_Dzz, std::vector<std::shared_ptr<LveTexture>> Displacement,
               std::vector<std::shared_ptr<LveTexture>> Derivatives,
-              std::vector<std::shared_ptr<LveTexture>> TurbulenceT);
+              std::vector<std::shared_ptr<LveTexture>> TurbulenceT, uint32_t layer);
     ~WaveMerge();
 
     void executePreCpS(FrameInfo FrameInfo);
@@ -56,6 +56,8 @@ class WaveMerge {
     std::vector<std::shared_ptr<LveTexture>> Turbulence;
     std::vector<std::shared_ptr<LveTexture>> Derivatives;
     std::vector<std::shared_ptr<LveTexture>> Displacement;
+    // layer of the cascade in the layered outputs
+    uint32_t layer;
 
     std::vector<VkDescriptorSet> waveConjugateDescriptorSets;
     std::unique_ptr<LveDescriptorSetLayout> waveGenSetLayout;
@@ -0,0 +1,47 @@
+#include "wave_precision.hpp"
+
+#include <vulkan/vulkan_core.h>
+
+#include <iostream>
+#include <string>
+
+namespace lve {
+
+const char *toString(WavePrecision precision) { return precision == WavePrecision::Half ? "fp16" : "fp32"; }
+
+VkFormat waveIntermediateFormat(WavePrecision precision) {
+    return precision == WavePrecision::Half ? VK_FORMAT_R16G16_SFLOAT : VK_FORMAT_R32G32_SFLOAT;
+}
+
+VkFormat waveOutputFormat(WavePrecision precision) {
+    return precision == WavePrecision::Half ? VK_FORMAT_R16G16B16A16_SFLOAT : VK_FORMAT_R32G32B32A32_SFLOAT;
+}
+
+WavePrecision wavePrecisionOf(const LveTexture &texture) {
+    VkFormat format = texture.getFormat();
+    return format == VK_FORMAT_R16G16_SFLOAT || format == VK_FORMAT_R16G16B16A16_SFLOAT ? WavePrecision::Half
+                                                                                          : WavePrecision::Full;
+}
+
+std::string waveShaderPath(const std::string &shader, WavePrecision intermediates, WavePrecision outputs) {
+    std::string path = "shaders/" + shader;
+    if (intermediates == WavePrecision::Half) path += ".half";
+    if (outputs == WavePrecision::Half) path += ".halfout";
+    return path + ".spv";
+}
+
+WavePrecision resolveWavePrecision(LveDevice &device, WavePrecision requested, VkFormat halfFormat,
+                                   VkFormatFeatureFlags requiredFeatures) {
+    if (requested == WavePrecision::Full) return WavePrecision::Full;
+
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(device.getPhysicalDevice(), halfFormat, &formatProperties);
+    if ((formatProperties.optimalTilingFeatures & requiredFeatures) != requiredFeatures) {
+        std::cerr << "wave simulation : fp16 format " << halfFormat << " unsupported, falling back to fp32"
+                  << std::endl;
+        return WavePrecision::Full;
+    }
+    return WavePrecision::Half;
+}
+
+}  // namespace lve
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vulkan/vulkan_core.h>
+
+#include <string>
+
+#include "lve_device.hpp"
+#include "lve_texture.hpp"
+
+namespace lve {
+
+// Storage precision of the wave simulation textures. The shaders always compute in fp32, Half only halves the
+// bandwidth of the loads and stores (the IFFT stages are bound by it) at the cost of rounding between stages
+enum class WavePrecision { Full, Half };
+
+const char *toString(WavePrecision precision);
+
+// Two channel textures of a cascade : spectrum and IFFT buffers
+VkFormat waveIntermediateFormat(WavePrecision precision);
+// Four channel outputs : displacement, derivatives and turbulence
+VkFormat waveOutputFormat(WavePrecision precision);
+
+// Precision of the textures a stage binds, the stages pick their shader variant from it so the format qualifiers of
+// the shader always match the images
+WavePrecision wavePrecisionOf(const LveTexture &texture);
+
+// Compiled shader of a simulation stage. The fp16 variants are built by CMakeLists.txt with WAVE_HALF (two channel
+// images) and WAVE_HALF_OUTPUTS (merge outputs)
+std::string waveShaderPath(const std::string &shader, WavePrecision intermediates,
+                           WavePrecision outputs = WavePrecision::Full);
+
+// Half when requested and the fp16 format has every feature, Full otherwise (rg16f storage is optional in Vulkan)
+WavePrecision resolveWavePrecision(LveDevice &device, WavePrecision requested, VkFormat halfFormat,
+                                   VkFormatFeatureFlags requiredFeatures);
+
+}  // namespace lve
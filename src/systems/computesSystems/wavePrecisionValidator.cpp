@@ -0,0 +1,192 @@
+#include "wavePrecisionValidator.hpp"
+
+#include <vulkan/vulkan_core.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "lve_buffer.hpp"
+#include "lve_frame_info.hpp"
+#include "lve_swap_chain.hpp"
+#include "waveGenerationSystem.hpp"
+
+namespace lve {
+
+namespace {
+
+constexpr uint32_t SIMULATION_SIZE = 512;
+constexpr VkDeviceSize TEXEL_SIZE = 4 * sizeof(float);
+
+struct ErrorStats {
+    double rms = 0.0;
+    double max = 0.0;
+};
+
+// Errors of value against reference, relative to the peak of the reference
+ErrorStats compare(const std::vector<float> &reference, const std::vector<float> &value) {
+    double peak = 0.0;
+    for (float v : reference) peak = std::max(peak, static_cast<double>(std::abs(v)));
+    if (peak == 0.0) return {};
+
+    ErrorStats stats;
+    double sumSquares = 0.0;
+    for (size_t i = 0; i < reference.size(); i++) {
+        double error = std::abs(static_cast<double>(value[i]) - reference[i]) / peak;
+        sumSquares += error * error;
+        stats.max = std::max(stats.max, error);
+    }
+    stats.rms = std::sqrt(sumSquares / reference.size());
+    return stats;
+}
+
+std::vector<float> roundToHalf(const std::vector<float> &values) {
+    std::vector<float> rounded(values.size());
+    for (size_t i = 0; i < values.size(); i++) rounded[i] = glm::unpackHalf1x16(glm::packHalf1x16(values[i]));
+    return rounded;
+}
+
+void worstOf(ErrorStats &worst, const ErrorStats &stats) {
+    worst.rms = std::max(worst.rms, stats.rms);
+    worst.max = std::max(worst.max, stats.max);
+}
+
+void recordReadback(VkCommandBuffer commandBuffer, const std::shared_ptr<LveTexture> &texture, LveBuffer &buffer) {
+    VkBufferImageCopy region{};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = {SIMULATION_SIZE, SIMULATION_SIZE, 1};
+    vkCmdCopyImageToBuffer(commandBuffer, texture->getTextureImage(), texture->getImageLayout(), buffer.getBuffer(), 1,
+                           &region);
+}
+
+std::vector<float> readBuffer(LveBuffer &buffer) {
+    std::vector<float> values(SIMULATION_SIZE * SIMULATION_SIZE * 4);
+    buffer.map();
+    std::memcpy(values.data(), buffer.getMappedMemory(), values.size() * sizeof(float));
+    buffer.unmap();
+    return values;
+}
+
+}  // namespace
+
+WavePrecisionValidator::WavePrecisionValidator(LveDevice &device, float simulatedTime, double tolerance)
+    : lveDevice{device}, simulatedTime{simulatedTime}, tolerance{tolerance}, frameRing{device, 1, 64 * 1024} {}
+
+WavePrecisionValidator::Readback WavePrecisionValidator::simulate(const WaveCascadeSettings &settings,
+                                                                  WavePrecision intermediates) {
+    // fp32 outputs for both runs so the comparison only sees the intermediates, one layer per frame in flight since
+    // WaveGen builds a descriptor set for each
+    std::vector<std::shared_ptr<LveTexture>> displacement;
+    std::vector<std::shared_ptr<LveTexture>> derivatives;
+    std::vector<std::shared_ptr<LveTexture>> turbulence;
+    for (int i = 0; i < LveSwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+        displacement.push_back(std::make_shared<LveTexture>(lveDevice, SIMULATION_SIZE, SIMULATION_SIZE, 1,
+                                                            waveOutputFormat(WavePrecision::Full)));
+        derivatives.push_back(std::make_shared<LveTexture>(lveDevice, SIMULATION_SIZE, SIMULATION_SIZE, 1,
+                                                           waveOutputFormat(WavePrecision::Full)));
+        turbulence.push_back(std::make_shared<LveTexture>(lveDevice, SIMULATION_SIZE, SIMULATION_SIZE, 1,
+                                                          waveOutputFormat(WavePrecision::Full)));
+    }
+    WaveGen waveGen{lveDevice,   settings.lengthScale, settings.cutoffLow, settings.cutoffHigh, displacement,
+                    derivatives, turbulence,           0,                  intermediates};
+
+    // initial data of the textures and their layouts
+    LveUploadBatcher &uploadBatcher = lveDevice.getUploadBatcher();
+    uploadBatcher.wait(uploadBatcher.submit());
+
+    LveBuffer displacementBuffer{lveDevice,
+                                 TEXEL_SIZE,
+                                 SIMULATION_SIZE * SIMULATION_SIZE,
+                                 VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                 1,
+                                 LveMemoryCategory::Staging};
+    LveBuffer derivativesBuffer{lveDevice,
+                                TEXEL_SIZE,
+                                SIMULATION_SIZE * SIMULATION_SIZE,
+                                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                1,
+                                LveMemoryCategory::Staging};
+
+    VkCommandBuffer commandBuffer = lveDevice.beginSingleTimeCommands();
+    // the time update accumulates frameTime, a single step lands on simulatedTime
+    FrameInfo frameInfo{
+        0, 0, simulatedTime, VK_NULL_HANDLE, commandBuffer, VK_NULL_HANDLE, camera, VK_NULL_HANDLE, {0, 0},
+        gameObjects, frameRing, {0, 0}};
+    waveGen.executePreCpS(frameInfo);
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1,
+                         &barrier, 0, nullptr, 0, nullptr);
+    recordReadback(commandBuffer, displacement[0], displacementBuffer);
+    recordReadback(commandBuffer, derivatives[0], derivativesBuffer);
+
+    lveDevice.endSingleTimeCommands(commandBuffer);
+
+    return {readBuffer(displacementBuffer), readBuffer(derivativesBuffer)};
+}
+
+WavePrecisionReport WavePrecisionValidator::validate(const WaveCascadeSettings &settings) {
+    WavePrecisionReport report{};
+    report.lengthScale = settings.lengthScale;
+    report.halfSupported =
+        resolveWavePrecision(lveDevice, WavePrecision::Half, waveIntermediateFormat(WavePrecision::Half),
+                             VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) == WavePrecision::Half;
+
+    Readback reference = simulate(settings, WavePrecision::Full);
+
+    ErrorStats outputErrors;
+    worstOf(outputErrors, compare(reference.displacement, roundToHalf(reference.displacement)));
+    worstOf(outputErrors, compare(reference.derivatives, roundToHalf(reference.derivatives)));
+    report.outputRmsError = outputErrors.rms;
+    report.outputMaxError = outputErrors.max;
+
+    if (report.halfSupported) {
+        Readback half = simulate(settings, WavePrecision::Half);
+        ErrorStats intermediateErrors;
+        worstOf(intermediateErrors, compare(reference.displacement, half.displacement));
+        worstOf(intermediateErrors, compare(reference.derivatives, half.derivatives));
+        report.intermediateRmsError = intermediateErrors.rms;
+        report.intermediateMaxError = intermediateErrors.max;
+        if (report.intermediateMaxError <= tolerance) report.suggestedIntermediates = WavePrecision::Half;
+    }
+    return report;
+}
+
+WavePrecisionSuggestion WavePrecisionValidator::validate(const std::vector<WaveCascadeSettings> &settings,
+                                                         std::ostream &out) {
+    WavePrecisionSuggestion suggestion;
+    out << "wave precision : errors relative to the fp32 peak after " << simulatedTime << "s, tolerance "
+        << tolerance << std::endl;
+    double worstOutputMaxError = 0.0;
+    for (const WaveCascadeSettings &cascade : settings) {
+        WavePrecisionReport report = validate(cascade);
+        out << "  cascade " << report.lengthScale << "m : ";
+        if (report.halfSupported) {
+            out << "fp16 intermediates rms " << report.intermediateRmsError << " max " << report.intermediateMaxError;
+        } else {
+            out << "fp16 intermediates unsupported";
+        }
+        out << ", fp16 outputs rms " << report.outputRmsError << " max " << report.outputMaxError << " -> use "
+            << toString(report.suggestedIntermediates) << " intermediates" << std::endl;
+        worstOutputMaxError = std::max(worstOutputMaxError, report.outputMaxError);
+        suggestion.cascades.push_back(report);
+    }
+
+    // one layer per cascade in the same arrays : the worst cascade decides for all of them
+    if (!settings.empty() && worstOutputMaxError <= tolerance) suggestion.suggestedOutputs = WavePrecision::Half;
+    out << "  outputs shared by every cascade : fp16 max " << worstOutputMaxError << " -> use "
+        << toString(suggestion.suggestedOutputs) << " outputs" << std::endl;
+    return suggestion;
+}
+
+}  // namespace lve
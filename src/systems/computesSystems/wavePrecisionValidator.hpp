@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vulkan/vulkan_core.h>
+
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "lve_camera.hpp"
+#include "lve_device.hpp"
+#include "lve_frame_ring.hpp"
+#include "lve_game_object.hpp"
+#include "lve_texture.hpp"
+#include "waveCascades.hpp"
+#include "waveGenerationSystems/wave_precision.hpp"
+
+namespace lve {
+
+// Errors of one cascade, relative to the peak of the fp32 reference (displacement and derivatives, the worst of both)
+struct WavePrecisionReport {
+    float lengthScale;
+    // false when the device can't store the intermediates in fp16, the intermediate errors are then 0
+    bool halfSupported;
+    // fp16 spectrum and IFFT textures against the fp32 simulation
+    double intermediateRmsError = 0.0;
+    double intermediateMaxError = 0.0;
+    // rounding of the fp32 outputs to fp16, what this cascade's layer of the shared output arrays loses in Half
+    double outputRmsError = 0.0;
+    double outputMaxError = 0.0;
+    WavePrecision suggestedIntermediates = WavePrecision::Full;
+};
+
+// Reports of every cascade of an ocean. The cascades write into the same output arrays, so the outputs get a single
+// precision : Half only when every cascade tolerates it
+struct WavePrecisionSuggestion {
+    std::vector<WavePrecisionReport> cascades;
+    WavePrecision suggestedOutputs = WavePrecision::Full;
+};
+
+/*
+ * Picks the storage precision of the wave cascades from measurements instead of guesses : each cascade is simulated
+ * once with fp32 textures and once with fp16 intermediates, both outputs are read back and compared on the CPU, and
+ * the fp32 outputs are rounded to fp16 to measure the output arrays alone. The noise comes from
+ * textures/noise.csv, so both runs see the same spectrum.
+ *
+ * The simulations run in single time command buffers outside of any frame, before the renderer starts. Turbulence
+ * accumulates over frames and is not compared.
+ */
+class WavePrecisionValidator {
+   public:
+    // fraction of the peak amplitude under which the maximum error is not visible on the water
+    static constexpr double DEFAULT_TOLERANCE = 2e-3;
+
+    WavePrecisionValidator(LveDevice &device, float simulatedTime = 10.f, double tolerance = DEFAULT_TOLERANCE);
+
+    WavePrecisionValidator(const WavePrecisionValidator &) = delete;
+    WavePrecisionValidator &operator=(const WavePrecisionValidator &) = delete;
+
+    WavePrecisionReport validate(const WaveCascadeSettings &settings);
+    // Validates every cascade, prints one line per cascade with its suggested intermediates then the precision
+    // suggested for the shared outputs
+    WavePrecisionSuggestion validate(const std::vector<WaveCascadeSettings> &settings, std::ostream &out);
+
+   private:
+    struct Readback {
+        std::vector<float> displacement;
+        std::vector<float> derivatives;
+    };
+
+    // Runs one step of the simulation at simulatedTime and reads level 0 of the fp32 outputs back
+    Readback simulate(const WaveCascadeSettings &settings, WavePrecision intermediates);
+
+    LveDevice &lveDevice;
+    float simulatedTime;
+    double tolerance;
+
+    // a simulation step only reads the command buffer and the times of its FrameInfo
+    LveCamera camera{};
+    LveGameObject::Map gameObjects;
+    LveFrameRing frameRing;
+};
+
+}  // namespace lve
@@ -86,7 +86,9 @@ void PointLightSystem::render(FrameInfo &frameInfo) {
     lveGPipeline->bind(frameInfo.commandBuffer);
 
     vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
-                            &frameInfo.globalDescriptorSet, 0, nullptr);
+                            &frameInfo.globalDescriptorSet,
+                            static_cast<uint32_t>(frameInfo.globalDynamicOffsets.size()),
+                            frameInfo.globalDynamicOffsets.data());
 
     for (auto it = sorted.rbegin(); it != sorted.rend(); ++it) {
         auto &obj = frameInfo.gameObjects.at(it->second);
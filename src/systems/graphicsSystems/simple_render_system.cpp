@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "../pipeline_builder.hpp"
+#include "lve_bindless_table.hpp"
 #include "lve_device.hpp"
 #include "lve_frame_info.hpp"
 #include "lve_utils.hpp"
@@ -20,10 +21,12 @@
 
 namespace lve {
 
-struct SimplePushConstantData {
-    glm::mat4 modelMatrix{1.f};
-    glm::mat4 normalMatrix{1.f};
-};
+namespace {
+
+// a LOD is drawn while its simplification error covers at most this many pixels
+constexpr float MAX_LOD_PIXEL_ERROR = 1.f;
+
+}  // namespace
 
 SimpleRenderSystem::SimpleRenderSystem(LveDevice &device, VkRenderPass renderPass,
                                        VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout textureSetLayout,
@@ -34,39 +37,47 @@ SimpleRenderSystem::SimpleRenderSystem(LveDevice &device, VkRenderPass renderPas
                                           LvePipeLineType::LvePipeLineTypeRender,
                                           {globalSetLayout, textureSetLayout, waveLayout->getDescriptorSetLayout()},
                                           {"shaders/simple_shader.vert.spv", "shaders/simple_shader.frag.spv"},
-                                          sizeof(SimplePushConstantData),
+                                          0,  // transforms come from the object buffer
                                           LvePipelIneFunctionnality::None,
                                           renderPass};
 
     pipelineLayout = PipelineBuilder::BuildPipeLineLayout(pipelineCreateInfo);
-    lveGPipeline = PipelineBuilder::BuildGraphicsPipeline(pipelineCreateInfo, pipelineLayout);
+    for (uint32_t i = 0; i < VERTEX_FORMAT_COUNT; i++) {
+        pipelineCreateInfo.vertexFormat = static_cast<LveVertexFormat>(i);
+        pipelineCreateInfo.shaderPaths[0] = vertexShaderPath("simple_shader.vert", pipelineCreateInfo.vertexFormat);
+        lveGPipelines[i] = PipelineBuilder::BuildGraphicsPipeline(pipelineCreateInfo, pipelineLayout);
+    }
 }
 SimpleRenderSystem::~SimpleRenderSystem() { vkDestroyPipelineLayout(lveDevice.device(), pipelineLayout, nullptr); }
 
 void SimpleRenderSystem::renderGameObjects(FrameInfo &frameInfo) {
-    lveGPipeline->bind(frameInfo.commandBuffer);
-
     vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
-                            &frameInfo.globalDescriptorSet, 0, nullptr);
+                            &frameInfo.globalDescriptorSet,
+                            static_cast<uint32_t>(frameInfo.globalDynamicOffsets.size()),
+                            frameInfo.globalDynamicOffsets.data());
+    // every texture at once, objects find theirs through ObjectData::textureIndex
+    VkDescriptorSet bindlessSet = lveDevice.getBindlessTable().getDescriptorSet();
+    vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1,
+                            &bindlessSet, 0, nullptr);
 
+    // the sets stay bound across the pipeline changes, every pipeline shares the layout
+    LveGPipeline *boundPipeline = nullptr;
+    float viewportHeight = static_cast<float>(frameInfo.viewportExtent.height);
     for (auto &kv : frameInfo.gameObjects) {
         auto &obj = kv.second;
         if (obj.model == nullptr || obj.water != nullptr) continue;
 
-        if (obj.texture != nullptr) {
-            vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1,
-                                    &obj.model->textureDescriptorSet, 0, nullptr);
+        LveGPipeline *pipeline = lveGPipelines[static_cast<uint32_t>(obj.model->getVertexFormat())].get();
+        if (pipeline != boundPipeline) {
+            pipeline->bind(frameInfo.commandBuffer);
+            boundPipeline = pipeline;
         }
         vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 2, 1,
                                 &waterSets[frameInfo.frameIndex], 0, nullptr);
-        SimplePushConstantData push{};
-        push.modelMatrix = obj.transform.mat4();
-        push.normalMatrix = obj.transform.normalMatrix();
-        vkCmdPushConstants(frameInfo.commandBuffer, pipelineLayout,
-                           VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SimplePushConstantData),
-                           &push);
         obj.model->bind(frameInfo.commandBuffer);
-        obj.model->draw(frameInfo.commandBuffer);
+        uint32_t lod = obj.model->selectLod(frameInfo.camera, obj.transform.mat4(), viewportHeight,
+                                            MAX_LOD_PIXEL_ERROR);
+        obj.model->draw(frameInfo.commandBuffer, obj.objectIndex, lod);
     }
 }
 
@@ -2,6 +2,7 @@
 
 #include <vulkan/vulkan_core.h>
 
+#include <array>
 #include <memory>
 #include <vector>
 
@@ -9,6 +10,7 @@
 #include "lve_device.hpp"
 #include "lve_frame_info.hpp"
 #include "lve_g_pipeline.hpp"
+#include "lve_vertex_format.hpp"
 namespace lve {
 class SimpleRenderSystem {
    public:
@@ -25,7 +27,8 @@ class SimpleRenderSystem {
    private:
     std::vector<VkDescriptorSet> waterSets;
     LveDevice &lveDevice;
-    std::unique_ptr<LveGPipeline> lveGPipeline;
+    // one per vertex format, objects are drawn with the pipeline of their model's format
+    std::array<std::unique_ptr<LveGPipeline>, VERTEX_FORMAT_COUNT> lveGPipelines;
     VkPipelineLayout pipelineLayout;
 };
 }  // namespace lve
\ No newline at end of file
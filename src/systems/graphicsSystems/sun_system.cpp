@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "../pipeline_builder.hpp"
+#include "lve_asset_cache.hpp"
 #include "lve_device.hpp"
 #include "lve_frame_info.hpp"
 #include "lve_game_object.hpp"
@@ -69,13 +70,15 @@ void SunSystem::createDescriptorSet() {
     LveDescriptorWriter(*sunSetLayout, *sunPool).writeImage(0, &sunDesc).build(sunDescriptorSets);
 }
 
-void SunSystem::loadSunTexture() { sunTexture = std::make_shared<LveTexture>(lveDevice, "textures/sun.png", false); }
+void SunSystem::loadSunTexture() { sunTexture = lveDevice.getAssetCache().getTexture("textures/sun.png"); }
 
 void SunSystem::render(FrameInfo& frameInfo) {
     lveGPipeline->bind(frameInfo.commandBuffer);
     VkDescriptorSet descriptorSet[] = {frameInfo.globalDescriptorSet, sunDescriptorSets};
     vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 2,
-                            descriptorSet, 0, nullptr);
+                            descriptorSet,
+                            static_cast<uint32_t>(frameInfo.globalDynamicOffsets.size()),
+                            frameInfo.globalDynamicOffsets.data());
 
     PointLightPushConstants push{};
     push.position = glm::vec4(sun->transform.translation, 1.f);
@@ -2,25 +2,24 @@
 
 #include <vulkan/vulkan_core.h>
 
+#include <array>
 #include <memory>
 #include <vector>
 
+#include "lve_buffer.hpp"
 #include "lve_device.hpp"
 #include "lve_frame_info.hpp"
 #include "lve_g_pipeline.hpp"
+#include "lve_vertex_format.hpp"
 namespace lve {
 class WaterSystem {
    public:
+    // The textures are the layered outputs of WaveCascades (one per frame in flight, one layer per cascade), with
+    // the length scale of each layer
     WaterSystem(LveDevice &device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout,
-                std::vector<std::shared_ptr<LveTexture>> displacementTexture1,
-                std::vector<std::shared_ptr<LveTexture>> derivateTexture1,
-                std::vector<std::shared_ptr<LveTexture>> turbulenceTexture1,
-                std::vector<std::shared_ptr<LveTexture>> displacementTexture2,
-                std::vector<std::shared_ptr<LveTexture>> derivateTexture2,
-                std::vector<std::shared_ptr<LveTexture>> turbulenceTexture2,
-                std::vector<std::shared_ptr<LveTexture>> displacementTexture3,
-                std::vector<std::shared_ptr<LveTexture>> derivateTexture3,
-                std::vector<std::shared_ptr<LveTexture>> turbulenceTexture3);
+                std::vector<std::shared_ptr<LveTexture>> displacementTextures,
+                std::vector<std::shared_ptr<LveTexture>> derivateTextures,
+                std::vector<std::shared_ptr<LveTexture>> turbulenceTextures, std::vector<float> lengthScales);
     ~WaterSystem();
 
     WaterSystem(const LveWindow &) = delete;
@@ -34,22 +33,20 @@ class WaterSystem {
    private:
     void createDescriptorSetLayout();
     void createDescriptorPool();
-    void ceateDescriptorSet(std::vector<std::shared_ptr<LveTexture>> displacementTexture1,
-                            std::vector<std::shared_ptr<LveTexture>> derivateTexture1,
-                            std::vector<std::shared_ptr<LveTexture>> turbulenceTexture1,
-                            std::vector<std::shared_ptr<LveTexture>> displacementTexture2,
-                            std::vector<std::shared_ptr<LveTexture>> derivateTexture2,
-                            std::vector<std::shared_ptr<LveTexture>> turbulenceTexture2,
-                            std::vector<std::shared_ptr<LveTexture>> displacementTexture3,
-                            std::vector<std::shared_ptr<LveTexture>> derivateTexture3,
-                            std::vector<std::shared_ptr<LveTexture>> turbulenceTexture3);
+    void createCascadeBuffer(const std::vector<float> &lengthScales);
+    void ceateDescriptorSet(std::vector<std::shared_ptr<LveTexture>> displacementTextures,
+                            std::vector<std::shared_ptr<LveTexture>> derivateTextures,
+                            std::vector<std::shared_ptr<LveTexture>> turbulenceTextures);
 
     std::shared_ptr<LveDescriptorSetLayout> waterTextureSetLayout;
+    // cascade count and length scales, read by the shaders to loop over the layers
+    std::unique_ptr<LveBuffer> cascadeBuffer;
     std::unique_ptr<LveDescriptorPool> TexturePool{};
     std::vector<VkDescriptorSet> descriptorSets;
 
     LveDevice &lveDevice;
-    std::unique_ptr<LveGPipeline> lveGPipeline;
+    // one per vertex format, like SimpleRenderSystem
+    std::array<std::unique_ptr<LveGPipeline>, VERTEX_FORMAT_COUNT> lveGPipelines;
     VkPipelineLayout pipelineLayout;
 };
 }  // namespace lve
\ No newline at end of file
@@ -7,6 +7,12 @@ class LveIPreProcessing {
    public:
     virtual void executePreCpS(FrameInfo frameInfo) = 0;
 
+    // Queue family ownership transfer of the resources read by the graphics queue when compute runs on its own
+    // queue : release is recorded at the end of the pre processing command buffer, acquire in the frame's
+    // graphics command buffer before the render pass, where graphics only work on the outputs (blits) also goes
+    virtual void releaseOutputs(FrameInfo frameInfo) {}
+    virtual void acquireOutputs(FrameInfo frameInfo) {}
+
    private:
 };
 }  // namespace lve
\ No newline at end of file
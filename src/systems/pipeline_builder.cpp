@@ -49,6 +49,8 @@ std::unique_ptr<LveGPipeline> PipelineBuilder::BuildGraphicsPipeline(PipelineCre
 
     PipelineConfigInfo pipelineConfig{};
     LveGPipeline::defaultPipeLineConfigInfo(pipelineConfig);
+    pipelineConfig.bindingDescriptions = getVertexBindingDescriptions(pipelineCreateInfo.vertexFormat);
+    pipelineConfig.attributeDescriptions = getVertexAttributeDescriptions(pipelineCreateInfo.vertexFormat);
     if (pipelineCreateInfo.functionnality & LvePipelIneFunctionnality::Transparancy) {
         LveGPipeline::enableAlphaBlending(pipelineConfig);
         pipelineConfig.attributeDescriptions.clear();
@@ -0,0 +1,171 @@
+// Offline mesh baker : imports OBJ models into the .lvemesh containers LveModel maps at startup.
+//
+// usage : LveMeshBaker [--format full|packed|packed-color] [--no-lods] [--exclude <file name>]... [--force]
+//                      [--benchmark] <input file or dir>
+//
+// Each model is written as <name>.<format>.lvemesh next to it, where the engine looks before its own cache, in the
+// vertex format the engine requests for it (LveVertexFormat, full by default) and with its LOD chain, or as
+// <name>.<format>.nolods.lvemesh without it when --no-lods is given. Up to date containers of the same kind are
+// skipped unless --force is given. --exclude leaves a model of the input directory out, for one baked with other
+// options. --benchmark writes nothing : it times the parallel
+// import against the serial one on every model and checks that both give the same mesh.
+#include "lve_mesh_builder.hpp"
+#include "lve_mesh_container.hpp"
+#include "lve_vertex_format.hpp"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool isModelFile(const fs::path &path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == ".obj";
+}
+
+bool isUpToDate(const fs::path &model, const fs::path &output, lve::LveVertexFormat format, bool withLods) {
+    try {
+        lve::LveMeshContainer container = lve::LveMeshContainer::map(output.string());
+        return container.vertexFormat == format && container.vertexStride == lve::vertexStride(format) &&
+               (withLods || container.lods.size() == 1) && container.matchesSource(model.string(), output.string());
+    } catch (const std::exception &) {
+        return false;
+    }
+}
+
+void bakeModel(const fs::path &model, const fs::path &output, lve::LveVertexFormat format, bool withLods) {
+    lve::LveMeshBuilder builder{};
+    builder.loadModel(model.string());
+    lve::LveMeshOptimizationReport report = builder.optimize();
+    if (withLods) builder.generateLods();
+    lve::LveMeshContainer container = builder.toContainer(model.string(), format);
+    container.save(output.string());
+
+    std::cout << model.filename().string() << " -> " << output.filename().string() << " (" << lve::toString(format)
+              << ") : " << container.vertexCount << " vertices, " << container.lods[0].indexCount / 3
+              << " triangles, " << (container.vertexDataSize() + container.indexDataSize()) / 1024 << " KiB (source "
+              << container.sourceSize / 1024 << " KiB)" << std::endl;
+    std::cout << "  vertex cache : ACMR " << report.before.acmr << " -> " << report.after.acmr << ", ATVR "
+              << report.before.atvr << " -> " << report.after.atvr << std::endl;
+    std::cout << "  LODs : triangles (error)";
+    for (const lve::LveMeshLod &lod : container.lods) {
+        std::cout << " " << lod.indexCount / 3 << " (" << lod.error << ")";
+    }
+    std::cout << std::endl;
+}
+
+// Best of a few runs, the first one also warms the file cache
+template <typename Import>
+double bestImportMilliseconds(Import import) {
+    constexpr int RUNS = 5;
+    double best = 0.0;
+    for (int i = 0; i < RUNS; i++) {
+        auto start = std::chrono::steady_clock::now();
+        import();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        double milliseconds = elapsed.count();
+        if (i == 0 || milliseconds < best) best = milliseconds;
+    }
+    return best;
+}
+
+// false when the two importers disagree
+bool benchmarkModel(const fs::path &model) {
+    lve::LveMeshBuilder serial{};
+    lve::LveMeshBuilder parallel{};
+    double serialMilliseconds = bestImportMilliseconds([&]() { serial.loadModelSerial(model.string()); });
+    double parallelMilliseconds = bestImportMilliseconds([&]() { parallel.loadModel(model.string()); });
+    bool identical = serial.vertices == parallel.vertices && serial.indices == parallel.indices;
+
+    std::cout << model.filename().string() << " : " << serial.indices.size() << " corners -> "
+              << serial.vertices.size() << " vertices, serial " << serialMilliseconds << " ms, parallel "
+              << parallelMilliseconds << " ms (x" << serialMilliseconds / parallelMilliseconds << ")"
+              << (identical ? "" : ", MESHES DIFFER") << std::endl;
+    return identical;
+}
+
+void printUsage() {
+    std::cerr << "usage: LveMeshBaker [--format full|packed|packed-color] [--no-lods] [--exclude <file name>]... "
+                 "[--force] [--benchmark] <input file or dir>"
+              << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    lve::LveVertexFormat format = lve::LveVertexFormat::Full;
+    bool withLods = true;
+    bool force = false;
+    bool benchmark = false;
+    std::vector<std::string> excluded;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            if (!lve::parseVertexFormat(argv[++i], format)) {
+                std::cerr << "unknown vertex format: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (std::strcmp(argv[i], "--exclude") == 0 && i + 1 < argc) {
+            excluded.push_back(argv[++i]);
+        } else if (std::strcmp(argv[i], "--no-lods") == 0) {
+            withLods = false;
+        } else if (std::strcmp(argv[i], "--force") == 0) {
+            force = true;
+        } else if (std::strcmp(argv[i], "--benchmark") == 0) {
+            benchmark = true;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.size() != 1) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    fs::path input = paths[0];
+    try {
+        std::vector<fs::path> models;
+        if (fs::is_directory(input)) {
+            for (const fs::directory_entry &entry : fs::directory_iterator(input)) {
+                std::string fileName = entry.path().filename().string();
+                bool isExcluded = std::find(excluded.begin(), excluded.end(), fileName) != excluded.end();
+                if (entry.is_regular_file() && isModelFile(entry.path()) && !isExcluded) {
+                    models.push_back(entry.path());
+                }
+            }
+            std::sort(models.begin(), models.end());
+        } else {
+            models.push_back(input);
+        }
+
+        if (benchmark) {
+            bool identical = true;
+            for (const fs::path &model : models) identical = benchmarkModel(model) && identical;
+            return identical ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        for (const fs::path &model : models) {
+            fs::path output = lve::LveMeshContainer::containerPath(model.string(), format, withLods);
+            if (!force && isUpToDate(model, output, format, withLods)) {
+                std::cout << model.filename().string() << " : up to date" << std::endl;
+                continue;
+            }
+            bakeModel(model, output, format, withLods);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
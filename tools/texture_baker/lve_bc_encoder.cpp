@@ -0,0 +1,291 @@
+#include "lve_bc_encoder.hpp"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace lve {
+namespace bc {
+
+namespace {
+
+// Endpoints of the segment through the block colors along their principal axis, for the first N channels
+template <int N>
+void principalAxisEndpoints(const uint8_t *rgba, float lo[N], float hi[N]) {
+    float mean[N] = {};
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < N; c++) mean[c] += rgba[i * 4 + c];
+    }
+    for (int c = 0; c < N; c++) mean[c] /= 16.f;
+
+    float covariance[N][N] = {};
+    for (int i = 0; i < 16; i++) {
+        for (int a = 0; a < N; a++) {
+            for (int b = 0; b < N; b++) {
+                covariance[a][b] += (rgba[i * 4 + a] - mean[a]) * (rgba[i * 4 + b] - mean[b]);
+            }
+        }
+    }
+
+    // power iteration, a handful of steps is plenty for 16 points
+    float axis[N];
+    for (int c = 0; c < N; c++) axis[c] = 1.f;
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[N] = {};
+        float lengthSquared = 0.f;
+        for (int a = 0; a < N; a++) {
+            for (int b = 0; b < N; b++) next[a] += covariance[a][b] * axis[b];
+            lengthSquared += next[a] * next[a];
+        }
+        // flat block : every pixel projects on the mean whatever the axis
+        if (lengthSquared < 1e-8f) break;
+        float invLength = 1.f / std::sqrt(lengthSquared);
+        for (int c = 0; c < N; c++) axis[c] = next[c] * invLength;
+    }
+
+    float minProjection = 0.f;
+    float maxProjection = 0.f;
+    for (int i = 0; i < 16; i++) {
+        float projection = 0.f;
+        for (int c = 0; c < N; c++) projection += (rgba[i * 4 + c] - mean[c]) * axis[c];
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+    for (int c = 0; c < N; c++) {
+        lo[c] = std::clamp(mean[c] + axis[c] * minProjection, 0.f, 255.f);
+        hi[c] = std::clamp(mean[c] + axis[c] * maxProjection, 0.f, 255.f);
+    }
+}
+
+template <int N>
+int squaredError(const uint8_t *pixel, const int *color) {
+    int error = 0;
+    for (int c = 0; c < N; c++) {
+        int delta = pixel[c] - color[c];
+        error += delta * delta;
+    }
+    return error;
+}
+
+template <int N, int COUNT>
+uint32_t closestIndex(const uint8_t *pixel, const int (&palette)[COUNT][4]) {
+    uint32_t best = 0;
+    int bestError = squaredError<N>(pixel, palette[0]);
+    for (uint32_t i = 1; i < COUNT; i++) {
+        int error = squaredError<N>(pixel, palette[i]);
+        if (error < bestError) {
+            bestError = error;
+            best = i;
+        }
+    }
+    return best;
+}
+
+uint16_t toRgb565(const float color[3]) {
+    uint16_t r = static_cast<uint16_t>(std::lround(color[0] * 31.f / 255.f));
+    uint16_t g = static_cast<uint16_t>(std::lround(color[1] * 63.f / 255.f));
+    uint16_t b = static_cast<uint16_t>(std::lround(color[2] * 31.f / 255.f));
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void fromRgb565(uint16_t value, int color[4]) {
+    int r = (value >> 11) & 31;
+    int g = (value >> 5) & 63;
+    int b = value & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+    color[3] = 255;
+}
+
+void writeLittleEndian(uint8_t *out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+// BC7 blocks are one 128 bits little endian stream, fields are written from the least significant bit
+class BitWriter {
+   public:
+    explicit BitWriter(uint8_t *out) : out{out} { memset(out, 0, 16); }
+
+    void write(uint32_t value, int bitCount) {
+        for (int i = 0; i < bitCount; i++, position++) {
+            if ((value >> i) & 1u) out[position / 8] |= static_cast<uint8_t>(1u << (position % 8));
+        }
+    }
+
+   private:
+    uint8_t *out;
+    int position = 0;
+};
+
+// 7 bit endpoint and the p-bit shared by its channels, chosen for the smallest quantization error
+void quantizeBC7Endpoint(const float endpoint[4], int quantized[4], int &pBit) {
+    int bestError = -1;
+    for (int p = 0; p < 2; p++) {
+        int candidate[4];
+        int error = 0;
+        for (int c = 0; c < 4; c++) {
+            candidate[c] = std::clamp(static_cast<int>(std::lround((endpoint[c] - p) / 2.f)), 0, 127);
+            float delta = static_cast<float>((candidate[c] << 1) | p) - endpoint[c];
+            error += static_cast<int>(delta * delta);
+        }
+        if (bestError < 0 || error < bestError) {
+            bestError = error;
+            pBit = p;
+            std::copy(candidate, candidate + 4, quantized);
+        }
+    }
+}
+
+constexpr int BC7_WEIGHTS_4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+}  // namespace
+
+void encodeBC1Block(const uint8_t *rgba, uint8_t *out) {
+    float lo[3], hi[3];
+    principalAxisEndpoints<3>(rgba, lo, hi);
+
+    // color0 > color1 selects the 4 colors mode, equal endpoints decode index 0 as color0 in both modes
+    uint16_t color0 = toRgb565(hi);
+    uint16_t color1 = toRgb565(lo);
+    if (color0 < color1) std::swap(color0, color1);
+
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        int palette[4][4];
+        fromRgb565(color0, palette[0]);
+        fromRgb565(color1, palette[1]);
+        for (int c = 0; c < 4; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int i = 0; i < 16; i++) indices |= closestIndex<3>(&rgba[i * 4], palette) << (2 * i);
+    }
+
+    writeLittleEndian(out, color0, 2);
+    writeLittleEndian(out + 2, color1, 2);
+    writeLittleEndian(out + 4, indices, 4);
+}
+
+void encodeBC4Block(const uint8_t *rgba, int channel, uint8_t *out) {
+    int maxValue = 0;
+    int minValue = 255;
+    for (int i = 0; i < 16; i++) {
+        maxValue = std::max<int>(maxValue, rgba[i * 4 + channel]);
+        minValue = std::min<int>(minValue, rgba[i * 4 + channel]);
+    }
+    out[0] = static_cast<uint8_t>(maxValue);
+    out[1] = static_cast<uint8_t>(minValue);
+
+    uint64_t indices = 0;
+    if (maxValue != minValue) {
+        // endpoint0 > endpoint1 : 8 values interpolated between the two
+        int palette[8][4] = {};
+        palette[0][0] = maxValue;
+        palette[1][0] = minValue;
+        for (int k = 2; k < 8; k++) palette[k][0] = ((8 - k) * maxValue + (k - 1) * minValue + 3) / 7;
+        for (int i = 0; i < 16; i++) {
+            uint64_t index = closestIndex<1>(&rgba[i * 4 + channel], palette);
+            indices |= index << (3 * i);
+        }
+    }
+    writeLittleEndian(out + 2, indices, 6);
+}
+
+void encodeBC3Block(const uint8_t *rgba, uint8_t *out) {
+    encodeBC4Block(rgba, 3, out);
+    encodeBC1Block(rgba, out + 8);
+}
+
+void encodeBC5Block(const uint8_t *rgba, uint8_t *out) {
+    encodeBC4Block(rgba, 0, out);
+    encodeBC4Block(rgba, 1, out + 8);
+}
+
+void encodeBC7Block(const uint8_t *rgba, uint8_t *out) {
+    float endpoints[2][4];
+    principalAxisEndpoints<4>(rgba, endpoints[0], endpoints[1]);
+
+    int quantized[2][4];
+    int pBits[2];
+    int values[2][4];
+    for (int e = 0; e < 2; e++) {
+        quantizeBC7Endpoint(endpoints[e], quantized[e], pBits[e]);
+        for (int c = 0; c < 4; c++) values[e][c] = (quantized[e][c] << 1) | pBits[e];
+    }
+
+    int palette[16][4];
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) {
+            palette[i][c] = ((64 - BC7_WEIGHTS_4[i]) * values[0][c] + BC7_WEIGHTS_4[i] * values[1][c] + 32) >> 6;
+        }
+    }
+    uint32_t indices[16];
+    for (int i = 0; i < 16; i++) indices[i] = closestIndex<4>(&rgba[i * 4], palette);
+
+    // the anchor index is stored without its high bit : swapping the endpoints flips every index
+    if (indices[0] & 8u) {
+        std::swap(quantized[0], quantized[1]);
+        std::swap(pBits[0], pBits[1]);
+        for (uint32_t &index : indices) index = 15 - index;
+    }
+
+    BitWriter writer{out};
+    writer.write(1u << 6, 7);  // mode 6
+    for (int c = 0; c < 4; c++) {
+        writer.write(quantized[0][c], 7);
+        writer.write(quantized[1][c], 7);
+    }
+    writer.write(pBits[0], 1);
+    writer.write(pBits[1], 1);
+    writer.write(indices[0], 3);
+    for (int i = 1; i < 16; i++) writer.write(indices[i], 4);
+}
+
+std::vector<uint8_t> compressImage(const uint8_t *rgba, uint32_t width, uint32_t height, LveTexFormat format) {
+    std::vector<uint8_t> result(LveTexContainer::mipSize(format, width, height));
+    if (format == LveTexFormat::RGBA8) {
+        memcpy(result.data(), rgba, result.size());
+        return result;
+    }
+
+    uint32_t blockSize = LveTexContainer::blockSize(format);
+    uint32_t blocksX = (width + 3) / 4;
+    uint32_t blocksY = (height + 3) / 4;
+    uint8_t block[16 * 4];
+    for (uint32_t by = 0; by < blocksY; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            for (uint32_t y = 0; y < 4; y++) {
+                for (uint32_t x = 0; x < 4; x++) {
+                    uint32_t sourceX = std::min(bx * 4 + x, width - 1);
+                    uint32_t sourceY = std::min(by * 4 + y, height - 1);
+                    memcpy(&block[(y * 4 + x) * 4], &rgba[(sourceY * width + sourceX) * 4], 4);
+                }
+            }
+
+            uint8_t *out = &result[(static_cast<size_t>(by) * blocksX + bx) * blockSize];
+            switch (format) {
+                case LveTexFormat::BC1:
+                    encodeBC1Block(block, out);
+                    break;
+                case LveTexFormat::BC3:
+                    encodeBC3Block(block, out);
+                    break;
+                case LveTexFormat::BC5:
+                    encodeBC5Block(block, out);
+                    break;
+                case LveTexFormat::BC7:
+                    encodeBC7Block(block, out);
+                    break;
+                default:
+                    throw std::runtime_error("unsupported block compression format!");
+            }
+        }
+    }
+    return result;
+}
+
+}  // namespace bc
+}  // namespace lve
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "lve_texture_container.hpp"
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+/*
+ * CPU block compression used by the texture baker. Every encoder takes the 4x4 block as 16 RGBA8 pixels in row
+ * order and writes one block in the layout the GPU expects :
+ * - BC1 : principal axis endpoints in RGB565, always in the 4 colors mode (no punch through alpha)
+ * - BC3 : BC4 alpha block followed by a BC1 color block
+ * - BC5 : BC4 blocks of the red and green channels
+ * - BC7 : mode 6 only (one subset, RGBA 7.7.7.7 endpoints with p-bits, 4 bit indices)
+ */
+namespace bc {
+
+void encodeBC1Block(const uint8_t *rgba, uint8_t *out);
+void encodeBC4Block(const uint8_t *rgba, int channel, uint8_t *out);
+void encodeBC3Block(const uint8_t *rgba, uint8_t *out);
+void encodeBC5Block(const uint8_t *rgba, uint8_t *out);
+void encodeBC7Block(const uint8_t *rgba, uint8_t *out);
+
+// Compresses a whole level, edge blocks repeat the last row / column
+std::vector<uint8_t> compressImage(const uint8_t *rgba, uint32_t width, uint32_t height, LveTexFormat format);
+
+}  // namespace bc
+}  // namespace lve
@@ -0,0 +1,182 @@
+// Offline texture baker : converts images into .lvetex containers holding every mip level already block compressed.
+//
+// usage : LveTextureBaker [--format bc1|bc3|bc5|bc7|rgba8] [--linear] [--no-mips] <input file or dir> [output dir]
+//
+// Each image is written as <name>.lvetex in the output directory (the input directory by default), LveTexture picks
+// it up in place of the image next to it.
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "lve_bc_encoder.hpp"
+#include "lve_texture_container.hpp"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct BakeOptions {
+    lve::LveTexFormat format = lve::LveTexFormat::BC7;
+    bool srgb = true;
+    bool mips = true;
+};
+
+float srgbToLinear(uint8_t value) {
+    float c = value / 255.f;
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+uint8_t linearToSrgb(float value) {
+    float c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.f / 2.4f) - 0.055f;
+    return static_cast<uint8_t>(std::lround(std::clamp(c, 0.f, 1.f) * 255.f));
+}
+
+// 2x2 box filter, color channels are averaged in linear space for sRGB textures, alpha never is
+std::vector<uint8_t> downsample(const std::vector<uint8_t> &source, uint32_t width, uint32_t height, bool srgb,
+                                uint32_t &outWidth, uint32_t &outHeight) {
+    outWidth = std::max(width / 2, 1u);
+    outHeight = std::max(height / 2, 1u);
+    std::vector<uint8_t> result(static_cast<size_t>(outWidth) * outHeight * 4);
+
+    for (uint32_t y = 0; y < outHeight; y++) {
+        for (uint32_t x = 0; x < outWidth; x++) {
+            float sum[4] = {};
+            for (uint32_t dy = 0; dy < 2; dy++) {
+                for (uint32_t dx = 0; dx < 2; dx++) {
+                    uint32_t sourceX = std::min(x * 2 + dx, width - 1);
+                    uint32_t sourceY = std::min(y * 2 + dy, height - 1);
+                    const uint8_t *pixel = &source[(static_cast<size_t>(sourceY) * width + sourceX) * 4];
+                    for (int c = 0; c < 4; c++) sum[c] += srgb && c < 3 ? srgbToLinear(pixel[c]) : pixel[c];
+                }
+            }
+            uint8_t *out = &result[(static_cast<size_t>(y) * outWidth + x) * 4];
+            for (int c = 0; c < 4; c++) {
+                out[c] = srgb && c < 3 ? linearToSrgb(sum[c] / 4.f)
+                                       : static_cast<uint8_t>(std::lround(std::clamp(sum[c] / 4.f, 0.f, 255.f)));
+            }
+        }
+    }
+    return result;
+}
+
+bool isImageFile(const fs::path &path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" ||
+           extension == ".bmp";
+}
+
+void bakeTexture(const fs::path &input, const fs::path &output, const BakeOptions &options) {
+    int width, height, channels;
+    // same orientation as LveTexture::objectTextureConstructor
+    stbi_set_flip_vertically_on_load(true);
+    stbi_uc *pixels = stbi_load(input.string().c_str(), &width, &height, &channels, 4);
+    if (pixels == nullptr) {
+        throw std::runtime_error("failed to load image: " + input.string());
+    }
+    std::vector<uint8_t> level(pixels, pixels + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(pixels);
+
+    lve::LveTexContainer container{};
+    container.format = options.format;
+    container.flags = options.srgb ? lve::LveTexContainer::FLAG_SRGB : 0;
+    container.width = static_cast<uint32_t>(width);
+    container.height = static_cast<uint32_t>(height);
+
+    uint32_t levelWidth = container.width;
+    uint32_t levelHeight = container.height;
+    while (true) {
+        std::vector<uint8_t> encoded = lve::bc::compressImage(level.data(), levelWidth, levelHeight, options.format);
+        container.addMip(levelWidth, levelHeight, encoded.data());
+        if (!options.mips || (levelWidth == 1 && levelHeight == 1)) break;
+
+        uint32_t nextWidth, nextHeight;
+        level = downsample(level, levelWidth, levelHeight, options.srgb, nextWidth, nextHeight);
+        levelWidth = nextWidth;
+        levelHeight = nextHeight;
+    }
+
+    container.save(output.string());
+    uint64_t sourceBytes = static_cast<uint64_t>(width) * height * 4;
+    std::cout << input.filename().string() << " -> " << output.filename().string() << " : " << width << "x" << height
+              << ", " << container.mips.size() << " mips, " << container.data.size() / 1024 << " KiB (level 0 was "
+              << sourceBytes / 1024 << " KiB uncompressed)" << std::endl;
+}
+
+bool parseFormat(const std::string &name, lve::LveTexFormat &format) {
+    if (name == "bc1") format = lve::LveTexFormat::BC1;
+    else if (name == "bc3") format = lve::LveTexFormat::BC3;
+    else if (name == "bc5") format = lve::LveTexFormat::BC5;
+    else if (name == "bc7") format = lve::LveTexFormat::BC7;
+    else if (name == "rgba8") format = lve::LveTexFormat::RGBA8;
+    else return false;
+    return true;
+}
+
+void printUsage() {
+    std::cerr << "usage: LveTextureBaker [--format bc1|bc3|bc5|bc7|rgba8] [--linear] [--no-mips] "
+                 "<input file or dir> [output dir]"
+              << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    BakeOptions options{};
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            if (!parseFormat(argv[++i], options.format)) {
+                printUsage();
+                return EXIT_FAILURE;
+            }
+        } else if (std::strcmp(argv[i], "--linear") == 0) {
+            options.srgb = false;
+        } else if (std::strcmp(argv[i], "--no-mips") == 0) {
+            options.mips = false;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.empty() || paths.size() > 2) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+    // BC5 only stores two channels, it has no sRGB variant
+    if (options.format == lve::LveTexFormat::BC5) options.srgb = false;
+
+    fs::path input = paths[0];
+    fs::path outputDir = paths.size() > 1 ? fs::path(paths[1]) : fs::is_directory(input) ? input : input.parent_path();
+    if (outputDir.empty()) outputDir = ".";
+
+    try {
+        fs::create_directories(outputDir);
+        std::vector<fs::path> images;
+        if (fs::is_directory(input)) {
+            for (const fs::directory_entry &entry : fs::directory_iterator(input)) {
+                if (entry.is_regular_file() && isImageFile(entry.path())) images.push_back(entry.path());
+            }
+            std::sort(images.begin(), images.end());
+        } else {
+            images.push_back(input);
+        }
+
+        for (const fs::path &image : images) {
+            bakeTexture(image, outputDir / image.filename().replace_extension(".lvetex"), options);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}